@@ -34,17 +34,36 @@ typedef enum {
 
 /* Attribute Type */
 
+// NOTE: The compact types (from 'PF_ATTRIB_HALF') are decoded to 'PF_ATTRIB_FLOAT'
+//       elements when fetched, except in the 'PF_ATTRIB_COLOR' slot where they are
+//       decoded as normalized values to 'PF_ATTRIB_UBYTE' ones. The packed types store all the components of an
+//       element in a single 'uint32_t', 'x' in the low bits, and 'comp' then gives
+//       how many of the four components are used.
 typedef enum {
     PF_ATTRIB_FLOAT,
     PF_ATTRIB_UBYTE,
+    PF_ATTRIB_HALF,
+    PF_ATTRIB_SNORM8,
+    PF_ATTRIB_UNORM8,
+    PF_ATTRIB_SNORM16,
+    PF_ATTRIB_UNORM16,
+    PF_ATTRIB_SNORM_10_10_10_2,
+    PF_ATTRIB_UNORM_10_10_10_2,
 } pf_attrib_type_e;
 
+// NOTE: 'stride' is the distance in bytes between two elements, zero meaning that they are
+//       tightly packed, and 'offset' is the byte offset of the first element in 'buffer'.
+//       Several attributes can thus share the same interleaved buffer, which is then
+//       only released once by 'pf_vertexbuffer_delete'. The stride of a 'PF_ATTRIB_FLOAT'
+//       attribute must be a multiple of 'sizeof(float)'.
 typedef struct {
     void*               buffer;
     size_t              size;
     pf_attrib_type_e    type;
     uint8_t             comp;
     bool                used;
+    size_t              stride;
+    size_t              offset;
 } pf_attribute_t;
 
 /* Attribute Element Type */
@@ -63,12 +82,28 @@ typedef struct {
 
 /* Attribute Functions */
 
+PFAPI size_t
+pf_attribute_get_elem_size(const pf_attribute_t* attr);
+
+PFAPI size_t
+pf_attribute_get_stride(const pf_attribute_t* attr);
+
 PFAPI void*
 pf_attribute_get_elem_ptr(const pf_attribute_t* attr, size_t index);
 
 PFAPI pf_attrib_elem_t
 pf_attribute_get_elem(const pf_attribute_t* attr, size_t index);
 
+// NOTE: Fetches an element of the 'PF_ATTRIB_COLOR' slot, the compact types
+//       are decoded as normalized values to 'PF_ATTRIB_UBYTE' components.
+PFAPI pf_attrib_elem_t
+pf_attribute_get_color_elem(const pf_attribute_t* attr, size_t index);
+
+// NOTE: Returns a copy of a 'PF_ATTRIB_FLOAT' attribute stored with the given type,
+//       the values being clamped to the range of the normalized types.
+PFAPI pf_attribute_t
+pf_attribute_convert(const pf_attribute_t* attr, pf_attrib_type_e type);
+
 /* Attribute Element Functions */
 
 PFAPI float
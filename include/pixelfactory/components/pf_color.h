@@ -75,6 +75,11 @@ typedef pf_simd_i_t
 typedef pf_color_t(*pf_color_blend_fn)(
     pf_color_t, pf_color_t);
 
+typedef void(*pf_color_blend_span_fn)(
+    pf_color_t* restrict,
+    const pf_color_t* restrict,
+    size_t);
+
 /* General Functions */
 
 PFAPI pf_color_t
@@ -138,6 +143,19 @@ pf_color_scale_u8(
     pf_color_t col,
     uint8_t scale);
 
+// NOTE: Multiplies the color channels by alpha, rounded to the nearest
+PFAPI pf_color_t
+pf_color_premultiply(
+    pf_color_t col);
+
+// NOTE: Blends 'count' premultiplied colors over 'dst' with 'pf_color_blend_premul',
+//       several at a time with SIMD.
+PFAPI void
+pf_color_blend_premul_span(
+    pf_color_t* restrict dst,
+    const pf_color_t* restrict src,
+    size_t count);
+
 PFAPI void
 pf_color_from_hsv(
     pf_color_t* color,
@@ -219,6 +237,43 @@ pf_color_blend_alpha(
     return result;
 }
 
+// NOTE: 'over' operator for premultiplied colors, src + dst * (1 - src.a), the red-blue
+//       and green-alpha pairs being scaled with one multiply each. Unlike the straight alpha
+//       blend it is associative, and a filtered premultiplied texel blends without fringes.
+static inline pf_color_t
+pf_color_blend_premul(
+    pf_color_t dst,
+    pf_color_t src)
+{
+    uint32_t inv_alpha = 256 - src.c.a;
+    uint32_t rb = (((dst.v & 0x00FF00FF) * inv_alpha) >> 8) & 0x00FF00FF;
+    uint32_t ag = (((dst.v >> 8) & 0x00FF00FF) * inv_alpha) & 0xFF00FF00;
+
+    pf_color_t result;
+    result.v = src.v + (rb | ag);
+    return result;
+}
+
+// NOTE: Same as 'pf_color_blend_premul' on each packed color
+static inline pf_simd_i_t
+pf_color_blend_premul_simd(
+    pf_simd_i_t dst,
+    pf_simd_i_t src)
+{
+    const pf_simd_i_t mask = pf_simd_set1_i32(0x00FF00FF);
+
+    pf_simd_i_t inv_alpha = pf_simd_sub_i32(pf_simd_set1_i32(256), pf_simd_srli_i32(src, 24));
+    inv_alpha = pf_simd_or_i32(inv_alpha, pf_simd_slli_i32(inv_alpha, 16));
+
+    pf_simd_i_t rb = pf_simd_mullo_i16(pf_simd_and_i32(dst, mask), inv_alpha);
+    pf_simd_i_t ag = pf_simd_mullo_i16(pf_simd_and_i32(pf_simd_srli_i32(dst, 8), mask), inv_alpha);
+
+    rb = pf_simd_srli_i16(rb, 8);
+    ag = pf_simd_and_i32(ag, pf_simd_set1_i32(0xFF00FF00));
+
+    return pf_simd_add_i32(src, pf_simd_or_i32(rb, ag));
+}
+
 static inline pf_color_t
 pf_color_blend_screen(
     pf_color_t dst,
@@ -25,6 +25,13 @@
 typedef pf_color_t (*pf_pixel_getter_fn)(const void*, size_t);
 typedef void (*pf_pixel_setter_fn)(void*, size_t, pf_color_t);
 
+// NOTE: Decodes one 4x4 block of a compressed format into 16 colors stored row by row.
+typedef void (*pf_pixel_block_decoder_fn)(const void*, pf_color_t*);
+
+// NOTE: The formats from 'PF_PIXELFORMAT_BC1' are block-compressed, made of 4x4 texel
+//       blocks stored row by row, of 8 bytes (BC1, BC4, ETC2_RGB8) or 16 bytes. They
+//       have no getter or setter, the blocks are decoded whole. BC4 and BC5 decode to
+//       the red and red-green channels, as 'PF_PIXELFORMAT_R32' does.
 typedef enum {
     PF_PIXELFORMAT_UNKNOWN = 0,
     PF_PIXELFORMAT_GRAY,
@@ -40,6 +47,14 @@ typedef enum {
     PF_PIXELFORMAT_R16,
     PF_PIXELFORMAT_RGB161616,
     PF_PIXELFORMAT_RGBA16161616,
+    PF_PIXELFORMAT_BGRA8888,
+
+    PF_PIXELFORMAT_BC1,
+    PF_PIXELFORMAT_BC3,
+    PF_PIXELFORMAT_BC4,
+    PF_PIXELFORMAT_BC5,
+    PF_PIXELFORMAT_ETC2_RGB8,
+    PF_PIXELFORMAT_ETC2_RGBA8,
 } pf_pixelformat_e;
 
 
@@ -110,6 +125,11 @@ pf_pixel_get_rgba16161616(
     const void* pixels,
     size_t offset);
 
+PFAPI pf_color_t
+pf_pixel_get_bgra8888(
+    const void* pixels,
+    size_t offset);
+
 
 /* Pixel Setters */
 
@@ -191,6 +211,45 @@ pf_pixel_set_rgba16161616(
     size_t offset,
     pf_color_t color);
 
+void
+pf_pixel_set_bgra8888(
+    void* pixels,
+    size_t offset,
+    pf_color_t color);
+
+
+/* Block Decoders */
+
+PFAPI void
+pf_pixel_decode_bc1(
+    const void* block,
+    pf_color_t* texels);
+
+PFAPI void
+pf_pixel_decode_bc3(
+    const void* block,
+    pf_color_t* texels);
+
+PFAPI void
+pf_pixel_decode_bc4(
+    const void* block,
+    pf_color_t* texels);
+
+PFAPI void
+pf_pixel_decode_bc5(
+    const void* block,
+    pf_color_t* texels);
+
+PFAPI void
+pf_pixel_decode_etc2_rgb8(
+    const void* block,
+    pf_color_t* texels);
+
+PFAPI void
+pf_pixel_decode_etc2_rgba8(
+    const void* block,
+    pf_color_t* texels);
+
 
 /* Helper Functions */
 
@@ -204,5 +263,25 @@ size_t
 pf_pixel_get_bytes(
     pf_pixelformat_e format);
 
+PFAPI pf_pixel_block_decoder_fn
+pf_pixel_default_block_decoder(
+    pf_pixelformat_e format);
+
+PFAPI bool
+pf_pixel_is_compressed(
+    pf_pixelformat_e format);
+
+// NOTE: Returns the size in bytes of a 4x4 block, or zero for uncompressed formats.
+PFAPI size_t
+pf_pixel_get_block_bytes(
+    pf_pixelformat_e format);
+
+// NOTE: Returns the size in bytes of a w*h image, compressed formats being
+//       rounded up to whole blocks.
+PFAPI size_t
+pf_pixel_get_image_bytes(
+    pf_pixelformat_e format,
+    uint32_t w, uint32_t h);
+
 
 #endif //PF_PIXEL_H
\ No newline at end of file
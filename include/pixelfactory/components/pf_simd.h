@@ -154,6 +154,46 @@ pf_simd_add_i32(pf_simd_i_t x, pf_simd_i_t y)
 #endif
 }
 
+static inline pf_simd_i_t
+pf_simd_sub_i32(pf_simd_i_t x, pf_simd_i_t y)
+{
+#if defined(__AVX2__)
+    return _mm256_sub_epi32(x, y);
+#elif defined(__SSE2__)
+    return _mm_sub_epi32(x, y);
+#else
+    return x - y;
+#endif
+}
+
+static inline pf_simd_i_t
+pf_simd_min_i32(pf_simd_i_t x, pf_simd_i_t y)
+{
+#if defined(__AVX2__)
+    return _mm256_min_epi32(x, y);
+#elif defined(__SSE4_1__)
+    return _mm_min_epi32(x, y);
+#elif defined(__SSE2__)
+    return _mm_blendv_epi8_sse2(x, y, _mm_cmpgt_epi32(x, y));
+#else
+    return (x < y) ? x : y;
+#endif
+}
+
+static inline pf_simd_i_t
+pf_simd_max_i32(pf_simd_i_t x, pf_simd_i_t y)
+{
+#if defined(__AVX2__)
+    return _mm256_max_epi32(x, y);
+#elif defined(__SSE4_1__)
+    return _mm_max_epi32(x, y);
+#elif defined(__SSE2__)
+    return _mm_blendv_epi8_sse2(x, y, _mm_cmplt_epi32(x, y));
+#else
+    return (x > y) ? x : y;
+#endif
+}
+
 static inline pf_simd_i_t
 pf_simd_mullo_i32(pf_simd_i_t x, pf_simd_i_t y)
 {
@@ -180,6 +220,30 @@ pf_simd_cvti32_ps(pf_simd_i_t x)
 #endif
 }
 
+static inline pf_simd_t
+pf_simd_add_ps(pf_simd_t x, pf_simd_t y)
+{
+#if defined(__AVX2__)
+    return _mm256_add_ps(x, y);
+#elif defined(__SSE2__)
+    return _mm_add_ps(x, y);
+#else
+    return x + y;
+#endif
+}
+
+static inline pf_simd_t
+pf_simd_sub_ps(pf_simd_t x, pf_simd_t y)
+{
+#if defined(__AVX2__)
+    return _mm256_sub_ps(x, y);
+#elif defined(__SSE2__)
+    return _mm_sub_ps(x, y);
+#else
+    return x - y;
+#endif
+}
+
 static inline pf_simd_t
 pf_simd_mul_ps(pf_simd_t x, pf_simd_t y)
 {
@@ -192,6 +256,30 @@ pf_simd_mul_ps(pf_simd_t x, pf_simd_t y)
 #endif
 }
 
+static inline pf_simd_t
+pf_simd_min_ps(pf_simd_t x, pf_simd_t y)
+{
+#if defined(__AVX2__)
+    return _mm256_min_ps(x, y);
+#elif defined(__SSE2__)
+    return _mm_min_ps(x, y);
+#else
+    return (x < y) ? x : y;
+#endif
+}
+
+static inline pf_simd_t
+pf_simd_max_ps(pf_simd_t x, pf_simd_t y)
+{
+#if defined(__AVX2__)
+    return _mm256_max_ps(x, y);
+#elif defined(__SSE2__)
+    return _mm_max_ps(x, y);
+#else
+    return (x > y) ? x : y;
+#endif
+}
+
 static inline pf_simd_i_t
 pf_simd_cvtf32_i32(pf_simd_t x)
 {
@@ -204,6 +292,36 @@ pf_simd_cvtf32_i32(pf_simd_t x)
 #endif
 }
 
+// NOTE: Truncates toward zero, as a C cast does
+static inline pf_simd_i_t
+pf_simd_cvttf32_i32(pf_simd_t x)
+{
+#if defined(__AVX2__)
+    return _mm256_cvttps_epi32(x);
+#elif defined(__SSE2__)
+    return _mm_cvttps_epi32(x);
+#else
+    return (pf_simd_i_t)x;
+#endif
+}
+
+// NOTE: The SSE2 and scalar versions are only valid in the range of 'int32_t'
+static inline pf_simd_t
+pf_simd_floor_ps(pf_simd_t x)
+{
+#if defined(__AVX2__)
+    return _mm256_floor_ps(x);
+#elif defined(__SSE4_1__)
+    return _mm_floor_ps(x);
+#elif defined(__SSE2__)
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+#else
+    float t = (float)(int32_t)x;
+    return (t > x) ? t - 1.0f : t;
+#endif
+}
+
 static inline pf_simd_t
 pf_simd_rcp_ps(pf_simd_t x)
 {
@@ -252,6 +370,18 @@ pf_simd_store_si32(void* p, pf_simd_i_t x)
 #endif
 }
 
+static inline pf_simd_t
+pf_simd_load_ps(const void* p)
+{
+#if defined(__AVX2__)
+    return _mm256_loadu_ps((const float*)p);
+#elif defined(__SSE2__)
+    return _mm_loadu_ps((const float*)p);
+#else
+    return *(const float*)p;
+#endif
+}
+
 static inline pf_simd_i_t
 pf_simd_load_i32(const void* p)
 {
@@ -264,6 +394,21 @@ pf_simd_load_i32(const void* p)
 #endif
 }
 
+// NOTE: Loads 'base[index]' for each lane
+static inline pf_simd_i_t
+pf_simd_gather_i32(const int32_t* base, pf_simd_i_t index)
+{
+#if defined(__AVX2__)
+    return _mm256_i32gather_epi32((const int*)base, index, 4);
+#elif defined(__SSE2__)
+    int32_t i[4];
+    _mm_storeu_si128((__m128i*)i, index);
+    return _mm_setr_epi32(base[i[0]], base[i[1]], base[i[2]], base[i[3]]);
+#else
+    return base[index];
+#endif
+}
+
 #if defined(__AVX2__)
 #   define pf_simd_extract_i32(v, index)   \
         _mm256_extract_epi32(x, index)
@@ -321,7 +466,7 @@ pf_simd_srli_i32(pf_simd_i_t x, int32_t imm8)
 #elif defined(__SSE2__)
     return _mm_srli_epi32(x, imm8);
 #else
-    return x >> imm8;
+    return (int32_t)((uint32_t)x >> imm8);
 #endif
 }
 
@@ -349,6 +494,62 @@ pf_simd_or_i32(pf_simd_i_t x, pf_simd_i_t y)
 #endif
 }
 
+// NOTE: The 16-bit operations work on the two halves of each 32-bit lane,
+//       the scalar versions do it within a single 32-bit integer
+
+static inline pf_simd_i_t
+pf_simd_add_i16(pf_simd_i_t x, pf_simd_i_t y)
+{
+#if defined(__AVX2__)
+    return _mm256_add_epi16(x, y);
+#elif defined(__SSE2__)
+    return _mm_add_epi16(x, y);
+#else
+    uint32_t lo = ((uint32_t)x + (uint32_t)y) & 0x0000FFFF;
+    uint32_t hi = (((uint32_t)x & 0xFFFF0000) + ((uint32_t)y & 0xFFFF0000));
+    return (int32_t)(lo | hi);
+#endif
+}
+
+static inline pf_simd_i_t
+pf_simd_mullo_i16(pf_simd_i_t x, pf_simd_i_t y)
+{
+#if defined(__AVX2__)
+    return _mm256_mullo_epi16(x, y);
+#elif defined(__SSE2__)
+    return _mm_mullo_epi16(x, y);
+#else
+    uint32_t lo = ((uint32_t)x * (uint32_t)y) & 0x0000FFFF;
+    uint32_t hi = (((uint32_t)x >> 16) * ((uint32_t)y >> 16)) << 16;
+    return (int32_t)(lo | hi);
+#endif
+}
+
+static inline pf_simd_i_t
+pf_simd_srli_i16(pf_simd_i_t x, int32_t imm8)
+{
+#if defined(__AVX2__)
+    return _mm256_srli_epi16(x, imm8);
+#elif defined(__SSE2__)
+    return _mm_srli_epi16(x, imm8);
+#else
+    return (int32_t)(((uint32_t)x >> imm8) & ((0xFFFFu >> imm8) * 0x00010001u));
+#endif
+}
+
+// NOTE: Rounded up average of each unsigned byte, as 'pavgb'
+static inline pf_simd_i_t
+pf_simd_avg_u8(pf_simd_i_t x, pf_simd_i_t y)
+{
+#if defined(__AVX2__)
+    return _mm256_avg_epu8(x, y);
+#elif defined(__SSE2__)
+    return _mm_avg_epu8(x, y);
+#else
+    return (int32_t)(((uint32_t)x | (uint32_t)y) - ((((uint32_t)x ^ (uint32_t)y) & 0xFEFEFEFE) >> 1));
+#endif
+}
+
 static inline pf_simd_i_t
 pf_simd_slli_i32(pf_simd_i_t x, int32_t imm8)
 {
@@ -20,7 +20,7 @@
 #ifndef PF_FRAMEBUFFER_H
 #define PF_FRAMEBUFFER_H
 
-#include "../components/pf_color.h"
+#include "../components/pf_pixel.h"
 
 struct pf_framebuffer;
 
@@ -29,17 +29,65 @@ typedef void(*pf_framebuffer_map_fn)(
     pf_color_t *ptr,
     int x, int y);
 
+// NOTE: Destination formats of 'pf_framebuffer_present', named after their byte order in
+//       memory. XRGB8888 is BGRA8888 with an opaque alpha, as expected by most windowing
+//       systems. RGB565 is stored in 16-bit words with red in the high bits.
+typedef enum {
+    PF_PRESENT_FORMAT_RGBA8888 = 0,
+    PF_PRESENT_FORMAT_BGRA8888,
+    PF_PRESENT_FORMAT_XRGB8888,
+    PF_PRESENT_FORMAT_RGB888,
+    PF_PRESENT_FORMAT_RGB565,
+    PF_PRESENT_FORMAT_GRAY
+} pf_framebuffer_present_format_e;
+
+// NOTE: The integer scaling uses the largest integer factor at which the source fits in the
+//       destination, centering the result and leaving the borders untouched. It falls back
+//       to the nearest scaling when the source is larger than the destination.
+typedef enum {
+    PF_PRESENT_SCALE_NEAREST = 0,
+    PF_PRESENT_SCALE_BILINEAR,
+    PF_PRESENT_SCALE_INTEGER
+} pf_framebuffer_present_scale_e;
+
+// NOTE: The pixels of 'buffer' are stored in 'format', which can be RGBA8888, BGRA8888,
+//       RGB565 or GRAY. They are converted from and to 'pf_color_t' by the renderers when
+//       read or written, RGB565 and GRAY being read as opaque. A framebuffer initialized
+//       to zero, with an unknown format, is read and written as RGBA8888.
 typedef struct pf_framebuffer {
-    pf_color_t* buffer;
+    void* buffer;
     uint32_t w;
     uint32_t h;
+    pf_pixelformat_e format;
 } pf_framebuffer_t;
 
+// NOTE: Tiles of 'PF_DAMAGE_TILE_SIZE' pixels of a framebuffer, one bit per tile in rows
+//       of 'pitch' words. 'drawn' holds the tiles written since the last damaged fill and
+//       'cleared' those that this fill overwrote. Together they cover everything that may
+//       differ from the previous frame, which is what the damaged copies transfer.
+typedef struct {
+    uint32_t* drawn;
+    uint32_t* cleared;
+    uint32_t tiles_x, tiles_y;
+    uint32_t pitch;
+    uint32_t w, h;
+} pf_framebuffer_damage_t;
+
 pf_framebuffer_t
 pf_framebuffer_create(
     uint32_t w, uint32_t h,
     pf_color_t def);
 
+PFAPI pf_framebuffer_t
+pf_framebuffer_create_ex(
+    uint32_t w, uint32_t h,
+    pf_color_t def,
+    pf_pixelformat_e format);
+
+PFAPI bool
+pf_framebuffer_is_format_supported(
+    pf_pixelformat_e format);
+
 PFAPI void
 pf_framebuffer_delete(
     pf_framebuffer_t* fb);
@@ -48,6 +96,8 @@ PFAPI bool
 pf_framebuffer_is_valid(
     const pf_framebuffer_t* fb);
 
+// NOTE: The source rectangle is scaled to the destination one with the nearest pixel,
+//       both being inclusive like the other rectangles of the framebuffer functions.
 PFAPI void
 pf_framebuffer_copy(
     pf_framebuffer_t * restrict dst_fb,
@@ -55,12 +105,32 @@ pf_framebuffer_copy(
     const pf_framebuffer_t * restrict src_fb,
     const uint32_t src_rect[4]);
 
+// NOTE: Copies the rows of the rectangle one after the other in the framebuffer format
 PFAPI void
 pf_framebuffer_copy_pixels(
     void * restrict dst,
     const pf_framebuffer_t * restrict src_fb,
     const uint32_t src_rect[4]);
 
+// NOTE: Converts and scales the source rectangle, or the whole framebuffer, to 'dst' in a
+//       single pass, for instance to update a window surface or a streaming texture. The
+//       pitch is the size of a destination row in bytes, zero for tightly packed rows,
+//       it must keep the rows aligned on the size of the pixels of the format.
+//       The conversions are vectorized and the rows are processed by bands in parallel.
+PFAPI void
+pf_framebuffer_present(
+    void * restrict dst,
+    uint32_t dst_w, uint32_t dst_h,
+    size_t dst_pitch,
+    pf_framebuffer_present_format_e dst_format,
+    const pf_framebuffer_t * restrict src_fb,
+    const uint32_t src_rect[4],
+    pf_framebuffer_present_scale_e scale);
+
+PFAPI size_t
+pf_framebuffer_present_get_bytes(
+    pf_framebuffer_present_format_e format);
+
 PFAPI pf_color_t
 pf_framebuffer_get(
     const pf_framebuffer_t* fb,
@@ -89,4 +159,196 @@ pf_framebuffer_export_as_bmp(
     const pf_framebuffer_t* framebuffer,
     const char* filename);
 
+
+/* Damage Functions */
+
+// NOTE: The whole framebuffer is initially considered as drawn
+PFAPI pf_framebuffer_damage_t
+pf_framebuffer_damage_create(
+    uint32_t w, uint32_t h);
+
+PFAPI void
+pf_framebuffer_damage_delete(
+    pf_framebuffer_damage_t* damage);
+
+// NOTE: Marks the pixels from (x1, y1) to (x2, y2) inclusive as drawn, the rectangle being
+//       clipped to the framebuffer. Does nothing if the damage is not allocated.
+PFAPI void
+pf_framebuffer_damage_add(
+    pf_framebuffer_damage_t* damage,
+    int x1, int y1, int x2, int y2);
+
+// NOTE: Forgets all the damage, to be called after a damaged copy when the
+//       framebuffer is drawn over without being cleared
+PFAPI void
+pf_framebuffer_damage_reset(
+    pf_framebuffer_damage_t* damage);
+
+// NOTE: Marks the whole framebuffer as cleared with nothing drawn since, as after a full clear
+PFAPI void
+pf_framebuffer_damage_invalidate(
+    pf_framebuffer_damage_t* damage);
+
+// NOTE: The drawn tiles become the cleared ones, to be called once the drawn tiles of every
+//       buffer were cleared, 'pf_framebuffer_fill_damaged' doing it for a single framebuffer
+PFAPI void
+pf_framebuffer_damage_advance(
+    pf_framebuffer_damage_t* damage);
+
+// NOTE: Iterates over the damage as inclusive rectangles {x1, y1, x2, y2}, each one being a
+//       run of contiguous tiles of a row of tiles, clipped to the framebuffer. 'cursor' must
+//       be zero on the first call, false is returned once there are no more rectangles.
+//       Only the drawn tiles are visited unless 'include_cleared' is set.
+PFAPI bool
+pf_framebuffer_damage_next(
+    const pf_framebuffer_damage_t* damage,
+    bool include_cleared,
+    uint32_t* cursor,
+    uint32_t rect[4]);
+
+// NOTE: Bounding rectangle of the drawn and cleared tiles, false if there are none
+PFAPI bool
+pf_framebuffer_damage_get_bounds(
+    const pf_framebuffer_damage_t* damage,
+    uint32_t rect[4]);
+
+// NOTE: Fills the drawn tiles, which then become the cleared ones
+PFAPI void
+pf_framebuffer_fill_damaged(
+    pf_framebuffer_t* fb,
+    pf_framebuffer_damage_t* damage,
+    pf_color_t color);
+
+// NOTE: Copies the drawn and cleared tiles between two framebuffers of the same size,
+//       converting them to the format of the destination
+PFAPI void
+pf_framebuffer_copy_damaged(
+    pf_framebuffer_t * restrict dst_fb,
+    const pf_framebuffer_t * restrict src_fb,
+    const pf_framebuffer_damage_t* damage);
+
+// NOTE: Same as 'pf_framebuffer_present' without scaling, for the drawn and cleared tiles
+//       only. The destination must have the size of the framebuffer.
+PFAPI void
+pf_framebuffer_present_damaged(
+    void * restrict dst,
+    size_t dst_pitch,
+    pf_framebuffer_present_format_e dst_format,
+    const pf_framebuffer_t * restrict src_fb,
+    const pf_framebuffer_damage_t* damage);
+
+
+/* Pixel Access Functions */
+
+// NOTE: Conversions of the framebuffer formats, RGB565 and GRAY being rounded to the nearest
+static inline uint16_t
+pf_framebuffer_pack_rgb565(
+    pf_color_t color)
+{
+    uint32_t r = (color.c.r * 249 + 1014) >> 11;
+    uint32_t g = (color.c.g * 253 + 505) >> 10;
+    uint32_t b = (color.c.b * 249 + 1014) >> 11;
+    return (uint16_t)(r << 11 | g << 5 | b);
+}
+
+static inline pf_color_t
+pf_framebuffer_unpack_rgb565(
+    uint16_t pixel)
+{
+    pf_color_t result;
+    result.c.r = (uint8_t)(((pixel >> 11) * 527 + 23) >> 6);
+    result.c.g = (uint8_t)((((pixel >> 5) & 0x3F) * 259 + 33) >> 6);
+    result.c.b = (uint8_t)(((pixel & 0x1F) * 527 + 23) >> 6);
+    result.c.a = 255;
+    return result;
+}
+
+static inline uint8_t
+pf_framebuffer_pack_gray(
+    pf_color_t color)
+{
+    return (uint8_t)((color.c.r * 77 + color.c.g * 150 + color.c.b * 29 + 128) >> 8);
+}
+
+static inline uint32_t
+pf_framebuffer_swap_rb(
+    uint32_t pixel)
+{
+    return (pixel & 0xFF00FF00) | ((pixel & 0xFF) << 16) | ((pixel >> 16) & 0xFF);
+}
+
+// NOTE: Unchecked read of the pixel at 'offset', which is 'y * w + x'
+static inline pf_color_t
+pf_framebuffer_load(
+    const pf_framebuffer_t* fb,
+    size_t offset)
+{
+    pf_color_t result;
+
+    switch (fb->format) {
+        case PF_PIXELFORMAT_RGB565:
+            return pf_framebuffer_unpack_rgb565(((const uint16_t*)fb->buffer)[offset]);
+        case PF_PIXELFORMAT_GRAY:
+            result.c.r = result.c.g = result.c.b = ((const uint8_t*)fb->buffer)[offset];
+            result.c.a = 255;
+            return result;
+        case PF_PIXELFORMAT_BGRA8888:
+            result.v = pf_framebuffer_swap_rb(((const uint32_t*)fb->buffer)[offset]);
+            return result;
+        default:
+            return ((const pf_color_t*)fb->buffer)[offset];
+    }
+}
+
+// NOTE: Unchecked write of the pixel at 'offset', which is 'y * w + x'
+static inline void
+pf_framebuffer_store(
+    pf_framebuffer_t* fb,
+    size_t offset,
+    pf_color_t color)
+{
+    switch (fb->format) {
+        case PF_PIXELFORMAT_RGB565:
+            ((uint16_t*)fb->buffer)[offset] = pf_framebuffer_pack_rgb565(color);
+            break;
+        case PF_PIXELFORMAT_GRAY:
+            ((uint8_t*)fb->buffer)[offset] = pf_framebuffer_pack_gray(color);
+            break;
+        case PF_PIXELFORMAT_BGRA8888:
+            ((uint32_t*)fb->buffer)[offset] = pf_framebuffer_swap_rb(color.v);
+            break;
+        default:
+            ((pf_color_t*)fb->buffer)[offset] = color;
+            break;
+    }
+}
+
+// NOTE: Unchecked blend of 'color' over the pixel at 'offset'
+static inline void
+pf_framebuffer_blend(
+    pf_framebuffer_t* fb,
+    size_t offset,
+    pf_color_t color,
+    pf_color_blend_fn blend)
+{
+    if (fb->format == PF_PIXELFORMAT_RGBA8888) {
+        pf_color_t* ptr = (pf_color_t*)fb->buffer + offset;
+        *ptr = blend(*ptr, color);
+    } else {
+        pf_framebuffer_store(fb, offset, blend(pf_framebuffer_load(fb, offset), color));
+    }
+}
+
+// NOTE: Writes 'count' pixels from 'offset', converted several at a time with SIMD. If
+//       'blend_span' is set it blends them, else if 'blend' is set they are blended one
+//       by one. Both are given RGBA8888 pixels, read from the framebuffer if needed.
+PFAPI void
+pf_framebuffer_store_span(
+    pf_framebuffer_t* restrict fb,
+    size_t offset,
+    const pf_color_t* restrict colors,
+    size_t count,
+    pf_color_blend_fn blend,
+    pf_color_blend_span_fn blend_span);
+
 #endif //PF_FRAMEBUFFER_H
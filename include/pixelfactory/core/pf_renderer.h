@@ -29,6 +29,10 @@
 #include "pf_depthbuffer.h"
 #include <stdint.h>
 
+// NOTE: Number of samples per pixel of the multisample buffers. It is not configurable,
+//       the sample pattern of the rasterizer and the resolve being written for four samples.
+#define PF_MSAA_SAMPLES 4
+
 typedef enum {
     PF_BACK,
     PF_FRONT
@@ -57,14 +61,32 @@ typedef void(*pf_renderer_map3d_fn)(
 
 typedef enum {
     PF_RENDERER_2D = 0x01,
-    PF_RENDERER_3D = 0x02
+    PF_RENDERER_3D = 0x02,
+    PF_RENDERER_MSAA4X = 0x04,
+    PF_RENDERER_DAMAGE = 0x08
 } pf_renderer_flag_e;
 
+// NOTE: 'color_blend_span', when set, is used instead of 'color_blend' by the functions
+//       that blend whole spans at once, such as the sprite batches. It must blend like
+//       'color_blend', e.g. 'pf_color_blend_premul_span' with 'pf_color_blend_premul'.
 typedef struct {
-    pf_mat3_t           mat_view;
-    pf_color_blend_fn   color_blend;
+    pf_mat3_t               mat_view;
+    pf_color_blend_fn       color_blend;
+    pf_color_blend_span_fn  color_blend_span;
 } pf_renderer_config_2d_t;
 
+// NOTE: 'src_rect' is {x1, y1, x2, y2} in texels, the axes being flipped when x2 < x1 or
+//       y2 < y1. 'transform' maps the sprite space, where the source rectangle spans from
+//       (0, 0) to (|x2 - x1|, |y2 - y1|), to the 2D space of the renderer.
+typedef struct {
+    const pf_texture2d_t*   texture;
+    int                     src_rect[4];
+    pf_mat3_t               transform;
+    pf_color_t              tint;
+    int                     layer;
+    pf_texture2d_filter_e   filter;
+} pf_sprite2d_t;
+
 typedef struct {
     pf_mat4_t           mat_view;
     pf_mat4_t           mat_proj;
@@ -80,6 +102,23 @@ typedef struct pf_renderer {
     pf_depthbuffer_t zb;
     pf_renderer_config_3d_t* conf3d;
     pf_renderer_config_2d_t* conf2d;
+
+    // NOTE: Multisample buffers, only allocated with 'PF_RENDERER_MSAA4X'.
+    //       They store one plane of 'w*h' values per sample. Only the 3D triangles
+    //       are multisampled, they are rasterized into these planes and flag the
+    //       pixels they cover in 'msaa_coverage'. The 3D lines and points, 'map3d'
+    //       and every 2D draw still write to 'fb' and 'zb' directly. The resolve
+    //       only writes the covered pixels, so the other draws are kept where no
+    //       triangle lies, and must follow the resolve to appear over triangles.
+    pf_color_t* msaa_color;
+    float* msaa_depth;
+    uint8_t* msaa_coverage;
+
+    // NOTE: Tiles written by the draw functions, only allocated with 'PF_RENDERER_DAMAGE'.
+    //       The damaged clears only clear these tiles, the full clears invalidate the
+    //       whole framebuffer, and 'pf_framebuffer_present_damaged' can then transfer
+    //       only what changed since the previous frame.
+    pf_framebuffer_damage_t damage;
 } pf_renderer_t;
 
 
@@ -90,6 +129,15 @@ pf_renderer_load(
     uint32_t w, uint32_t h,
     pf_renderer_flag_e flags);
 
+// NOTE: Same as 'pf_renderer_load' with a framebuffer in 'format', see 'pf_framebuffer_t'.
+//       The draw functions write this format directly, the multisample buffers and the
+//       post-processing passes working in RGBA8888 internally.
+PFAPI pf_renderer_t
+pf_renderer_load_ex(
+    uint32_t w, uint32_t h,
+    pf_renderer_flag_e flags,
+    pf_pixelformat_e format);
+
 PFAPI void
 pf_renderer_delete(
     pf_renderer_t* rn);
@@ -110,6 +158,29 @@ pf_renderer_clear3d(
     pf_color_t clear_color,
     float clear_depth);
 
+// NOTE: Same as 'pf_renderer_clear2d' for the tiles drawn since the previous clear only,
+//       assuming the whole framebuffer was drawn over the same color. Falls back to a
+//       full clear without 'PF_RENDERER_DAMAGE'.
+PFAPI void
+pf_renderer_clear2d_damaged(
+    pf_renderer_t* rn,
+    pf_color_t clear_color);
+
+// NOTE: Same as 'pf_renderer_clear3d' for the tiles drawn since the previous clear only,
+//       the depth and multisample buffers included
+PFAPI void
+pf_renderer_clear3d_damaged(
+    pf_renderer_t* rn,
+    pf_color_t clear_color,
+    float clear_depth);
+
+// NOTE: Writes the average of the samples of the pixels covered by a triangle since
+//       the last clear to 'fb', and to 'zb' the sample depth that passes the depth
+//       test of 'conf3d' against the others, the nearest one without depth test
+PFAPI void
+pf_renderer_msaa_resolve(
+    pf_renderer_t* rn);
+
 PFAPI void
 pf_renderer_map3d(
     pf_renderer_t* rn,
@@ -155,6 +226,14 @@ pf_renderer_apply_camera3d_view_proj_perspective(
     pf_renderer_t* rn,
     pf_camera3d_t* cam);
 
+/* Renderer Post-Processing Functions */
+
+// NOTE: Screen-space anti-aliasing of the framebuffer based on the luminance
+//       of the pixels, in the manner of FXAA. The depth buffer is not used.
+PFAPI void
+pf_renderer_fxaa(
+    pf_renderer_t* rn);
+
 /* Renderer 2D Buffer Drawing */
 
 PFAPI void
@@ -490,6 +569,28 @@ pf_renderer_texture2d_mat_map(
     pf_mat3_t transform,
     pf_proc2d_fragment_fn frag_proc);
 
+/* Renderer 2D Sprite Batch Functions */
+
+// NOTE: Draws the sprites by increasing 'layer', grouped by texture within a layer and
+//       in the given order for a same texture. They are binned to screen tiles drawn in
+//       parallel, with the view matrix and the blend functions of 'conf2d' if defined.
+//       With premultiplied textures, the tints must be premultiplied as well.
+PFAPI void
+pf_renderer_sprites2d(
+    pf_renderer_t* rn,
+    const pf_sprite2d_t* sprites,
+    size_t count);
+
+// NOTE: Sets the transform of a sprite as 'pf_renderer_texture2d_ex' does,
+//       scaling and rotating it around its origin (ox, oy) placed at (x, y)
+PFAPI void
+pf_sprite2d_set_transform(
+    pf_sprite2d_t* sprite,
+    float x, float y,
+    float sx, float sy,
+    float r, float ox, float oy);
+
+
 /* Renderer 3D Buffer Drawing */
 
 PFAPI void
@@ -502,6 +603,12 @@ pf_renderer_vertexbuffer3d_ex(
     pf_renderer_t* rn, const pf_vertexbuffer_t* vb,
     const pf_mat4_t transform, const pf_proc3d_t* proc);
 
+PFAPI void
+pf_renderer_vertexbuffer3d_lod(
+    pf_renderer_t* rn, const pf_vertexbuffer_t* vb,
+    const pf_vertexbuffer_lod_t* lod,
+    const pf_mat4_t transform, const pf_proc3d_t* proc);
+
 PFAPI void
 pf_renderer_vertexbuffer3d_points(
     pf_renderer_t* rn, const pf_vertexbuffer_t* vb,
@@ -564,4 +671,15 @@ pf_renderer_triangle3d(
     const pf_vec3_t p3,
     pf_color_t color);
 
+/* Renderer 3D Fragment Functions */
+
+// NOTE: Only valid within a 3D fragment processor, gives the screen space derivatives of the
+//       texture coordinates of the fragment being shaded, for 'pf_texture2d_compute_lod'.
+//       Returns false, with null derivatives, if the triangle has no float texcoords.
+PFAPI bool
+pf_renderer_get_texcoord_gradient(
+    const pf_renderer_t* rn,
+    pf_vec2_t duv_dx,
+    pf_vec2_t duv_dy);
+
 #endif //PF_RENDERER3D_H
@@ -21,6 +21,45 @@
 #define PF_TEXTURE2D_H
 
 #include "../components/pf_pixel.h"
+#include "../math/pf_vec2.h"
+
+#ifndef PF_TEXTURE_BLOCK_CACHE_SIZE
+// NOTE: Number of decoded 4x4 blocks of compressed textures kept by each thread,
+//       must be a power of two of at least 32 so that the 8x4 neighboring blocks mapped
+//       onto the cache never evict each other.
+#   define PF_TEXTURE_BLOCK_CACHE_SIZE 32
+#endif //PF_TEXTURE_BLOCK_CACHE_SIZE
+
+#if PF_TEXTURE_BLOCK_CACHE_SIZE < 32 || (PF_TEXTURE_BLOCK_CACHE_SIZE & (PF_TEXTURE_BLOCK_CACHE_SIZE - 1)) != 0
+#   error "PF_TEXTURE_BLOCK_CACHE_SIZE must be a power of two of at least 32"
+#endif
+
+#ifndef PF_MAX_MIPMAPS
+// NOTE: Maximum number of levels below the base level of a texture,
+//       enough for a full chain down to 1x1 from a 32768 texels side.
+#   define PF_MAX_MIPMAPS 15
+#endif //PF_MAX_MIPMAPS
+
+// NOTE: Order in which the texels of uncompressed textures are stored. The tiled layout
+//       stores 4x4 tiles one after the other, in row-major order, padding the edges to a
+//       multiple of 4. The Morton layout follows a Z-order curve inside squares whose side
+//       is the smallest dimension, which must be a power of two, stacked along the other.
+typedef enum {
+    PF_TEXTURE_LAYOUT_LINEAR = 0,
+    PF_TEXTURE_LAYOUT_TILED,
+    PF_TEXTURE_LAYOUT_MORTON
+} pf_texture2d_layout_e;
+
+// NOTE: Repeating textures with power of two dimensions use a faster mapper
+typedef enum {
+    PF_TEXTURE_WRAP_REPEAT = 0,
+    PF_TEXTURE_WRAP_CLAMP
+} pf_texture2d_wrap_e;
+
+typedef enum {
+    PF_TEXTURE_FILTER_NEAREST = 0,
+    PF_TEXTURE_FILTER_BILINEAR
+} pf_texture2d_filter_e;
 
 struct pf_texture2d;
 
@@ -33,15 +72,25 @@ typedef pf_color_t(*pf_texture2d_sampler_fn)(
     const struct pf_texture2d*,
     float u, float v);
 
+// NOTE: Compressed textures have no 'getter' nor 'setter' but a 'decoder', their texels
+//       are read through 'pf_texture2d_get_texel' which decodes and caches whole blocks.
+//       The mipmap level 'i' has a size of max(1, w >> i) by max(1, h >> i), the levels
+//       below the base one ('texels') are stored in a single allocation starting at
+//       'mipmaps[0]', released by 'pf_texture2d_delete'. All the levels share the same
+//       'layout', the getter and setter take an index given by 'pf_texture2d_get_index'.
 typedef struct pf_texture2d {
-    void*                   texels;
-    pf_texture2d_sampler_fn sampler;
-    pf_texture2d_mapper_fn  mapper;
-    pf_pixel_getter_fn      getter;
-    pf_pixel_setter_fn      setter;
-    uint32_t                w, h;
-    float                   tx, ty;
-    pf_pixelformat_e        format;
+    void*                       texels;
+    pf_texture2d_sampler_fn     sampler;
+    pf_texture2d_mapper_fn      mapper;
+    pf_pixel_getter_fn          getter;
+    pf_pixel_setter_fn          setter;
+    pf_pixel_block_decoder_fn   decoder;
+    uint32_t                    w, h;
+    float                       tx, ty;
+    pf_pixelformat_e            format;
+    pf_texture2d_layout_e       layout;
+    void*                       mipmaps[PF_MAX_MIPMAPS];
+    uint32_t                    num_mipmaps;
 } pf_texture2d_t;
 
 
@@ -50,10 +99,46 @@ pf_texture2d_create(
     void* pixels, uint32_t w, uint32_t h,
     pf_pixelformat_e format);
 
+// NOTE: The row-major pixels are converted once to the given layout, they are then
+//       released and replaced by a new buffer. If the conversion fails, the texture
+//       is kept in the linear layout.
+PFAPI pf_texture2d_t
+pf_texture2d_create_ex(
+    void* pixels, uint32_t w, uint32_t h,
+    pf_pixelformat_e format,
+    pf_texture2d_layout_e layout);
+
 PFAPI void
 pf_texture2d_delete(
     pf_texture2d_t* tex);
 
+PFAPI pf_color_t
+pf_texture2d_get_texel(
+    const pf_texture2d_t* tex,
+    uint32_t x, uint32_t y);
+
+PFAPI size_t
+pf_texture2d_get_index(
+    const pf_texture2d_t* tex,
+    uint32_t x, uint32_t y);
+
+// NOTE: Converts the texels of an uncompressed texture to premultiplied alpha, to be
+//       blended with 'pf_color_blend_premul'. Its filtered samples are then free of the
+//       dark fringes of straight alpha. The mipmaps, if any, are generated again.
+PFAPI bool
+pf_texture2d_premultiply(
+    pf_texture2d_t* tex);
+
+
+/* Layout Functions */
+
+// NOTE: Converts the texels and the mipmaps of an uncompressed texture to another layout,
+//       Morton order requires power of two dimensions. The previous buffers are released.
+PFAPI bool
+pf_texture2d_set_layout(
+    pf_texture2d_t* tex,
+    pf_texture2d_layout_e layout);
+
 
 /* Map Functions */
 
@@ -88,11 +173,76 @@ pf_texture2d_sample_bilinear(
     const pf_texture2d_t* tex,
     float u, float v);
 
+// NOTE: Bilinearly samples 'count' coordinates at once, several at a time with SIMD for
+//       linear RGBA8888 textures using the 'wrap_pot' or 'clamp' mapper. The result is
+//       the same as calling 'pf_texture2d_sample_bilinear' for each coordinate.
+PFAPI void
+pf_texture2d_sample_bilinear_batch(
+    const pf_texture2d_t* tex,
+    pf_color_t* restrict colors,
+    const float* restrict u,
+    const float* restrict v,
+    size_t count);
+
+// NOTE: Fetches 'count' texels at the texel space coordinates (x + i*dx, y + i*dy), the
+//       texel (i, j) covering [i, i+1) x [j, j+1). The coordinates are clamped to 'rect',
+//       {x1, y1, x2, y2} with exclusive upper bounds, which must lie within the texture.
+//       The mapper and the sampler of the texture are not used.
+PFAPI void
+pf_texture2d_fetch_span(
+    const pf_texture2d_t* tex,
+    pf_color_t* restrict colors,
+    const int rect[4],
+    float x, float y,
+    float dx, float dy,
+    pf_texture2d_filter_e filter,
+    size_t count);
+
+// NOTE: Sets the mapper and the sampler of the texture, the sampler being specialized
+//       for the format, the mapper and the filter when one exists. It is called with
+//       repeat and nearest by 'pf_texture2d_create'.
+PFAPI void
+pf_texture2d_set_sampling(
+    pf_texture2d_t* tex,
+    pf_texture2d_wrap_e wrap,
+    pf_texture2d_filter_e filter);
+
+
+/* Mipmap Functions */
+
+// NOTE: Generates the whole chain of box filtered levels down to 1x1, replacing the
+//       previous one. Compressed textures have no setter and are not supported.
+PFAPI bool
+pf_texture2d_gen_mipmaps(
+    pf_texture2d_t* tex);
+
+// NOTE: Returns the level of detail, log2 of the texels covered by a pixel along its
+//       longest axis, from the screen space derivatives of the texture coordinates.
+PFAPI float
+pf_texture2d_compute_lod(
+    const pf_texture2d_t* tex,
+    const pf_vec2_t duv_dx,
+    const pf_vec2_t duv_dy);
+
+// NOTE: Samples the nearest level with the sampler of the texture.
+PFAPI pf_color_t
+pf_texture2d_sample_nearest_mip(
+    const pf_texture2d_t* tex,
+    float u, float v, float lod);
+
+// NOTE: Samples the two nearest levels bilinearly and blends them.
+PFAPI pf_color_t
+pf_texture2d_sample_trilinear(
+    const pf_texture2d_t* tex,
+    float u, float v, float lod);
+
 
 /* TEXTURE2D EXTENSION */
 
 #ifdef PF_EXT_TEXTURE2D
 
+// NOTE: DDS files in BC1, BC3, BC4 or BC5 are kept compressed, only their first
+//       level is loaded. The other files are decoded by stb_image.
 PFAPI pf_texture2d_t
 pfext_texture2d_load(
     const char* file_path);
@@ -101,6 +251,13 @@ PFAPI pf_texture2d_t
 pfext_texture2d_load_from_memory(
     const void* buffer, size_t size);
 
+// NOTE: Same as 'pfext_texture2d_load', the texels being premultiplied by alpha if
+//       'premultiply' is set, which compressed textures do not support.
+PFAPI pf_texture2d_t
+pfext_texture2d_load_ex(
+    const char* file_path,
+    bool premultiply);
+
 PFAPI pf_texture2d_t
 pfext_texture2d_gen_color(
     uint32_t w, uint32_t h,
@@ -0,0 +1,110 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PF_TEXTURE_ATLAS_H
+#define PF_TEXTURE_ATLAS_H
+
+#include "pf_texture2d.h"
+
+#ifndef PF_TEXTURE_ATLAS_MAX_PAGES
+// NOTE: Maximum number of textures ('pages') of an atlas. They are stored in the
+//       atlas itself, so their addresses never change as long as the atlas stays.
+#   define PF_TEXTURE_ATLAS_MAX_PAGES 8
+#endif //PF_TEXTURE_ATLAS_MAX_PAGES
+
+// NOTE: 'rect' is {x1, y1, x2, y2} in texels of the page, as taken by the 2D texture
+//       drawing functions and the sprites, 'uv' is the same rectangle normalized.
+typedef struct {
+    uint32_t page;
+    int rect[4];
+    float uv[4];
+} pf_texture_atlas_region_t;
+
+// NOTE: Segment of the skyline of a page, the height 'y' being filled from 'x' to 'x + w'
+typedef struct {
+    uint32_t x, y, w;
+} pf_texture_atlas_node_t;
+
+// NOTE: Each region is surrounded by 'padding' texels replicating its edges, the cell
+//       it occupies being aligned on 'alignment' texels in both directions so that the
+//       first log2(alignment) mipmap levels of the pages never mix different regions.
+typedef struct {
+    pf_texture2d_t pages[PF_TEXTURE_ATLAS_MAX_PAGES];
+    pf_texture_atlas_node_t* skylines[PF_TEXTURE_ATLAS_MAX_PAGES];
+    uint32_t num_nodes[PF_TEXTURE_ATLAS_MAX_PAGES];
+    uint32_t num_pages;
+    uint32_t max_pages;
+    uint32_t w, h;
+    uint32_t padding;
+    uint32_t alignment;
+    pf_pixelformat_e format;
+} pf_texture_atlas_t;
+
+
+/* Atlas Functions */
+
+// NOTE: Creates an atlas of pages of 'w' by 'h' texels, which must be multiples of
+//       1 << 'mip_levels', in an uncompressed format. Only the first page is allocated,
+//       the others are added as needed, up to 'max_pages'.
+PFAPI pf_texture_atlas_t
+pf_texture_atlas_create(
+    uint32_t w, uint32_t h,
+    pf_pixelformat_e format,
+    uint32_t max_pages,
+    uint32_t padding,
+    uint32_t mip_levels);
+
+PFAPI void
+pf_texture_atlas_delete(
+    pf_texture_atlas_t* atlas);
+
+// NOTE: Empties the pages to reuse the atlas, the texels are cleared to zero.
+PFAPI void
+pf_texture_atlas_clear(
+    pf_texture_atlas_t* atlas);
+
+// NOTE: Packs a rectangle {x1, y1, x2, y2} of a texture of any format, or the whole
+//       texture when 'src_rect' is NULL, at the lowest position available in the first
+//       page where it fits. The mipmaps of the page, if any, must be regenerated.
+PFAPI bool
+pf_texture_atlas_add(
+    pf_texture_atlas_t* atlas,
+    const pf_texture2d_t* tex,
+    const int* src_rect,
+    pf_texture_atlas_region_t* region);
+
+PFAPI bool
+pf_texture_atlas_add_pixels(
+    pf_texture_atlas_t* atlas,
+    const void* pixels,
+    uint32_t w, uint32_t h,
+    pf_pixelformat_e format,
+    pf_texture_atlas_region_t* region);
+
+// NOTE: Packs whole textures from the tallest to the shortest, which wastes less space
+//       than adding them in any order. Returns the number of textures packed, those that
+//       did not fit having an empty region.
+PFAPI size_t
+pf_texture_atlas_add_batch(
+    pf_texture_atlas_t* atlas,
+    const pf_texture2d_t* textures,
+    size_t count,
+    pf_texture_atlas_region_t* regions);
+
+#endif //PF_TEXTURE_ATLAS_H
@@ -4,15 +4,70 @@
 #include "../components/pf_attribute.h"
 #include "../components/pf_color.h"
 
+/* Vertex Buffer Definitions */
+
+#ifndef PF_PRIMITIVE_RESTART_INDEX
+// NOTE: When 'primitive_restart' is enabled on an indexed vertex buffer,
+//       this index ends the current strip/fan and starts a new one.
+#   define PF_PRIMITIVE_RESTART_INDEX 0xFFFF
+#endif //PF_PRIMITIVE_RESTART_INDEX
+
+#ifndef PF_MAX_LOD_LEVELS
+#   define PF_MAX_LOD_LEVELS 8
+#endif //PF_MAX_LOD_LEVELS
+
+#ifndef PF_OBJ_BLOCK_SIZE
+// NOTE: Size in bytes of the blocks read from an OBJ file, each block being parsed
+//       in parallel before the next one is read. It is doubled for longer lines.
+#   define PF_OBJ_BLOCK_SIZE (16 << 20)
+#endif //PF_OBJ_BLOCK_SIZE
+
+#ifndef PF_VERTEXBUFFER_BIN_ALIGNMENT
+// NOTE: Alignment in bytes of each array stored in a binary vertex buffer file,
+//       relative to the start of the file, which is itself mapped on a page boundary.
+#   define PF_VERTEXBUFFER_BIN_ALIGNMENT 64
+#endif //PF_VERTEXBUFFER_BIN_ALIGNMENT
+
+#ifndef PF_LOD_PIXELS_PER_TRIANGLE
+// NOTE: When drawing with a LOD chain, the finest level having at most one triangle
+//       per this number of pixels covered by the projected bounding sphere is chosen.
+#   define PF_LOD_PIXELS_PER_TRIANGLE 16
+#endif //PF_LOD_PIXELS_PER_TRIANGLE
+
 /* Vertex Buffer Types */
 
+typedef enum {
+    PF_TRIANGLES = 0,
+    PF_TRIANGLE_STRIP,
+    PF_TRIANGLE_FAN
+} pf_topology_e;
+
+// NOTE: 'mapping' is set when the attributes or the indices point directly into a memory
+//       mapped file, shared by all the vertex buffers loaded from it. These buffers are
+//       not released by 'pf_vertexbuffer_delete', the file is unmapped with the last
+//       vertex buffer referencing it. Writing to them only modifies the private copy.
 typedef struct {
     pf_attribute_t attributes[PF_MAX_ATTRIBUTES];
     uint16_t* indices;
     uint32_t num_vertices;
     uint32_t num_indices;
+    pf_topology_e topology;
+    bool primitive_restart;
+    void* mapping;
 } pf_vertexbuffer_t;
 
+// NOTE: The first level of a LOD chain is the index buffer of the vertex buffer itself,
+//       the bounding sphere is expressed in model space. As for vertex buffers, 'mapping'
+//       is set when the levels point into a memory mapped file.
+typedef struct {
+    uint16_t* indices[PF_MAX_LOD_LEVELS];
+    uint32_t num_indices[PF_MAX_LOD_LEVELS];
+    uint32_t num_levels;
+    pf_vec3_t center;
+    float radius;
+    void* mapping;
+} pf_vertexbuffer_lod_t;
+
 /* Helper Vertex Buffer Functions */
 
 PFAPI pf_vertexbuffer_t
@@ -34,6 +89,24 @@ PFAPI void
 pf_vertexbuffer_delete(
     pf_vertexbuffer_t* vb);
 
+/* Level Of Detail Functions */
+
+PFAPI uint16_t*
+pf_vertexbuffer_simplify(
+    const pf_vertexbuffer_t* vb,
+    uint32_t target_num_indices,
+    uint32_t* out_num_indices);
+
+PFAPI pf_vertexbuffer_lod_t
+pf_vertexbuffer_lod_create(
+    const pf_vertexbuffer_t* vb,
+    uint32_t num_levels,
+    float reduction);
+
+PFAPI void
+pf_vertexbuffer_lod_delete(
+    pf_vertexbuffer_lod_t* lod);
+
 /* VERTEX BUFFER EXTENSION */
 
 
@@ -41,16 +114,56 @@ pf_vertexbuffer_delete(
 
 /* Loading Functions */
 
+// NOTE: Each distinct (v, vt, vn) triplet becomes a vertex, polygons are triangulated as
+//       fans, or skipped if 'triangulate' is false. Groups and materials are ignored.
+//       Indices are 16 bits, so the file is rejected if it declares more than 65536
+//       positions ('v' lines, used or not) or yields more than 65536 distinct vertices.
+//       The vertices and triangles are then reordered by 'pfext_vertexbuffer_optimize',
+//       so they do not keep the order of the file.
 PFAPI pf_vertexbuffer_t
 pfext_vertexbuffer_load_obj(
     const char* file_path,
     bool triangulate);
 
+// NOTE: The file is memory mapped, the attributes and indices whose layout is supported
+//       are used in place from the binary chunk of a GLB file, the others are converted.
+//       Each primitive of each mesh is loaded into its own vertex buffer, only triangle,
+//       strip and fan primitives with indices below 65536 are supported.
+//       The vertex buffers that are not used in place are reordered by
+//       'pfext_vertexbuffer_optimize', so they do not keep the order of the file.
+//       Returns NULL on failure, the vertex buffers must be released one by one.
 PFAPI pf_vertexbuffer_t*
 pfext_vertexbuffer_load_gltf(
     const char* file_path,
     int* num_vertexbuffer);
 
+/* Binary Cache Functions */
+
+// NOTE: Writes the vertex buffer, and its LOD chain if not NULL, in a versioned binary
+//       format in native byte order. The attributes are stored tightly packed, each
+//       array aligned on 'PF_VERTEXBUFFER_BIN_ALIGNMENT' bytes.
+PFAPI bool
+pfext_vertexbuffer_save_bin(
+    const char* file_path,
+    const pf_vertexbuffer_t* vb,
+    const pf_vertexbuffer_lod_t* lod);
+
+// NOTE: The file is memory mapped and the arrays are used in place, without any copy.
+//       The LOD chain is loaded if 'lod' is not NULL, it is empty if none was saved.
+PFAPI pf_vertexbuffer_t
+pfext_vertexbuffer_load_bin(
+    const char* file_path,
+    pf_vertexbuffer_lod_t* lod);
+
+/* Optimization Functions */
+
+// NOTE: Reorders the triangles of an indexed triangle list for the post-transform
+//       vertex cache (Tipsify) then by clusters to reduce overdraw, and finally
+//       renumbers the vertices in order of first use for fetch locality.
+PFAPI void
+pfext_vertexbuffer_optimize(
+    pf_vertexbuffer_t* vb);
+
 /* Generation Functions */
 
 PFAPI pf_vertexbuffer_t
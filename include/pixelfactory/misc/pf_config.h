@@ -44,6 +44,27 @@
 #   define PF_MAX_CLIPPED_POLYGON_VERTICES 12
 #endif //PF_MAX_CLIPPED_POLYGON_VERTICES
 
+#ifndef PF_VERTEX_CACHE_SIZE
+// NOTE: Number of processed vertices kept by the 3D vertex buffer renderer for
+//       indexed triangle lists, also used by 'pfext_vertexbuffer_optimize'.
+#   define PF_VERTEX_CACHE_SIZE 16
+#endif //PF_VERTEX_CACHE_SIZE
+
+#ifndef PF_FXAA_EDGE_THRESHOLD_SHIFT
+// NOTE: A pixel is processed by 'pf_renderer_fxaa' when the luma contrast of its
+//       neighborhood is at least its maximum luma shifted right by this value,
+//       and at least 'PF_FXAA_EDGE_THRESHOLD_MIN' (luma range is 0..255).
+#   define PF_FXAA_EDGE_THRESHOLD_SHIFT 3
+#endif //PF_FXAA_EDGE_THRESHOLD_SHIFT
+
+#ifndef PF_FXAA_EDGE_THRESHOLD_MIN
+#   define PF_FXAA_EDGE_THRESHOLD_MIN 16
+#endif //PF_FXAA_EDGE_THRESHOLD_MIN
+
+#ifndef PF_FXAA_SEARCH_STEPS
+#   define PF_FXAA_SEARCH_STEPS 8
+#endif //PF_FXAA_SEARCH_STEPS
+
 #ifndef PF_OMP_BUFFER_COPY_SIZE_THRESHOLD
 #    define PF_OMP_BUFFER_COPY_SIZE_THRESHOLD 640*480
 #endif //PF_OMP_BUFFER_COPY_SIZE_THRESHOLD
@@ -60,6 +81,24 @@
 #   define PF_OMP_TRIANGLE_AABB_THRESHOLD 32*32
 #endif //PF_OMP_TRIANGLE_AABB_THRESHOLD
 
+#ifndef PF_RASTER_TILE_SIZE
+// NOTE: Size in pixels of the square tiles distributed to the threads
+//       when a large triangle is rasterized in parallel.
+#   define PF_RASTER_TILE_SIZE 32
+#endif //PF_RASTER_TILE_SIZE
+
+#ifndef PF_SPRITE_TILE_SIZE
+// NOTE: Size in pixels of the square screen tiles in which the sprites of a batch
+//       are binned, each tile being drawn entirely by one thread.
+#   define PF_SPRITE_TILE_SIZE 64
+#endif //PF_SPRITE_TILE_SIZE
+
+#ifndef PF_DAMAGE_TILE_SIZE
+// NOTE: Size in pixels of the square tiles in which the regions
+//       written to a framebuffer are tracked, see 'PF_RENDERER_DAMAGE'.
+#   define PF_DAMAGE_TILE_SIZE 32
+#endif //PF_DAMAGE_TILE_SIZE
+
 #ifndef PF_OMP_CLEAR_BUFFER_SIZE_THRESHOLD
 #    define PF_OMP_CLEAR_BUFFER_SIZE_THRESHOLD 640*480
 #endif //PF_OPENMP_CLEAR_BUFFER_SIZE_THRESHOLD
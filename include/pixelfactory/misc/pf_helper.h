@@ -64,4 +64,12 @@
 #   define DIAGNOSTIC_IGNORE_UNUSED_PARAMETER
 #endif
 
+#ifndef PF_THREAD_LOCAL
+#   if defined(_MSC_VER)
+#       define PF_THREAD_LOCAL __declspec(thread)
+#   else
+#       define PF_THREAD_LOCAL __thread
+#   endif
+#endif //PF_THREAD_LOCAL
+
 #endif //PF_HELPER_H
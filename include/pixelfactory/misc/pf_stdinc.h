@@ -33,6 +33,10 @@
 #   define PF_CALLOC(count, size) (calloc(count, size))
 #endif //PF_CALLOC
 
+#ifndef PF_REALLOC
+#   define PF_REALLOC(ptr, size) (realloc(ptr, size))
+#endif //PF_REALLOC
+
 #ifndef PF_FREE
 #   define PF_FREE(ptr) (free(ptr))
 #endif //PF_FREE
@@ -32,6 +32,7 @@
 #include "core/pf_framebuffer.h"
 #include "core/pf_renderer.h"
 #include "core/pf_texture2d.h"
+#include "core/pf_texture_atlas.h"
 #include "core/pf_vertexbuffer.h"
 
 #include "math/pf_math.h"
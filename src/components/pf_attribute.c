@@ -18,20 +18,192 @@
  */
 
 #include "pixelfactory/components/pf_attribute.h"
+#include "pixelfactory/misc/pf_helper.h"
+#include <stdio.h>
+#include <string.h>
 
-/* Attribute Functions */
+/* Internal Conversion Functions */
 
-void*
-pf_attribute_get_elem_ptr(const pf_attribute_t* attr, size_t index)
+static inline float
+pf_attribute_half_to_float_INTERNAL(uint16_t h)
+{
+    union { uint32_t u; float f; } result;
+
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1F;
+    uint32_t mant = h & 0x3FF;
+
+    if (exp == 0x1F) {
+        result.u = sign | 0x7F800000 | (mant << 13);    // Inf or NaN
+    } else if (exp != 0) {
+        result.u = sign | ((exp + 112) << 23) | (mant << 13);
+    } else {
+        result.f = mant * (1.0f / (1 << 24));           // Zero or subnormal
+        result.u |= sign;
+    }
+
+    return result.f;
+}
+
+static inline uint16_t
+pf_attribute_float_to_half_INTERNAL(float f)
 {
-    uint8_t element_size = 0;
+    union { float f; uint32_t u; } value = { f };
+
+    uint32_t sign = (value.u >> 16) & 0x8000;
+    int32_t exp = (int32_t)((value.u >> 23) & 0xFF) - 112;
+    uint32_t mant = value.u & 0x7FFFFF;
+
+    if (exp == 0xFF - 112) {
+        return sign | 0x7C00 | (mant ? 0x200 : 0);      // Inf or NaN
+    }
+    if (exp >= 0x1F) {
+        return sign | 0x7C00;                           // Overflow
+    }
+
+    // NOTE: Both branches round to nearest even, a carry
+    //       out of the mantissa correctly increments the exponent
+
+    if (exp <= 0) {
+        if (exp < -10) return sign;
+        mant |= 0x800000;
+        uint32_t shift = 14 - exp;
+        uint32_t half = mant >> shift;
+        uint32_t rem = mant & ((1u << shift) - 1);
+        uint32_t mid = 1u << (shift - 1);
+        if (rem > mid || (rem == mid && (half & 1))) ++half;
+        return sign | half;
+    }
+
+    uint32_t half = ((uint32_t)exp << 10) | (mant >> 13);
+    uint32_t rem = mant & 0x1FFF;
+    if (rem > 0x1000 || (rem == 0x1000 && (half & 1))) ++half;
+    return sign | half;
+}
+
+static void
+pf_attribute_decode_INTERNAL(const pf_attribute_t* attr, size_t index, float out[4])
+{
+    const void* ptr = pf_attribute_get_elem_ptr(attr, index);
+
+    switch (attr->type) {
+        case PF_ATTRIB_FLOAT:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) out[i] = ((const float*)ptr)[i];
+            break;
+        case PF_ATTRIB_UBYTE:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) out[i] = ((const uint8_t*)ptr)[i];
+            break;
+        case PF_ATTRIB_HALF:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) out[i] = pf_attribute_half_to_float_INTERNAL(((const uint16_t*)ptr)[i]);
+            break;
+        case PF_ATTRIB_SNORM8:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) out[i] = PF_MAX(((const int8_t*)ptr)[i] * (1.0f / 127), -1.0f);
+            break;
+        case PF_ATTRIB_UNORM8:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) out[i] = ((const uint8_t*)ptr)[i] * (1.0f / 255);
+            break;
+        case PF_ATTRIB_SNORM16:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) out[i] = PF_MAX(((const int16_t*)ptr)[i] * (1.0f / 32767), -1.0f);
+            break;
+        case PF_ATTRIB_UNORM16:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) out[i] = ((const uint16_t*)ptr)[i] * (1.0f / 65535);
+            break;
+        case PF_ATTRIB_SNORM_10_10_10_2: {
+            uint32_t packed; memcpy(&packed, ptr, sizeof(uint32_t));
+            out[0] = PF_MAX(((int32_t)(packed << 22) >> 22) * (1.0f / 511), -1.0f);
+            out[1] = PF_MAX(((int32_t)(packed << 12) >> 22) * (1.0f / 511), -1.0f);
+            out[2] = PF_MAX(((int32_t)(packed << 2) >> 22) * (1.0f / 511), -1.0f);
+            out[3] = PF_MAX((float)((int32_t)packed >> 30), -1.0f);
+        } break;
+        case PF_ATTRIB_UNORM_10_10_10_2: {
+            uint32_t packed; memcpy(&packed, ptr, sizeof(uint32_t));
+            out[0] = (packed & 0x3FF) * (1.0f / 1023);
+            out[1] = ((packed >> 10) & 0x3FF) * (1.0f / 1023);
+            out[2] = ((packed >> 20) & 0x3FF) * (1.0f / 1023);
+            out[3] = (packed >> 30) * (1.0f / 3);
+        } break;
+    }
+}
+
+static void
+pf_attribute_encode_INTERNAL(pf_attribute_t* attr, size_t index, const float in[4])
+{
+    void* ptr = pf_attribute_get_elem_ptr(attr, index);
+
+#   define PF_SNORM(V, MAX) (roundf(PF_CLAMP((V), -1.0f, 1.0f) * (MAX)))
+#   define PF_UNORM(V, MAX) (roundf(PF_CLAMP((V), 0.0f, 1.0f) * (MAX)))
+
+    switch (attr->type) {
+        case PF_ATTRIB_FLOAT:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) ((float*)ptr)[i] = in[i];
+            break;
+        case PF_ATTRIB_UBYTE:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) ((uint8_t*)ptr)[i] = (uint8_t)PF_CLAMP(in[i], 0.0f, 255.0f);
+            break;
+        case PF_ATTRIB_HALF:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) ((uint16_t*)ptr)[i] = pf_attribute_float_to_half_INTERNAL(in[i]);
+            break;
+        case PF_ATTRIB_SNORM8:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) ((int8_t*)ptr)[i] = (int8_t)PF_SNORM(in[i], 127);
+            break;
+        case PF_ATTRIB_UNORM8:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) ((uint8_t*)ptr)[i] = (uint8_t)PF_UNORM(in[i], 255);
+            break;
+        case PF_ATTRIB_SNORM16:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) ((int16_t*)ptr)[i] = (int16_t)PF_SNORM(in[i], 32767);
+            break;
+        case PF_ATTRIB_UNORM16:
+            for (int_fast8_t i = 0; i < attr->comp; ++i) ((uint16_t*)ptr)[i] = (uint16_t)PF_UNORM(in[i], 65535);
+            break;
+        case PF_ATTRIB_SNORM_10_10_10_2: {
+            uint32_t packed = ((uint32_t)(int32_t)PF_SNORM(in[0], 511) & 0x3FF)
+                            | ((uint32_t)(int32_t)PF_SNORM(in[1], 511) & 0x3FF) << 10
+                            | ((uint32_t)(int32_t)PF_SNORM(in[2], 511) & 0x3FF) << 20
+                            | ((uint32_t)(int32_t)PF_SNORM(in[3], 1) & 0x3) << 30;
+            memcpy(ptr, &packed, sizeof(uint32_t));
+        } break;
+        case PF_ATTRIB_UNORM_10_10_10_2: {
+            uint32_t packed = (uint32_t)PF_UNORM(in[0], 1023)
+                            | (uint32_t)PF_UNORM(in[1], 1023) << 10
+                            | (uint32_t)PF_UNORM(in[2], 1023) << 20
+                            | (uint32_t)PF_UNORM(in[3], 3) << 30;
+            memcpy(ptr, &packed, sizeof(uint32_t));
+        } break;
+    }
 
+#   undef PF_SNORM
+#   undef PF_UNORM
+}
+
+/* Attribute Functions */
+
+size_t
+pf_attribute_get_elem_size(const pf_attribute_t* attr)
+{
     switch (attr->type) {
-        case PF_ATTRIB_FLOAT: element_size = sizeof(float); break;
-        case PF_ATTRIB_UBYTE: element_size = sizeof(uint8_t); break;
+        case PF_ATTRIB_FLOAT: return sizeof(float) * attr->comp;
+        case PF_ATTRIB_UBYTE: return sizeof(uint8_t) * attr->comp;
+        case PF_ATTRIB_HALF: return sizeof(uint16_t) * attr->comp;
+        case PF_ATTRIB_SNORM8: return sizeof(int8_t) * attr->comp;
+        case PF_ATTRIB_UNORM8: return sizeof(uint8_t) * attr->comp;
+        case PF_ATTRIB_SNORM16: return sizeof(int16_t) * attr->comp;
+        case PF_ATTRIB_UNORM16: return sizeof(uint16_t) * attr->comp;
+        case PF_ATTRIB_SNORM_10_10_10_2: return sizeof(uint32_t);
+        case PF_ATTRIB_UNORM_10_10_10_2: return sizeof(uint32_t);
     }
+    return 0;
+}
 
-    return (char*)attr->buffer + index * element_size * attr->comp;
+size_t
+pf_attribute_get_stride(const pf_attribute_t* attr)
+{
+    return (attr->stride > 0) ? attr->stride : pf_attribute_get_elem_size(attr);
+}
+
+void*
+pf_attribute_get_elem_ptr(const pf_attribute_t* attr, size_t index)
+{
+    return (char*)attr->buffer + attr->offset + index * pf_attribute_get_stride(attr);
 }
 
 pf_attrib_elem_t
@@ -39,28 +211,88 @@ pf_attribute_get_elem(const pf_attribute_t* attr, size_t index)
 {
 #define PF_ATTRIBUTE_GET_ELEM_CASE(TYPE, CTYPE)                         \
     case TYPE: {                                                        \
-        CTYPE* ptr = (CTYPE*)attr->buffer + index * attr->comp;         \
+        CTYPE* ptr = pf_attribute_get_elem_ptr(attr, index);            \
         for (int_fast8_t i = 0; i < attr->comp; ++i) {                  \
             result.value[i].v_##CTYPE = ptr[i];                         \
         }                                                               \
     } break;
 
     pf_attrib_elem_t result;
+    result.type = attr->type;
 
     switch (attr->type) {
         PF_ATTRIBUTE_GET_ELEM_CASE(PF_ATTRIB_FLOAT, float)
         PF_ATTRIBUTE_GET_ELEM_CASE(PF_ATTRIB_UBYTE, uint8_t)
-        default:
-            break;
+        default: {
+            float values[4];
+            pf_attribute_decode_INTERNAL(attr, index, values);
+            for (int_fast8_t i = 0; i < attr->comp; ++i) {
+                result.value[i].v_float = values[i];
+            }
+            result.type = PF_ATTRIB_FLOAT;
+        } break;
     }
 
-    result.type = attr->type;
     result.comp = attr->comp;
     result.used = attr->used;
 
     return result;
 }
 
+pf_attrib_elem_t
+pf_attribute_get_color_elem(const pf_attribute_t* attr, size_t index)
+{
+    if (attr->type == PF_ATTRIB_FLOAT || attr->type == PF_ATTRIB_UBYTE) {
+        return pf_attribute_get_elem(attr, index);
+    }
+
+    // NOTE: Missing components default to an opaque black
+
+    float values[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    pf_attribute_decode_INTERNAL(attr, index, values);
+
+    pf_attrib_elem_t result;
+    result.type = PF_ATTRIB_UBYTE;
+    result.comp = 4;
+    result.used = attr->used;
+
+    for (int_fast8_t i = 0; i < 4; ++i) {
+        result.value[i].v_uint8_t = (uint8_t)roundf(PF_CLAMP(values[i], 0.0f, 1.0f) * 255);
+    }
+
+    return result;
+}
+
+pf_attribute_t
+pf_attribute_convert(const pf_attribute_t* attr, pf_attrib_type_e type)
+{
+    pf_attribute_t result = { 0 };
+
+    if (attr->type != PF_ATTRIB_FLOAT || attr->buffer == NULL) {
+        fprintf(stderr, "ERROR: Only attributes of type 'PF_ATTRIB_FLOAT' can be converted\n");
+        return result;
+    }
+
+    result.size = attr->size;
+    result.type = type;
+    result.comp = attr->comp;
+
+    result.buffer = PF_MALLOC(result.size * pf_attribute_get_elem_size(&result));
+    if (result.buffer == NULL) {
+        return (pf_attribute_t) { 0 };
+    }
+
+    for (size_t i = 0; i < attr->size; ++i) {
+        float values[4] = { 0 };
+        pf_attribute_decode_INTERNAL(attr, i, values);
+        pf_attribute_encode_INTERNAL(&result, i, values);
+    }
+
+    result.used = attr->used;
+
+    return result;
+}
+
 /* Attribute Element Functions */
 
 float
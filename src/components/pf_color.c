@@ -194,6 +194,40 @@ pf_color_scale_u8(
     return col;
 }
 
+pf_color_t
+pf_color_premultiply(
+    pf_color_t col)
+{
+    // NOTE: (x + 128 + ((x + 128) >> 8)) >> 8 is x / 255 rounded, for x <= 255 * 255
+    uint32_t a = col.c.a;
+    for (int_fast8_t i = 0; i < 3; ++i) {
+        uint32_t x = col.a[i] * a + 128;
+        col.a[i] = (uint8_t)((x + (x >> 8)) >> 8);
+    }
+    return col;
+}
+
+void
+pf_color_blend_premul_span(
+    pf_color_t* restrict dst,
+    const pf_color_t* restrict src,
+    size_t count)
+{
+    size_t i = 0;
+
+#if PF_SIMD_SIZE > 1
+    for (; i + PF_SIMD_SIZE <= count; i += PF_SIMD_SIZE) {
+        pf_simd_i_t d = pf_simd_load_i32(dst + i);
+        pf_simd_i_t s = pf_simd_load_i32(src + i);
+        pf_simd_store_i32(dst + i, pf_color_blend_premul_simd(d, s));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        dst[i] = pf_color_blend_premul(dst[i], src[i]);
+    }
+}
+
 void
 pf_color_from_hsv(
     pf_color_t* color,
@@ -218,6 +218,20 @@ pf_pixel_get_rgba16161616(
     return result;
 }
 
+pf_color_t
+pf_pixel_get_bgra8888(
+    const void* pixels,
+    size_t offset)
+{
+    pf_color_t result;
+    const uint8_t* pixel = (uint8_t*)pixels + offset*4;
+    result.c.r = pixel[2];
+    result.c.g = pixel[1];
+    result.c.b = pixel[0];
+    result.c.a = pixel[3];
+    return result;
+}
+
 /* Pixel Setters */
 
 void
@@ -417,6 +431,363 @@ pf_pixel_set_rgba16161616(
     pixel[3] = pf_float_to_half_INTERNAL(color.c.a * (1.0f/255));
 }
 
+void
+pf_pixel_set_bgra8888(
+    void* pixels,
+    size_t offset,
+    pf_color_t color)
+{
+    uint8_t* pixel = (uint8_t*)pixels + offset*4;
+    pixel[0] = color.c.b;
+    pixel[1] = color.c.g;
+    pixel[2] = color.c.r;
+    pixel[3] = color.c.a;
+}
+
+
+/* Internal Block Decoding Functions */
+
+static inline uint8_t
+pf_block_clamp_INTERNAL(int x)
+{
+    return (uint8_t)(x < 0 ? 0 : (x > 255 ? 255 : x));
+}
+
+static inline uint64_t
+pf_block_load_le64_INTERNAL(const uint8_t* p)
+{
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+static inline uint64_t
+pf_block_load_be64_INTERNAL(const uint8_t* p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v = (v << 8) | p[i];
+    return v;
+}
+
+static void
+pf_block_decode_bc1_color_INTERNAL(
+    const uint8_t* block,
+    pf_color_t* texels,
+    bool four_colors)
+{
+    uint16_t c0 = block[0] | (block[1] << 8);
+    uint16_t c1 = block[2] | (block[3] << 8);
+    uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+
+    pf_color_t palette[4];
+    for (int i = 0; i < 2; ++i) {
+        uint16_t c = i ? c1 : c0;
+        uint8_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+        palette[i].c.r = (r << 3) | (r >> 2);
+        palette[i].c.g = (g << 2) | (g >> 4);
+        palette[i].c.b = (b << 3) | (b >> 2);
+        palette[i].c.a = 255;
+    }
+
+    // NOTE: BC1 stores the transparent mode by ordering the endpoints, the color
+    //       block of BC3 always uses the four colors mode.
+
+    if (four_colors || c0 > c1) {
+        for (int i = 0; i < 3; ++i) {
+            palette[2].a[i] = (2 * palette[0].a[i] + palette[1].a[i] + 1) / 3;
+            palette[3].a[i] = (palette[0].a[i] + 2 * palette[1].a[i] + 1) / 3;
+        }
+        palette[2].c.a = palette[3].c.a = 255;
+    } else {
+        for (int i = 0; i < 3; ++i) {
+            palette[2].a[i] = (palette[0].a[i] + palette[1].a[i] + 1) / 2;
+        }
+        palette[2].c.a = 255;
+        palette[3].v = 0;
+    }
+
+    for (int i = 0; i < 16; ++i) {
+        texels[i] = palette[(indices >> (2 * i)) & 3];
+    }
+}
+
+static void
+pf_block_decode_bc4_channel_INTERNAL(
+    const uint8_t* block,
+    pf_color_t* texels,
+    int channel)
+{
+    int a0 = block[0], a1 = block[1];
+    uint64_t indices = pf_block_load_le64_INTERNAL(block) >> 16;
+
+    uint8_t palette[8];
+    palette[0] = a0;
+    palette[1] = a1;
+
+    if (a0 > a1) {
+        for (int i = 1; i < 7; ++i) {
+            palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+        }
+    } else {
+        for (int i = 1; i < 5; ++i) {
+            palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    for (int i = 0; i < 16; ++i) {
+        texels[i].a[channel] = palette[(indices >> (3 * i)) & 7];
+    }
+}
+
+static void
+pf_block_decode_etc2_color_INTERNAL(
+    const uint8_t* block,
+    pf_color_t* texels)
+{
+    static const int modifiers[8][2] = {
+        { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 },
+        { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+    };
+
+    static const int distances[8] = {
+        3, 6, 11, 16, 23, 32, 41, 64
+    };
+
+    const uint64_t b = pf_block_load_be64_INTERNAL(block);
+
+    // NOTE: The pixel indices are stored column by column, the most significant
+    //       bits of the 16 indices first, then their least significant bits.
+
+#   define PF_ETC2_INDEX(i) ((((b >> (16 + (i))) & 1) << 1) | ((b >> (i)) & 1))
+#   define PF_ETC2_TEXEL(i) texels[((i) & 3) * 4 + ((i) >> 2)]
+
+    int r[2], g[2], bl[2];
+
+    if (((b >> 33) & 1) == 0) {
+        /* Individual mode, two 4-bit colors */
+        r[0] = (b >> 60) & 0xF; r[1] = (b >> 56) & 0xF;
+        g[0] = (b >> 52) & 0xF; g[1] = (b >> 48) & 0xF;
+        bl[0] = (b >> 44) & 0xF; bl[1] = (b >> 40) & 0xF;
+        for (int j = 0; j < 2; ++j) {
+            r[j] *= 17, g[j] *= 17, bl[j] *= 17;
+        }
+    } else {
+        /* Differential mode, a 5-bit color and a signed 3-bit delta */
+        int r0 = (b >> 59) & 0x1F, dr = (int)((b >> 56) & 7);
+        int g0 = (b >> 51) & 0x1F, dg = (int)((b >> 48) & 7);
+        int b0 = (b >> 43) & 0x1F, db = (int)((b >> 40) & 7);
+        int r1 = r0 + (dr ^ 4) - 4;
+        int g1 = g0 + (dg ^ 4) - 4;
+        int b1 = b0 + (db ^ 4) - 4;
+
+        // NOTE: An out of range second color selects one of the ETC2 modes
+
+        if (r1 < 0 || r1 > 31) {
+            /* T mode, the paint colors are the first color and three around the second */
+            int c[2][3] = {
+                { ((b >> 57) & 0xC) | ((b >> 56) & 3), (b >> 52) & 0xF, (b >> 48) & 0xF },
+                { (b >> 44) & 0xF, (b >> 40) & 0xF, (b >> 36) & 0xF }
+            };
+            int d = distances[((b >> 33) & 6) | ((b >> 32) & 1)];
+            pf_color_t paint[4];
+            for (int k = 0; k < 3; ++k) {
+                int c0 = c[0][k] * 17, c1 = c[1][k] * 17;
+                paint[0].a[k] = c0;
+                paint[1].a[k] = pf_block_clamp_INTERNAL(c1 + d);
+                paint[2].a[k] = c1;
+                paint[3].a[k] = pf_block_clamp_INTERNAL(c1 - d);
+            }
+            paint[0].c.a = paint[1].c.a = paint[2].c.a = paint[3].c.a = 255;
+            for (int i = 0; i < 16; ++i) {
+                PF_ETC2_TEXEL(i) = paint[PF_ETC2_INDEX(i)];
+            }
+            return;
+        }
+
+        if (g1 < 0 || g1 > 31) {
+            /* H mode, the paint colors are two around each color */
+            int c[2][3] = {
+                { (b >> 59) & 0xF, ((b >> 55) & 0xE) | ((b >> 52) & 1),
+                  ((b >> 48) & 8) | ((b >> 47) & 7) },
+                { (b >> 43) & 0xF, (b >> 39) & 0xF, (b >> 35) & 0xF }
+            };
+            int v0 = (c[0][0] << 8) | (c[0][1] << 4) | c[0][2];
+            int v1 = (c[1][0] << 8) | (c[1][1] << 4) | c[1][2];
+            int d = distances[((b >> 32) & 4) | ((b >> 31) & 2) | (v0 >= v1)];
+            pf_color_t paint[4];
+            for (int k = 0; k < 3; ++k) {
+                int c0 = c[0][k] * 17, c1 = c[1][k] * 17;
+                paint[0].a[k] = pf_block_clamp_INTERNAL(c0 + d);
+                paint[1].a[k] = pf_block_clamp_INTERNAL(c0 - d);
+                paint[2].a[k] = pf_block_clamp_INTERNAL(c1 + d);
+                paint[3].a[k] = pf_block_clamp_INTERNAL(c1 - d);
+            }
+            paint[0].c.a = paint[1].c.a = paint[2].c.a = paint[3].c.a = 255;
+            for (int i = 0; i < 16; ++i) {
+                PF_ETC2_TEXEL(i) = paint[PF_ETC2_INDEX(i)];
+            }
+            return;
+        }
+
+        if (b1 < 0 || b1 > 31) {
+            /* Planar mode, the colors are interpolated from three 6:7:6 colors */
+            int o[3] = {
+                (b >> 57) & 0x3F,
+                (((b >> 56) & 1) << 6) | ((b >> 49) & 0x3F),
+                (((b >> 48) & 1) << 5) | (((b >> 43) & 3) << 3) | ((b >> 39) & 7)
+            };
+            int h[3] = {
+                (((b >> 34) & 0x1F) << 1) | ((b >> 32) & 1),
+                (b >> 25) & 0x7F,
+                (b >> 19) & 0x3F
+            };
+            int v[3] = {
+                (b >> 13) & 0x3F,
+                (b >> 6) & 0x7F,
+                b & 0x3F
+            };
+            for (int k = 0; k < 3; ++k) {
+                int bits = (k == 1) ? 7 : 6;
+                o[k] = (o[k] << (8 - bits)) | (o[k] >> (2 * bits - 8));
+                h[k] = (h[k] << (8 - bits)) | (h[k] >> (2 * bits - 8));
+                v[k] = (v[k] << (8 - bits)) | (v[k] >> (2 * bits - 8));
+            }
+            for (int y = 0; y < 4; ++y) {
+                for (int x = 0; x < 4; ++x) {
+                    pf_color_t* t = &texels[y * 4 + x];
+                    for (int k = 0; k < 3; ++k) {
+                        t->a[k] = pf_block_clamp_INTERNAL(
+                            (x * (h[k] - o[k]) + y * (v[k] - o[k]) + 4 * o[k] + 2) >> 2);
+                    }
+                    t->c.a = 255;
+                }
+            }
+            return;
+        }
+
+        r[0] = (r0 << 3) | (r0 >> 2); r[1] = (r1 << 3) | (r1 >> 2);
+        g[0] = (g0 << 3) | (g0 >> 2); g[1] = (g1 << 3) | (g1 >> 2);
+        bl[0] = (b0 << 3) | (b0 >> 2); bl[1] = (b1 << 3) | (b1 >> 2);
+    }
+
+    /* Individual and differential modes, two sub-blocks side by side or stacked ('flip') */
+
+    const int table[2] = { (b >> 37) & 7, (b >> 34) & 7 };
+    const bool flip = (b >> 32) & 1;
+
+    for (int i = 0; i < 16; ++i) {
+        int x = i >> 2, y = i & 3;
+        int s = flip ? (y >= 2) : (x >= 2);
+        int index = PF_ETC2_INDEX(i);
+        int m = modifiers[table[s]][index & 1];
+        if (index & 2) m = -m;
+        pf_color_t* t = &PF_ETC2_TEXEL(i);
+        t->c.r = pf_block_clamp_INTERNAL(r[s] + m);
+        t->c.g = pf_block_clamp_INTERNAL(g[s] + m);
+        t->c.b = pf_block_clamp_INTERNAL(bl[s] + m);
+        t->c.a = 255;
+    }
+
+#   undef PF_ETC2_INDEX
+#   undef PF_ETC2_TEXEL
+}
+
+static void
+pf_block_decode_eac_alpha_INTERNAL(
+    const uint8_t* block,
+    pf_color_t* texels)
+{
+    static const int modifiers[16][8] = {
+        { -3, -6,  -9, -15, 2, 5, 8, 14 },
+        { -3, -7, -10, -13, 2, 6, 9, 12 },
+        { -2, -5,  -8, -13, 1, 4, 7, 12 },
+        { -2, -4,  -6, -13, 1, 3, 5, 12 },
+        { -3, -6,  -8, -12, 2, 5, 7, 11 },
+        { -3, -7,  -9, -11, 2, 6, 8, 10 },
+        { -4, -7,  -8, -11, 3, 6, 7, 10 },
+        { -3, -5,  -8, -11, 2, 4, 7, 10 },
+        { -2, -6,  -8, -10, 1, 5, 7,  9 },
+        { -2, -5,  -8, -10, 1, 4, 7,  9 },
+        { -2, -4,  -8, -10, 1, 3, 7,  9 },
+        { -2, -5,  -7, -10, 1, 4, 6,  9 },
+        { -3, -4,  -7, -10, 2, 3, 6,  9 },
+        { -1, -2,  -3, -10, 0, 1, 2,  9 },
+        { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+        { -3, -5,  -7,  -9, 2, 4, 6,  8 }
+    };
+
+    const uint64_t b = pf_block_load_be64_INTERNAL(block);
+    const int base = block[0];
+    const int multiplier = block[1] >> 4;
+    const int* table = modifiers[block[1] & 0xF];
+
+    for (int i = 0; i < 16; ++i) {
+        int index = (b >> (45 - 3 * i)) & 7;
+        texels[(i & 3) * 4 + (i >> 2)].c.a = pf_block_clamp_INTERNAL(base + table[index] * multiplier);
+    }
+}
+
+/* Block Decoders */
+
+void
+pf_pixel_decode_bc1(
+    const void* block,
+    pf_color_t* texels)
+{
+    pf_block_decode_bc1_color_INTERNAL(block, texels, false);
+}
+
+void
+pf_pixel_decode_bc3(
+    const void* block,
+    pf_color_t* texels)
+{
+    pf_block_decode_bc1_color_INTERNAL((const uint8_t*)block + 8, texels, true);
+    pf_block_decode_bc4_channel_INTERNAL(block, texels, 3);
+}
+
+void
+pf_pixel_decode_bc4(
+    const void* block,
+    pf_color_t* texels)
+{
+    for (int i = 0; i < 16; ++i) {
+        texels[i] = (pf_color_t) { .c = { 0, 0, 0, 255 } };
+    }
+    pf_block_decode_bc4_channel_INTERNAL(block, texels, 0);
+}
+
+void
+pf_pixel_decode_bc5(
+    const void* block,
+    pf_color_t* texels)
+{
+    for (int i = 0; i < 16; ++i) {
+        texels[i] = (pf_color_t) { .c = { 0, 0, 0, 255 } };
+    }
+    pf_block_decode_bc4_channel_INTERNAL(block, texels, 0);
+    pf_block_decode_bc4_channel_INTERNAL((const uint8_t*)block + 8, texels, 1);
+}
+
+void
+pf_pixel_decode_etc2_rgb8(
+    const void* block,
+    pf_color_t* texels)
+{
+    pf_block_decode_etc2_color_INTERNAL(block, texels);
+}
+
+void
+pf_pixel_decode_etc2_rgba8(
+    const void* block,
+    pf_color_t* texels)
+{
+    pf_block_decode_etc2_color_INTERNAL((const uint8_t*)block + 8, texels);
+    pf_block_decode_eac_alpha_INTERNAL(block, texels);
+}
+
 
 /* Helper Functions */
 
@@ -493,6 +864,11 @@ pf_pixel_default_getter_setter(
             if (setter) *setter = pf_pixel_set_rgba16161616;
             break;
 
+        case PF_PIXELFORMAT_BGRA8888:
+            if (getter) *getter = pf_pixel_get_bgra8888;
+            if (setter) *setter = pf_pixel_set_bgra8888;
+            break;
+
         default:
             if (getter) *getter = NULL;
             if (setter) *setter = NULL;
@@ -519,6 +895,7 @@ pf_pixel_get_bytes(
         case PF_PIXELFORMAT_R16:            return 2;
         case PF_PIXELFORMAT_RGB161616:      return 2*3;
         case PF_PIXELFORMAT_RGBA16161616:   return 2*4;
+        case PF_PIXELFORMAT_BGRA8888:       return 4;
 
         default:
             break;
@@ -526,3 +903,62 @@ pf_pixel_get_bytes(
 
     return 0;
 }
+
+pf_pixel_block_decoder_fn
+pf_pixel_default_block_decoder(
+    pf_pixelformat_e format)
+{
+    switch (format)
+    {
+        case PF_PIXELFORMAT_BC1:            return pf_pixel_decode_bc1;
+        case PF_PIXELFORMAT_BC3:            return pf_pixel_decode_bc3;
+        case PF_PIXELFORMAT_BC4:            return pf_pixel_decode_bc4;
+        case PF_PIXELFORMAT_BC5:            return pf_pixel_decode_bc5;
+        case PF_PIXELFORMAT_ETC2_RGB8:      return pf_pixel_decode_etc2_rgb8;
+        case PF_PIXELFORMAT_ETC2_RGBA8:     return pf_pixel_decode_etc2_rgba8;
+
+        default:
+            break;
+    }
+
+    return NULL;
+}
+
+bool
+pf_pixel_is_compressed(
+    pf_pixelformat_e format)
+{
+    return format >= PF_PIXELFORMAT_BC1;
+}
+
+size_t
+pf_pixel_get_block_bytes(
+    pf_pixelformat_e format)
+{
+    switch (format)
+    {
+        case PF_PIXELFORMAT_BC1:
+        case PF_PIXELFORMAT_BC4:
+        case PF_PIXELFORMAT_ETC2_RGB8:      return 8;
+        case PF_PIXELFORMAT_BC3:
+        case PF_PIXELFORMAT_BC5:
+        case PF_PIXELFORMAT_ETC2_RGBA8:     return 16;
+
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+size_t
+pf_pixel_get_image_bytes(
+    pf_pixelformat_e format,
+    uint32_t w, uint32_t h)
+{
+    if (pf_pixel_is_compressed(format)) {
+        return (size_t)((w + 3) / 4) * ((h + 3) / 4) * pf_pixel_get_block_bytes(format);
+    }
+
+    return (size_t)w * h * pf_pixel_get_bytes(format);
+}
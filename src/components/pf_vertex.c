@@ -110,6 +110,8 @@ pf_vertex_scale_vec(
     switch (elem->type) {
         PF_VERTEX_SCALE_VEC_CASE(PF_ATTRIB_FLOAT, float)
         PF_VERTEX_SCALE_VEC_CASE(PF_ATTRIB_UBYTE, uint8_t)
+        default:
+            break;
     }
 }
 
@@ -208,6 +210,9 @@ pf_vertex_lerp(
                 default:
                     break;
             }
+        } else {
+            // NOTE: Reading an unused element (e.g. a missing color) then gives nothing
+            er->comp = 0;
         }
     }
 }
@@ -263,6 +268,8 @@ pf_vertex_bary(
                 default:
                     break;
             }
+        } else {
+            er->comp = 0;
         }
     }
 }
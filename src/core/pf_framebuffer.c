@@ -18,47 +18,605 @@
  */
 
 #include "pixelfactory/core/pf_framebuffer.h"
+#include <string.h>
 #include <stdio.h>
 
-pf_framebuffer_t
-pf_framebuffer_create(
-    uint32_t w, uint32_t h,
-    pf_color_t def)
+#ifdef _OPENMP
+#   include <omp.h>
+#endif //_OPENMP
+
+/* Internal Functions */
+
+static void
+pf_framebuffer_fill_span_INTERNAL(
+    pf_framebuffer_t* fb,
+    size_t offset,
+    size_t count,
+    pf_color_t color)
 {
-    pf_framebuffer_t result = { 0 };
-    if (w == 0 || h == 0) return result;
+    if (fb->format == PF_PIXELFORMAT_GRAY) {
+        memset((uint8_t*)fb->buffer + offset, pf_framebuffer_pack_gray(color), count);
+        return;
+    }
 
-    size_t size = w * h;
+    if (fb->format == PF_PIXELFORMAT_RGB565) {
+        uint16_t* ptr = (uint16_t*)fb->buffer + offset;
+        uint16_t pixel = pf_framebuffer_pack_rgb565(color);
+        for (size_t i = 0; i < count; ++i) {
+            ptr[i] = pixel;
+        }
+        return;
+    }
 
-    pf_color_t* buffer = PF_MALLOC(size * sizeof(pf_color_t));
-    if (buffer == NULL) return result;
+    uint32_t* ptr = (uint32_t*)fb->buffer + offset;
+    uint32_t pixel = (fb->format == PF_PIXELFORMAT_BGRA8888)
+        ? pf_framebuffer_swap_rb(color.v) : color.v;
 
+    size_t i = 0;
 #if PF_SIMD_SIZE > 1
-    pf_simd_i_t v_def = pf_simd_set1_i32(def.v);
+    pf_simd_i_t v_pixel = pf_simd_set1_i32((int32_t)pixel);
+    for (; i + PF_SIMD_SIZE - 1 < count; i += PF_SIMD_SIZE) {
+        pf_simd_store_i32(ptr + i, v_pixel);
+    }
+#endif
+    for (; i < count; ++i) {
+        ptr[i] = pixel;
+    }
+}
+
+static pf_framebuffer_present_format_e
+pf_framebuffer_get_present_format_INTERNAL(
+    pf_pixelformat_e format)
+{
+    switch (format) {
+        case PF_PIXELFORMAT_BGRA8888:
+            return PF_PRESENT_FORMAT_BGRA8888;
+        case PF_PIXELFORMAT_RGB565:
+            return PF_PRESENT_FORMAT_RGB565;
+        case PF_PIXELFORMAT_GRAY:
+            return PF_PRESENT_FORMAT_GRAY;
+        default:
+            return PF_PRESENT_FORMAT_RGBA8888;
+    }
+}
+
+// NOTE: Exchanges the red and blue channels, 'or_mask' being applied to the result
+static void
+pf_framebuffer_swap_rb_span_INTERNAL(
+    uint32_t* restrict dst,
+    const uint32_t* restrict src,
+    size_t count,
+    uint32_t or_mask)
+{
     size_t i = 0;
-    for (; i + PF_SIMD_SIZE - 1 < size; i += PF_SIMD_SIZE) {
-        pf_simd_store_i32((pf_simd_i_t*)(buffer + i), v_def);
+
+#if PF_SIMD_SIZE > 1
+    const pf_simd_i_t ag_mask = pf_simd_set1_i32((int32_t)0xFF00FF00);
+    const pf_simd_i_t b_mask = pf_simd_set1_i32(0xFF);
+    const pf_simd_i_t v_or = pf_simd_set1_i32((int32_t)or_mask);
+    for (; i + PF_SIMD_SIZE - 1 < count; i += PF_SIMD_SIZE) {
+        pf_simd_i_t c = pf_simd_load_i32(src + i);
+        pf_simd_i_t r = pf_simd_slli_i32(pf_simd_and_i32(c, b_mask), 16);
+        pf_simd_i_t b = pf_simd_and_i32(pf_simd_srli_i32(c, 16), b_mask);
+        c = pf_simd_or_i32(pf_simd_and_i32(c, ag_mask), pf_simd_or_i32(r, b));
+        pf_simd_store_i32(dst + i, pf_simd_or_i32(c, v_or));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        dst[i] = pf_framebuffer_swap_rb(src[i]) | or_mask;
+    }
+}
+
+static void
+pf_framebuffer_pack_span_INTERNAL(
+    void* restrict dst,
+    pf_framebuffer_present_format_e format,
+    const pf_color_t* restrict colors,
+    size_t count)
+{
+    size_t i = 0;
+
+    switch (format) {
+        case PF_PRESENT_FORMAT_BGRA8888:
+            pf_framebuffer_swap_rb_span_INTERNAL(dst, (const uint32_t*)colors, count, 0);
+            break;
+
+        case PF_PRESENT_FORMAT_XRGB8888:
+            pf_framebuffer_swap_rb_span_INTERNAL(dst, (const uint32_t*)colors, count, 0xFF000000);
+            break;
+
+        case PF_PRESENT_FORMAT_RGB888: {
+            // NOTE: Four pixels are packed at once in three words, as on little-endian hosts
+            uint8_t* ptr = (uint8_t*)dst;
+            for (; i + 3 < count; i += 4) {
+                uint32_t p0 = colors[i].v, p1 = colors[i + 1].v;
+                uint32_t p2 = colors[i + 2].v, p3 = colors[i + 3].v;
+                uint32_t w0 = (p0 & 0xFFFFFF) | (p1 << 24);
+                uint32_t w1 = ((p1 >> 8) & 0xFFFF) | (p2 << 16);
+                uint32_t w2 = ((p2 >> 16) & 0xFF) | (p3 << 8);
+                memcpy(ptr + 3 * i + 0, &w0, 4);
+                memcpy(ptr + 3 * i + 4, &w1, 4);
+                memcpy(ptr + 3 * i + 8, &w2, 4);
+            }
+            for (; i < count; ++i) {
+                ptr[3 * i + 0] = colors[i].c.r;
+                ptr[3 * i + 1] = colors[i].c.g;
+                ptr[3 * i + 2] = colors[i].c.b;
+            }
+        } break;
+
+        case PF_PRESENT_FORMAT_RGB565: {
+            uint16_t* ptr = (uint16_t*)dst;
+#if PF_SIMD_SIZE > 1
+            // NOTE: The channels are converted in 32 bits lanes, then narrowed one by one
+            const pf_simd_i_t mask = pf_simd_set1_i32(0xFF);
+            const pf_simd_i_t m5 = pf_simd_set1_i32(249), a5 = pf_simd_set1_i32(1014);
+            const pf_simd_i_t m6 = pf_simd_set1_i32(253), a6 = pf_simd_set1_i32(505);
+            uint32_t packed[PF_SIMD_SIZE];
+            for (; i + PF_SIMD_SIZE - 1 < count; i += PF_SIMD_SIZE) {
+                pf_simd_i_t c = pf_simd_load_i32(colors + i);
+                pf_simd_i_t r = pf_simd_and_i32(c, mask);
+                pf_simd_i_t g = pf_simd_and_i32(pf_simd_srli_i32(c, 8), mask);
+                pf_simd_i_t b = pf_simd_and_i32(pf_simd_srli_i32(c, 16), mask);
+                r = pf_simd_srli_i32(pf_simd_add_i32(pf_simd_mullo_i32(r, m5), a5), 11);
+                g = pf_simd_srli_i32(pf_simd_add_i32(pf_simd_mullo_i32(g, m6), a6), 10);
+                b = pf_simd_srli_i32(pf_simd_add_i32(pf_simd_mullo_i32(b, m5), a5), 11);
+                pf_simd_store_i32(packed, pf_simd_or_i32(pf_simd_slli_i32(r, 11),
+                    pf_simd_or_i32(pf_simd_slli_i32(g, 5), b)));
+                for (int j = 0; j < PF_SIMD_SIZE; ++j) {
+                    ptr[i + j] = (uint16_t)packed[j];
+                }
+            }
+#endif
+            for (; i < count; ++i) {
+                ptr[i] = pf_framebuffer_pack_rgb565(colors[i]);
+            }
+        } break;
+
+        case PF_PRESENT_FORMAT_GRAY: {
+            uint8_t* ptr = (uint8_t*)dst;
+            for (; i < count; ++i) {
+                ptr[i] = pf_framebuffer_pack_gray(colors[i]);
+            }
+        } break;
+
+        default:
+            memcpy(dst, colors, count * sizeof(pf_color_t));
+            break;
+    }
+}
+
+// NOTE: Returns 'count' pixels of the framebuffer from 'offset' in RGBA8888, pointing
+//       directly into the buffer when it is already in this format
+static const pf_color_t*
+pf_framebuffer_unpack_span_INTERNAL(
+    const pf_framebuffer_t* restrict fb,
+    size_t offset,
+    pf_color_t* restrict colors,
+    size_t count)
+{
+    switch (fb->format) {
+        case PF_PIXELFORMAT_BGRA8888:
+            pf_framebuffer_swap_rb_span_INTERNAL((uint32_t*)colors,
+                (const uint32_t*)fb->buffer + offset, count, 0);
+            return colors;
+
+        case PF_PIXELFORMAT_RGB565:
+        case PF_PIXELFORMAT_GRAY:
+            for (size_t i = 0; i < count; ++i) {
+                colors[i] = pf_framebuffer_load(fb, offset + i);
+            }
+            return colors;
+
+        default:
+            return (const pf_color_t*)fb->buffer + offset;
+    }
+}
+
+/* Internal Present Functions */
+
+/*
+    The destination is produced row by row in RGBA8888 then packed to its format.
+    The sources of the destination columns, and their weights for the bilinear
+    scaling, are computed once in 8-bit fixed point, sampling at pixel centers.
+    A row sampling the same source rows with the same weight as the previous one
+    is copied from it, which makes the upscaling mostly a matter of 'memcpy'.
+*/
+
+typedef struct {
+    const pf_framebuffer_t* src;
+    uint32_t sx, sy, sw, sh;            //< Source rectangle
+    uint32_t dw, dh;                    //< Scaled size
+    const uint32_t* x0;                 //< Source column of each destination column
+    const uint32_t* x1;                 //< Next source column, for the bilinear scaling
+    const uint32_t* fx;                 //< Weight of 'x1' in both 16-bit halves
+    bool bilinear;
+} pf_framebuffer_present_INTERNAL_t;
+
+// NOTE: Position of the center of the destination pixel 'i' in the source, in 8-bit fixed point
+static inline int64_t
+pf_framebuffer_present_pos_INTERNAL(uint32_t i, uint32_t src_size, uint32_t dst_size)
+{
+    return ((int64_t)(2 * i + 1) * src_size * 256) / (2 * (int64_t)dst_size) - 128;
+}
+
+static inline void
+pf_framebuffer_present_map_INTERNAL(
+    uint32_t i, uint32_t src_size, uint32_t dst_size, bool bilinear,
+    uint32_t* i0, uint32_t* i1, uint32_t* f)
+{
+    if (!bilinear) {
+        *i0 = *i1 = (uint32_t)(((uint64_t)(2 * i + 1) * src_size) / (2 * (uint64_t)dst_size));
+        *f = 0;
+        return;
+    }
+
+    int64_t pos = pf_framebuffer_present_pos_INTERNAL(i, src_size, dst_size);
+    if (pos < 0) pos = 0;
+
+    *i0 = (uint32_t)(pos >> 8);
+    *f = (uint32_t)(pos & 0xFF);
+
+    if (*i0 >= src_size - 1) {
+        *i0 = src_size - 1;
+        *f = 0;
+    }
+
+    *i1 = (*f > 0) ? *i0 + 1 : *i0;
+}
+
+static void
+pf_framebuffer_present_row_INTERNAL(
+    const pf_framebuffer_present_INTERNAL_t* p,
+    pf_color_t* restrict dst,
+    pf_color_t* restrict scratch,
+    uint32_t y)
+{
+    const pf_color_t* row = pf_framebuffer_unpack_span_INTERNAL(p->src,
+        (size_t)(p->sy + y) * p->src->w + p->sx, scratch, p->sw);
+
+    if (!p->bilinear) {
+        for (uint32_t x = 0; x < p->dw; ++x) {
+            dst[x] = row[p->x0[x]];
+        }
+        return;
+    }
+
+    // NOTE: The lerps are rounded to the nearest, like those of the vertical pass
+    const uint32_t mask = 0x00FF00FF;
+    const uint32_t round = 0x00800080;
+
+    for (uint32_t x = 0; x < p->dw; ++x) {
+        uint32_t c0 = row[p->x0[x]].v, c1 = row[p->x1[x]].v;
+        uint32_t f = p->fx[x] & 0xFFFF, inv = 256 - f;
+        uint32_t rb = (((c0 & mask) * inv + (c1 & mask) * f + round) >> 8) & mask;
+        uint32_t ga = ((((c0 >> 8) & mask) * inv + ((c1 >> 8) & mask) * f + round) >> 8) & mask;
+        dst[x].v = rb | (ga << 8);
+    }
+}
+
+static void
+pf_framebuffer_present_lerp_INTERNAL(
+    pf_color_t* restrict dst,
+    const pf_color_t* restrict a,
+    const pf_color_t* restrict b,
+    uint32_t f,
+    size_t count)
+{
+    size_t i = 0;
+
+#if PF_SIMD_SIZE > 1
+    const pf_simd_i_t mask = pf_simd_set1_i32(0x00FF00FF);
+    const pf_simd_i_t round = pf_simd_set1_i32(0x00800080);
+    const pf_simd_i_t fb = pf_simd_set1_i32((int32_t)(f | (f << 16)));
+    const pf_simd_i_t fa = pf_simd_set1_i32((int32_t)((256 - f) | ((256 - f) << 16)));
+
+#   define PF_LERP_I16(x, y) \
+        pf_simd_srli_i16(pf_simd_add_i16(pf_simd_add_i16(pf_simd_mullo_i16(x, fa), \
+            pf_simd_mullo_i16(y, fb)), round), 8)
+
+    for (; i + PF_SIMD_SIZE - 1 < count; i += PF_SIMD_SIZE) {
+        pf_simd_i_t ca = pf_simd_load_i32(a + i);
+        pf_simd_i_t cb = pf_simd_load_i32(b + i);
+        pf_simd_i_t rb = PF_LERP_I16(pf_simd_and_i32(ca, mask), pf_simd_and_i32(cb, mask));
+        pf_simd_i_t ga = PF_LERP_I16(pf_simd_and_i32(pf_simd_srli_i32(ca, 8), mask),
+                                     pf_simd_and_i32(pf_simd_srli_i32(cb, 8), mask));
+        pf_simd_store_i32(dst + i, pf_simd_or_i32(rb, pf_simd_slli_i32(ga, 8)));
+    }
+
+#   undef PF_LERP_I16
+#endif
+
+    const uint32_t mask32 = 0x00FF00FF;
+    const uint32_t round32 = 0x00800080;
+    const uint32_t inv = 256 - f;
+
+    for (; i < count; ++i) {
+        uint32_t c0 = a[i].v, c1 = b[i].v;
+        uint32_t rb = (((c0 & mask32) * inv + (c1 & mask32) * f + round32) >> 8) & mask32;
+        uint32_t ga = ((((c0 >> 8) & mask32) * inv + ((c1 >> 8) & mask32) * f + round32) >> 8) & mask32;
+        dst[i].v = rb | (ga << 8);
     }
-    for (; i < size; ++i) {
-        buffer[i] = def;
+}
+
+static void
+pf_framebuffer_present_band_INTERNAL(
+    const pf_framebuffer_present_INTERNAL_t* p,
+    uint8_t* restrict dst, size_t pitch,
+    pf_framebuffer_present_format_e format,
+    pf_color_t* restrict scratch,
+    uint32_t y_begin, uint32_t y_end)
+{
+    const size_t row_size = p->dw * pf_framebuffer_present_get_bytes(format);
+    const bool same_format = (format == pf_framebuffer_get_present_format_INTERNAL(p->src->format));
+
+    // NOTE: 'rows' holds the two scaled source rows, tagged by their index in 'cached'
+    pf_color_t* src_row = scratch;
+    pf_color_t* rows[2] = { src_row + p->sw, src_row + p->sw + p->dw };
+    pf_color_t* out = rows[1] + p->dw;
+    int64_t cached[2] = { -1, -1 };
+
+    uint32_t prev_y0 = 0, prev_f = 0;
+
+    for (uint32_t y = y_begin; y < y_end; ++y) {
+        uint8_t* dst_row = dst + (size_t)y * pitch;
+        uint32_t y0, y1, fy;
+
+        pf_framebuffer_present_map_INTERNAL(y, p->sh, p->dh, p->bilinear, &y0, &y1, &fy);
+
+        if (y > y_begin && y0 == prev_y0 && fy == prev_f) {
+            memcpy(dst_row, dst_row - pitch, row_size);
+            continue;
+        }
+
+        prev_y0 = y0, prev_f = fy;
+
+        // NOTE: Unscaled rows in the framebuffer format are copied as they are
+        if (same_format && p->dw == p->sw && !p->bilinear) {
+            size_t bpp = pf_framebuffer_present_get_bytes(format);
+            memcpy(dst_row, (const uint8_t*)p->src->buffer
+                + ((size_t)(p->sy + y0) * p->src->w + p->sx) * bpp, row_size);
+            continue;
+        }
+
+        if (p->dw == p->sw && !p->bilinear) {
+            const pf_color_t* row = pf_framebuffer_unpack_span_INTERNAL(p->src,
+                (size_t)(p->sy + y0) * p->src->w + p->sx, src_row, p->sw);
+            pf_framebuffer_pack_span_INTERNAL(dst_row, format, row, p->dw);
+            continue;
+        }
+
+        // NOTE: The scaled rows are kept while the next destination rows still sample them
+        const pf_color_t* r0 = NULL;
+        const pf_color_t* r1 = NULL;
+
+        for (int k = 0; k < 2; ++k) {
+            uint32_t sy = (k == 0) ? y0 : y1;
+            if (k == 1 && fy == 0) break;
+
+            int slot = (cached[0] == sy) ? 0 : (cached[1] == sy) ? 1 : -1;
+            if (slot < 0) {
+                // Reuse the slot not holding the other row
+                slot = (k == 0) ? (fy > 0 && cached[0] == y1) : (r0 == rows[0]);
+                pf_framebuffer_present_row_INTERNAL(p, rows[slot], src_row, sy);
+                cached[slot] = sy;
+            }
+
+            if (k == 0) r0 = rows[slot];
+            else r1 = rows[slot];
+        }
+
+        if (fy == 0) {
+            pf_framebuffer_pack_span_INTERNAL(dst_row, format, r0, p->dw);
+        } else {
+            pf_framebuffer_present_lerp_INTERNAL(out, r0, r1, fy, p->dw);
+            pf_framebuffer_pack_span_INTERNAL(dst_row, format, out, p->dw);
+        }
     }
+}
+
+static void
+pf_framebuffer_present_INTERNAL(
+    uint8_t* restrict dst,
+    uint32_t dst_w, uint32_t dst_h,
+    size_t pitch,
+    pf_framebuffer_present_format_e format,
+    const pf_framebuffer_t* restrict src_fb,
+    const uint32_t src[4],
+    bool bilinear)
+{
+    pf_framebuffer_present_INTERNAL_t p = { 0 };
+
+    p.src = src_fb;
+    p.sx = src[0], p.sy = src[1];
+    p.sw = src[2] - src[0] + 1;
+    p.sh = src[3] - src[1] + 1;
+    p.dw = dst_w, p.dh = dst_h;
+    p.bilinear = bilinear && (p.sw != dst_w || p.sh != dst_h);
+
+    const bool parallel = ((size_t)dst_w * dst_h >= PF_OMP_BUFFER_COPY_SIZE_THRESHOLD);
+
+#ifdef _OPENMP
+    const int num_bands = parallel ? PF_MIN(omp_get_max_threads(), (int)dst_h) : 1;
 #else
+    const int num_bands = 1;
+    (void)parallel;
+#endif
+
+    // NOTE: Each band needs a source row and three scaled rows
+    const size_t band_size = p.sw + 3 * (size_t)dst_w;
+
+    uint32_t* tables = PF_MALLOC(3 * dst_w * sizeof(uint32_t));
+    pf_color_t* scratch = PF_MALLOC(num_bands * band_size * sizeof(pf_color_t));
+
+    if (tables == NULL || scratch == NULL) {
+        fprintf(stderr, "ERROR: Failed to allocate the buffers of the framebuffer present\n");
+        PF_FREE(tables);
+        PF_FREE(scratch);
+        return;
+    }
+
+    uint32_t* x0 = tables;
+    uint32_t* x1 = x0 + dst_w;
+    uint32_t* fx = x1 + dst_w;
+
+    for (uint32_t x = 0; x < dst_w; ++x) {
+        pf_framebuffer_present_map_INTERNAL(x, p.sw, dst_w, p.bilinear, &x0[x], &x1[x], &fx[x]);
+        fx[x] |= fx[x] << 16;
+    }
+
+    p.x0 = x0, p.x1 = x1, p.fx = fx;
+
 #ifdef _OPENMP
-#   pragma omp parallel for \
-        if (size >= PF_OMP_CLEAR_BUFFER_SIZE_THRESHOLD)
+#   pragma omp parallel for schedule(static) \
+        if (num_bands > 1)
 #endif //_OPENMP
-    for (size_t i = 0; i < size; ++i) {
-        buffer[i] = def;
+    for (int band = 0; band < num_bands; ++band) {
+        uint32_t y_begin = (uint32_t)(((uint64_t)dst_h * band) / num_bands);
+        uint32_t y_end = (uint32_t)(((uint64_t)dst_h * (band + 1)) / num_bands);
+        pf_framebuffer_present_band_INTERNAL(&p, dst, pitch, format,
+            scratch + band * band_size, y_begin, y_end);
     }
-#endif
+
+    PF_FREE(tables);
+    PF_FREE(scratch);
+}
+
+/* Internal Damage Functions */
+
+static inline bool
+pf_framebuffer_damage_test_INTERNAL(
+    const pf_framebuffer_damage_t* damage,
+    bool include_cleared,
+    size_t word, uint32_t bit)
+{
+    uint32_t bits = damage->drawn[word];
+    if (include_cleared) bits |= damage->cleared[word];
+    return (bits >> bit) & 1;
+}
+
+// NOTE: Finds the first run of damaged tiles of the row 'ty' starting from '*tx'
+static bool
+pf_framebuffer_damage_row_next_INTERNAL(
+    const pf_framebuffer_damage_t* damage,
+    bool include_cleared,
+    uint32_t ty,
+    uint32_t* tx, uint32_t* tx_end)
+{
+    const size_t row = (size_t)ty * damage->pitch;
+    uint32_t x = *tx;
+
+    while (x < damage->tiles_x) {
+        size_t word = row + x / 32;
+        uint32_t bits = damage->drawn[word];
+        if (include_cleared) bits |= damage->cleared[word];
+        bits >>= x % 32;
+
+        if (bits == 0) {
+            x = (x / 32 + 1) * 32;
+            continue;
+        }
+
+        while ((bits & 1) == 0) {
+            bits >>= 1, ++x;
+        }
+        break;
+    }
+
+    if (x >= damage->tiles_x) {
+        return false;
+    }
+
+    uint32_t end = x;
+    while (end + 1 < damage->tiles_x && pf_framebuffer_damage_test_INTERNAL(
+        damage, include_cleared, row + (end + 1) / 32, (end + 1) % 32)) {
+        ++end;
+    }
+
+    *tx = x, *tx_end = end;
+    return true;
+}
+
+// NOTE: Converts the inclusive rectangle of the framebuffer to the same place of 'dst'
+static void
+pf_framebuffer_convert_rect_INTERNAL(
+    uint8_t* restrict dst,
+    size_t pitch,
+    pf_framebuffer_present_format_e format,
+    const pf_framebuffer_t* restrict src_fb,
+    const uint32_t rect[4])
+{
+    const size_t bpp = pf_framebuffer_present_get_bytes(format);
+    const size_t count = rect[2] - rect[0] + 1;
+    const bool same_format = (format == pf_framebuffer_get_present_format_INTERNAL(src_fb->format));
+
+    pf_color_t span[64];
+
+    for (uint32_t y = rect[1]; y <= rect[3]; ++y) {
+        uint8_t* dst_row = dst + y * pitch + rect[0] * bpp;
+        size_t offset = (size_t)y * src_fb->w + rect[0];
+
+        if (same_format) {
+            memcpy(dst_row, (const uint8_t*)src_fb->buffer + offset * bpp, count * bpp);
+            continue;
+        }
+
+        for (size_t i = 0; i < count; i += 64) {
+            size_t n = PF_MIN(count - i, 64);
+            const pf_color_t* colors = pf_framebuffer_unpack_span_INTERNAL(src_fb, offset + i, span, n);
+            pf_framebuffer_pack_span_INTERNAL(dst_row + i * bpp, format, colors, n);
+        }
+    }
+}
+
+/* Public API */
+
+pf_framebuffer_t
+pf_framebuffer_create(
+    uint32_t w, uint32_t h,
+    pf_color_t def)
+{
+    return pf_framebuffer_create_ex(w, h, def, PF_PIXELFORMAT_RGBA8888);
+}
+
+pf_framebuffer_t
+pf_framebuffer_create_ex(
+    uint32_t w, uint32_t h,
+    pf_color_t def,
+    pf_pixelformat_e format)
+{
+    pf_framebuffer_t result = { 0 };
+    if (w == 0 || h == 0) return result;
+
+    if (!pf_framebuffer_is_format_supported(format)) {
+        fprintf(stderr, "ERROR: Unsupported framebuffer format (%i)\n", format);
+        return result;
+    }
+
+    void* buffer = PF_MALLOC((size_t)w * h * pf_pixel_get_bytes(format));
+    if (buffer == NULL) return result;
 
     result.buffer = buffer;
     result.w = w;
     result.h = h;
+    result.format = format;
+
+    pf_framebuffer_fill(&result, NULL, def);
 
     return result;
 }
 
+bool
+pf_framebuffer_is_format_supported(
+    pf_pixelformat_e format)
+{
+    return format == PF_PIXELFORMAT_RGBA8888
+        || format == PF_PIXELFORMAT_BGRA8888
+        || format == PF_PIXELFORMAT_RGB565
+        || format == PF_PIXELFORMAT_GRAY;
+}
+
 void
 pf_framebuffer_delete(
     pf_framebuffer_t* fb)
@@ -118,26 +676,17 @@ pf_framebuffer_copy(
         if (src_ymin > src_ymax) PF_SWAP(src_ymin, src_ymax);
     }
 
-    float inv_dst_w = 1.0f / (float)dst_fb->w;
-    float inv_dst_h = 1.0f / (float)dst_fb->h;
+    const pf_framebuffer_present_format_e format = pf_framebuffer_get_present_format_INTERNAL(dst_fb->format);
+    const size_t bpp = pf_framebuffer_present_get_bytes(format);
+    const size_t pitch = dst_fb->w * bpp;
 
-#ifdef _OPENMP
-#   pragma omp parallel for\
-        if ((dst_xmax - dst_xmin) * (dst_ymax - dst_ymin) >= PF_OMP_BUFFER_COPY_SIZE_THRESHOLD)
-#endif //_OPENMP
-    for (int y = dst_ymin; y <= dst_ymax; ++y)
-    {
-        size_t y_dst_offset = y * dst_fb->w;
-        size_t y_src_offset = y * inv_dst_h * (src_ymax - src_ymin) + src_ymin;
+    const uint32_t src[4] = {
+        (uint32_t)src_xmin, (uint32_t)src_ymin,
+        (uint32_t)src_xmax, (uint32_t)src_ymax
+    };
 
-        for (int x = dst_xmin; x <= dst_xmax; ++x)
-        {
-            size_t dst_offset = y_dst_offset + x;
-            size_t src_offset = y_src_offset + x * inv_dst_w * (src_xmax - src_xmin) + src_xmin;
-
-            dst_fb->buffer[dst_offset] = src_fb->buffer[src_offset];
-        }
-    }
+    pf_framebuffer_present_INTERNAL((uint8_t*)dst_fb->buffer + dst_ymin * pitch + dst_xmin * bpp,
+        dst_xmax - dst_xmin + 1, dst_ymax - dst_ymin + 1, pitch, format, src_fb, src, false);
 }
 
 void
@@ -165,23 +714,83 @@ pf_framebuffer_copy_pixels(
         if (ymin > ymax) PF_SWAP(ymin, ymax);
     }
 
-    uint32_t *dst_ptr = (uint32_t*)dst;
-    pf_simd_i_t src_vector;
-    
+    // NOTE: The rows are packed one after the other, in the format of the framebuffer
+    const size_t bpp = pf_pixel_get_bytes(src_fb->format ? src_fb->format : PF_PIXELFORMAT_RGBA8888);
+    const size_t row_size = (size_t)(xmax - xmin + 1) * bpp;
+
+    uint8_t* dst_ptr = (uint8_t*)dst;
+    const uint8_t* src_ptr = (const uint8_t*)src_fb->buffer;
+
     for (int y = ymin; y <= ymax; ++y) {
-        const pf_color_t *src_row_ptr = src_fb->buffer + y * src_fb->w + xmin;
-        int x = xmin;
-        
-        for (; x <= xmax - PF_SIMD_SIZE + 1; x += PF_SIMD_SIZE) {
-            src_vector = pf_simd_load_i32(src_row_ptr + x);
-            pf_simd_store_i32(dst_ptr + x, src_vector);
-        }
-        
-        // Copie des pixels restants
-        for (; x <= xmax; ++x) {
-            dst_ptr[x] = src_row_ptr[x].v;
+        memcpy(dst_ptr, src_ptr + ((size_t)y * src_fb->w + xmin) * bpp, row_size);
+        dst_ptr += row_size;
+    }
+}
+
+void
+pf_framebuffer_present(
+    void * restrict dst,
+    uint32_t dst_w, uint32_t dst_h,
+    size_t dst_pitch,
+    pf_framebuffer_present_format_e dst_format,
+    const pf_framebuffer_t * restrict src_fb,
+    const uint32_t src_rect[4],
+    pf_framebuffer_present_scale_e scale)
+{
+    uint32_t src[4];
+
+    if (dst == NULL || dst_w == 0 || dst_h == 0
+     || src_fb == NULL || src_fb->buffer == NULL) {
+        return;
+    }
+
+    if (src_rect == NULL) {
+        src[0] = src[1] = 0;
+        src[2] = src_fb->w - 1;
+        src[3] = src_fb->h - 1;
+    } else {
+        src[0] = PF_MIN(src_rect[0], src_fb->w - 1);
+        src[1] = PF_MIN(src_rect[1], src_fb->h - 1);
+        src[2] = PF_MIN(src_rect[2], src_fb->w - 1);
+        src[3] = PF_MIN(src_rect[3], src_fb->h - 1);
+        if (src[0] > src[2]) PF_SWAP(src[0], src[2]);
+        if (src[1] > src[3]) PF_SWAP(src[1], src[3]);
+    }
+
+    const size_t bpp = pf_framebuffer_present_get_bytes(dst_format);
+    if (dst_pitch == 0) dst_pitch = dst_w * bpp;
+
+    uint8_t* dst_ptr = (uint8_t*)dst;
+
+    if (scale == PF_PRESENT_SCALE_INTEGER) {
+        uint32_t sw = src[2] - src[0] + 1;
+        uint32_t sh = src[3] - src[1] + 1;
+        uint32_t factor = PF_MIN(dst_w / sw, dst_h / sh);
+        if (factor > 0) {
+            dst_ptr += ((dst_h - sh * factor) / 2) * dst_pitch;
+            dst_ptr += ((dst_w - sw * factor) / 2) * bpp;
+            dst_w = sw * factor, dst_h = sh * factor;
         }
     }
+
+    pf_framebuffer_present_INTERNAL(dst_ptr, dst_w, dst_h, dst_pitch, dst_format,
+        src_fb, src, scale == PF_PRESENT_SCALE_BILINEAR);
+}
+
+size_t
+pf_framebuffer_present_get_bytes(
+    pf_framebuffer_present_format_e format)
+{
+    switch (format) {
+        case PF_PRESENT_FORMAT_RGB888:
+            return 3;
+        case PF_PRESENT_FORMAT_RGB565:
+            return 2;
+        case PF_PRESENT_FORMAT_GRAY:
+            return 1;
+        default:
+            return 4;
+    }
 }
 
 pf_color_t
@@ -191,7 +800,7 @@ pf_framebuffer_get(
 {
     pf_color_t result = { 0 };
     if (x < fb->w && y < fb->h) {
-        result = fb->buffer[y * fb->w + x];
+        result = pf_framebuffer_load(fb, (size_t)y * fb->w + x);
     }
     return result;
 }
@@ -203,7 +812,7 @@ pf_framebuffer_put(
     pf_color_t color)
 {
     if (x < fb->w && y < fb->h) {
-        fb->buffer[y * fb->w + x] = color;
+        pf_framebuffer_store(fb, (size_t)y * fb->w + x, color);
     }
 }
 
@@ -234,18 +843,8 @@ pf_framebuffer_fill(
         if (ymin > ymax) PF_SWAP(ymin, ymax);
     }
 
-    pf_color_t* row_ptr;
-    pf_simd_i_t color_vector = pf_simd_set1_i32(color.v);
-
     for (int y = ymin; y <= ymax; ++y) {
-        row_ptr = fb->buffer + y * fb->w + xmin;
-        int x = xmin;
-        for (; x <= xmax - PF_SIMD_SIZE + 1; x += PF_SIMD_SIZE) {
-            pf_simd_store_i32(row_ptr + x, color_vector);
-        }
-        for (; x <= xmax; ++x) {
-            row_ptr[x] = color;
-        }
+        pf_framebuffer_fill_span_INTERNAL(fb, (size_t)y * fb->w + xmin, xmax - xmin + 1, color);
     }
 }
 
@@ -274,14 +873,23 @@ pf_framebuffer_map(
         if (ymin > ymax) PF_SWAP(ymin, ymax);
     }
 
+    // NOTE: Pixels in other formats than RGBA8888 are mapped through a converted copy
+    const bool direct = (fb->format == PF_PIXELFORMAT_RGBA8888);
+
 #ifdef _OPENMP
 #   pragma omp parallel for\
         if ((xmax - xmin) * (ymax - ymin) >= PF_OMP_BUFFER_MAP_SIZE_THRESHOLD)
 #endif //_OPENMP
     for (int y = ymin; y <= ymax; ++y) {
-        pf_color_t* ptr = fb->buffer + y * fb->w + xmin;
-        for (int x = xmin; x <= xmax; ++x) {
-            func(fb, ptr++, x, y);
+        size_t offset = (size_t)y * fb->w + xmin;
+        for (int x = xmin; x <= xmax; ++x, ++offset) {
+            if (direct) {
+                func(fb, (pf_color_t*)fb->buffer + offset, x, y);
+            } else {
+                pf_color_t color = pf_framebuffer_load(fb, offset);
+                func(fb, &color, x, y);
+                pf_framebuffer_store(fb, offset, color);
+            }
         }
     }
 }
@@ -361,14 +969,14 @@ pf_framebuffer_export_as_bmp(
     }
 
     // Copy the pixel data without the alpha channel
-    uint8_t* ptr = pixel_data;
 #ifdef _OPENMP
 #   pragma omp parallel for\
         if (fb->w * fb->h >= PF_OMP_BUFFER_COPY_SIZE_THRESHOLD)
 #endif //_OPENMP
     for (uint32_t y = 0; y < fb->h; y++) {
+        uint8_t* ptr = pixel_data + (size_t)y * fb->w * 3;
         for (uint32_t x = 0; x < fb->w; x++) {
-            pf_color_t color = fb->buffer[y * fb->w + x];
+            pf_color_t color = pf_framebuffer_load(fb, (size_t)y * fb->w + x);
             *ptr++ = color.c.b;
             *ptr++ = color.c.g;
             *ptr++ = color.c.r;
@@ -384,3 +992,325 @@ pf_framebuffer_export_as_bmp(
 
     return 0;
 }
+
+void
+pf_framebuffer_store_span(
+    pf_framebuffer_t* restrict fb,
+    size_t offset,
+    const pf_color_t* restrict colors,
+    size_t count,
+    pf_color_blend_fn blend,
+    pf_color_blend_span_fn blend_span)
+{
+    const pf_framebuffer_present_format_e format = pf_framebuffer_get_present_format_INTERNAL(fb->format);
+    const size_t bpp = pf_framebuffer_present_get_bytes(format);
+
+    if (blend == NULL && blend_span == NULL) {
+        pf_framebuffer_pack_span_INTERNAL(
+            (uint8_t*)fb->buffer + offset * bpp, format, colors, count);
+        return;
+    }
+
+    if (fb->format == PF_PIXELFORMAT_RGBA8888) {
+        pf_color_t* dst = (pf_color_t*)fb->buffer + offset;
+        if (blend_span != NULL) {
+            blend_span(dst, colors, count);
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                dst[i] = blend(dst[i], colors[i]);
+            }
+        }
+        return;
+    }
+
+    // NOTE: The other formats are blended by chunks read into a temporary span
+    pf_color_t span[64];
+
+    for (size_t start = 0; start < count; start += 64) {
+        size_t n = PF_MIN(count - start, 64);
+        for (size_t i = 0; i < n; ++i) {
+            span[i] = pf_framebuffer_load(fb, offset + start + i);
+        }
+        if (blend_span != NULL) {
+            blend_span(span, colors + start, n);
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                span[i] = blend(span[i], colors[start + i]);
+            }
+        }
+        pf_framebuffer_pack_span_INTERNAL(
+            (uint8_t*)fb->buffer + (offset + start) * bpp, format, span, n);
+    }
+}
+
+/* Damage Functions */
+
+pf_framebuffer_damage_t
+pf_framebuffer_damage_create(
+    uint32_t w, uint32_t h)
+{
+    pf_framebuffer_damage_t damage = { 0 };
+    if (w == 0 || h == 0) return damage;
+
+    damage.tiles_x = (w + PF_DAMAGE_TILE_SIZE - 1) / PF_DAMAGE_TILE_SIZE;
+    damage.tiles_y = (h + PF_DAMAGE_TILE_SIZE - 1) / PF_DAMAGE_TILE_SIZE;
+    damage.pitch = (damage.tiles_x + 31) / 32;
+    damage.w = w, damage.h = h;
+
+    size_t size = (size_t)damage.pitch * damage.tiles_y;
+
+    damage.drawn = PF_CALLOC(2 * size, sizeof(uint32_t));
+    if (damage.drawn == NULL) {
+        fprintf(stderr, "ERROR: Failed to allocate the damage tiles\n");
+        return (pf_framebuffer_damage_t) { 0 };
+    }
+
+    // NOTE: The initial content is unknown, so the first damaged fill covers everything
+    damage.cleared = damage.drawn + size;
+    memset(damage.drawn, 0xFF, size * sizeof(uint32_t));
+
+    return damage;
+}
+
+void
+pf_framebuffer_damage_delete(
+    pf_framebuffer_damage_t* damage)
+{
+    // NOTE: 'cleared' is part of the allocation of 'drawn'
+    if (damage->drawn != NULL) {
+        PF_FREE(damage->drawn);
+    }
+    *damage = (pf_framebuffer_damage_t) { 0 };
+}
+
+void
+pf_framebuffer_damage_add(
+    pf_framebuffer_damage_t* damage,
+    int x1, int y1, int x2, int y2)
+{
+    if (damage->drawn == NULL) {
+        return;
+    }
+
+    if (x1 > x2) PF_SWAP(x1, x2);
+    if (y1 > y2) PF_SWAP(y1, y2);
+
+    if (x2 < 0 || y2 < 0 || x1 >= (int)damage->w || y1 >= (int)damage->h) {
+        return;
+    }
+
+    uint32_t tx1 = (uint32_t)PF_MAX(x1, 0) / PF_DAMAGE_TILE_SIZE;
+    uint32_t ty1 = (uint32_t)PF_MAX(y1, 0) / PF_DAMAGE_TILE_SIZE;
+    uint32_t tx2 = (uint32_t)PF_MIN(x2, (int)damage->w - 1) / PF_DAMAGE_TILE_SIZE;
+    uint32_t ty2 = (uint32_t)PF_MIN(y2, (int)damage->h - 1) / PF_DAMAGE_TILE_SIZE;
+
+    // NOTE: The words are read and updated atomically, the primitives of a mesh
+    //       being possibly rasterized by several threads at once
+
+    for (uint32_t ty = ty1; ty <= ty2; ++ty) {
+        uint32_t* row = damage->drawn + (size_t)ty * damage->pitch;
+        for (uint32_t w = tx1 / 32; w <= tx2 / 32; ++w) {
+            uint32_t lo = (w == tx1 / 32) ? tx1 % 32 : 0;
+            uint32_t hi = (w == tx2 / 32) ? tx2 % 32 : 31;
+            uint32_t mask = (0xFFFFFFFFu >> (31 - hi)) & (0xFFFFFFFFu << lo);
+            uint32_t bits;
+#ifdef _OPENMP
+#           pragma omp atomic read
+#endif //_OPENMP
+            bits = row[w];
+            if ((bits & mask) == mask) continue;
+#ifdef _OPENMP
+#           pragma omp atomic
+#endif //_OPENMP
+            row[w] |= mask;
+        }
+    }
+}
+
+void
+pf_framebuffer_damage_reset(
+    pf_framebuffer_damage_t* damage)
+{
+    if (damage->drawn == NULL) {
+        return;
+    }
+
+    memset(damage->drawn, 0, 2 * (size_t)damage->pitch * damage->tiles_y * sizeof(uint32_t));
+}
+
+void
+pf_framebuffer_damage_invalidate(
+    pf_framebuffer_damage_t* damage)
+{
+    if (damage->drawn == NULL) {
+        return;
+    }
+
+    size_t size = (size_t)damage->pitch * damage->tiles_y;
+
+    // NOTE: The bits past the last tile of each row are never read
+    memset(damage->drawn, 0, size * sizeof(uint32_t));
+    memset(damage->cleared, 0xFF, size * sizeof(uint32_t));
+}
+
+void
+pf_framebuffer_damage_advance(
+    pf_framebuffer_damage_t* damage)
+{
+    if (damage->drawn == NULL) {
+        return;
+    }
+
+    size_t size = (size_t)damage->pitch * damage->tiles_y;
+
+    memcpy(damage->cleared, damage->drawn, size * sizeof(uint32_t));
+    memset(damage->drawn, 0, size * sizeof(uint32_t));
+}
+
+bool
+pf_framebuffer_damage_next(
+    const pf_framebuffer_damage_t* damage,
+    bool include_cleared,
+    uint32_t* cursor,
+    uint32_t rect[4])
+{
+    if (damage->drawn == NULL) {
+        return false;
+    }
+
+    const uint32_t num_tiles = damage->tiles_x * damage->tiles_y;
+
+    while (*cursor < num_tiles) {
+        uint32_t ty = *cursor / damage->tiles_x;
+        uint32_t tx = *cursor % damage->tiles_x;
+        uint32_t tx_end;
+
+        if (!pf_framebuffer_damage_row_next_INTERNAL(damage, include_cleared, ty, &tx, &tx_end)) {
+            *cursor = (ty + 1) * damage->tiles_x;
+            continue;
+        }
+
+        rect[0] = tx * PF_DAMAGE_TILE_SIZE;
+        rect[1] = ty * PF_DAMAGE_TILE_SIZE;
+        rect[2] = PF_MIN((tx_end + 1) * PF_DAMAGE_TILE_SIZE, damage->w) - 1;
+        rect[3] = PF_MIN((ty + 1) * PF_DAMAGE_TILE_SIZE, damage->h) - 1;
+
+        *cursor = ty * damage->tiles_x + tx_end + 1;
+        return true;
+    }
+
+    return false;
+}
+
+bool
+pf_framebuffer_damage_get_bounds(
+    const pf_framebuffer_damage_t* damage,
+    uint32_t rect[4])
+{
+    uint32_t cursor = 0, run[4];
+
+    if (!pf_framebuffer_damage_next(damage, true, &cursor, run)) {
+        return false;
+    }
+
+    memcpy(rect, run, sizeof(run));
+
+    while (pf_framebuffer_damage_next(damage, true, &cursor, run)) {
+        rect[0] = PF_MIN(rect[0], run[0]);
+        rect[2] = PF_MAX(rect[2], run[2]);
+        rect[3] = run[3];
+    }
+
+    return true;
+}
+
+void
+pf_framebuffer_fill_damaged(
+    pf_framebuffer_t* fb,
+    pf_framebuffer_damage_t* damage,
+    pf_color_t color)
+{
+    if (fb == NULL || fb->buffer == NULL) {
+        return;
+    }
+
+    if (damage->drawn == NULL) {
+        pf_framebuffer_fill(fb, NULL, color);
+        return;
+    }
+
+    uint32_t cursor = 0, rect[4];
+
+    while (pf_framebuffer_damage_next(damage, false, &cursor, rect)) {
+        pf_framebuffer_fill(fb, rect, color);
+    }
+
+    pf_framebuffer_damage_advance(damage);
+}
+
+void
+pf_framebuffer_copy_damaged(
+    pf_framebuffer_t * restrict dst_fb,
+    const pf_framebuffer_t * restrict src_fb,
+    const pf_framebuffer_damage_t* damage)
+{
+    if (dst_fb == NULL || dst_fb->buffer == NULL) {
+        return;
+    }
+
+    if (dst_fb->w != src_fb->w || dst_fb->h != src_fb->h) {
+        fprintf(stderr, "ERROR: Damaged copies require framebuffers of the same size\n");
+        return;
+    }
+
+    pf_framebuffer_present_format_e format = pf_framebuffer_get_present_format_INTERNAL(dst_fb->format);
+    pf_framebuffer_present_damaged(dst_fb->buffer, 0, format, src_fb, damage);
+}
+
+void
+pf_framebuffer_present_damaged(
+    void * restrict dst,
+    size_t dst_pitch,
+    pf_framebuffer_present_format_e dst_format,
+    const pf_framebuffer_t * restrict src_fb,
+    const pf_framebuffer_damage_t* damage)
+{
+    if (dst == NULL || src_fb == NULL || src_fb->buffer == NULL) {
+        return;
+    }
+
+    if (damage->drawn == NULL) {
+        pf_framebuffer_present(dst, src_fb->w, src_fb->h, dst_pitch,
+            dst_format, src_fb, NULL, PF_PRESENT_SCALE_NEAREST);
+        return;
+    }
+
+    if (damage->w != src_fb->w || damage->h != src_fb->h) {
+        fprintf(stderr, "ERROR: The damage does not match the size of the framebuffer\n");
+        return;
+    }
+
+    if (dst_pitch == 0) {
+        dst_pitch = src_fb->w * pf_framebuffer_present_get_bytes(dst_format);
+    }
+
+    // NOTE: Each thread processes whole rows of tiles, so no pixel is written twice
+
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(dynamic) \
+        if ((size_t)src_fb->w * src_fb->h >= PF_OMP_BUFFER_COPY_SIZE_THRESHOLD)
+#endif //_OPENMP
+    for (int i = 0; i < (int)damage->tiles_y; ++i) {
+        uint32_t ty = (uint32_t)i, tx = 0, tx_end;
+        while (pf_framebuffer_damage_row_next_INTERNAL(damage, true, ty, &tx, &tx_end)) {
+            uint32_t rect[4] = {
+                tx * PF_DAMAGE_TILE_SIZE,
+                ty * PF_DAMAGE_TILE_SIZE,
+                PF_MIN((tx_end + 1) * PF_DAMAGE_TILE_SIZE, damage->w) - 1,
+                PF_MIN((ty + 1) * PF_DAMAGE_TILE_SIZE, damage->h) - 1
+            };
+            pf_framebuffer_convert_rect_INTERNAL(dst, dst_pitch, dst_format, src_fb, rect);
+            tx = tx_end + 1;
+        }
+    }
+}
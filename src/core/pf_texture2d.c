@@ -18,6 +18,367 @@
  */
 
 #include "pixelfactory/core/pf_texture2d.h"
+#include <stdio.h>
+
+/* Internal Layout Functions */
+
+static inline uint32_t
+pf_texture2d_morton_part_INTERNAL(uint32_t n)
+{
+    // NOTE: Spreads the 16 low bits of 'n' over its even bits
+    n &= 0x0000FFFF;
+    n = (n | (n << 8)) & 0x00FF00FF;
+    n = (n | (n << 4)) & 0x0F0F0F0F;
+    n = (n | (n << 2)) & 0x33333333;
+    n = (n | (n << 1)) & 0x55555555;
+    return n;
+}
+
+static inline size_t
+pf_texture2d_index_INTERNAL(
+    const pf_texture2d_t* tex,
+    uint32_t x, uint32_t y)
+{
+    switch (tex->layout) {
+        case PF_TEXTURE_LAYOUT_TILED:
+            return (((size_t)(y >> 2) * ((tex->w + 3) >> 2) + (x >> 2)) << 4) | ((y & 3) << 2) | (x & 3);
+
+        case PF_TEXTURE_LAYOUT_MORTON: {
+            // NOTE: Only the coordinate along the longest axis can exceed the side of the
+            //       squares, its high bits select the square
+            uint32_t mask = PF_MIN(tex->w, tex->h) - 1;
+            return (size_t)((x | y) & ~mask) * (mask + 1)
+                + (pf_texture2d_morton_part_INTERNAL(x & mask)
+                | (pf_texture2d_morton_part_INTERNAL(y & mask) << 1));
+        }
+
+        default:
+            return (size_t)y * tex->w + x;
+    }
+}
+
+static inline size_t
+pf_texture2d_level_bytes_INTERNAL(
+    const pf_texture2d_t* tex,
+    uint32_t w, uint32_t h)
+{
+    if (tex->layout == PF_TEXTURE_LAYOUT_TILED) {
+        return (size_t)((w + 3) & ~3u) * ((h + 3) & ~3u) * pf_pixel_get_bytes(tex->format);
+    }
+    return pf_pixel_get_image_bytes(tex->format, w, h);
+}
+
+/* Internal Map Functions */
+
+static inline void
+pf_texture2d_map_wrap_pot_INTERNAL(
+    const pf_texture2d_t* tex,
+    uint32_t* x, uint32_t* y,
+    float u, float v)
+{
+    *x = (uint32_t)(int)((u - (int)u)*(tex->w - 1)) & (tex->w - 1);
+    *y = (uint32_t)(int)((v - (int)v)*(tex->h - 1)) & (tex->h - 1);
+}
+
+static inline void
+pf_texture2d_map_wrap_INTERNAL(
+    const pf_texture2d_t* tex,
+    uint32_t* x, uint32_t* y,
+    float u, float v)
+{
+    *x = (uint32_t)((u - (int)u)*(tex->w - 1)) % tex->w;
+    *y = (uint32_t)((v - (int)v)*(tex->h - 1)) % tex->h;
+}
+
+static inline void
+pf_texture2d_map_clamp_INTERNAL(
+    const pf_texture2d_t* tex,
+    uint32_t* x, uint32_t* y,
+    float u, float v)
+{
+    *x = (uint32_t)PF_CLAMP((int)(u*(tex->w - 1)), 0, (int)tex->w - 1);
+    *y = (uint32_t)PF_CLAMP((int)(v*(tex->h - 1)), 0, (int)tex->h - 1);
+}
+
+/* Internal Block Cache */
+
+// NOTE: Entries are matched on the raw content of the block rather than on its address,
+//       so that a cached block can never be stale, even if the texels are modified or
+//       freed and another texture is allocated at the same place.
+typedef struct {
+    uint64_t raw[2];
+    pf_color_t texels[16];
+    pf_pixelformat_e format;
+} pf_texture2d_block_INTERNAL_t;
+
+static PF_THREAD_LOCAL pf_texture2d_block_INTERNAL_t
+    pf_texture2d_block_cache_INTERNAL[PF_TEXTURE_BLOCK_CACHE_SIZE];
+
+static pf_color_t
+pf_texture2d_get_block_texel_INTERNAL(
+    const pf_texture2d_t* tex,
+    uint32_t x, uint32_t y)
+{
+    const uint32_t bx = x >> 2, by = y >> 2;
+    const size_t block_bytes = (tex->format == PF_PIXELFORMAT_BC1
+                             || tex->format == PF_PIXELFORMAT_BC4
+                             || tex->format == PF_PIXELFORMAT_ETC2_RGB8) ? 8 : 16;
+
+    const uint8_t* block = (const uint8_t*)tex->texels
+        + ((size_t)by * ((tex->w + 3) >> 2) + bx) * block_bytes;
+
+    uint64_t raw[2] = { 0 };
+    memcpy(raw, block, block_bytes);
+
+    // NOTE: The slot spans 8x4 neighboring blocks, offset per texture to limit the
+    //       conflicts between textures sampled alternately
+
+    size_t slot = (bx & 7) + ((by & 3) << 3) + ((uintptr_t)tex->texels >> 6);
+    pf_texture2d_block_INTERNAL_t* entry = &pf_texture2d_block_cache_INTERNAL[slot & (PF_TEXTURE_BLOCK_CACHE_SIZE - 1)];
+
+    if (entry->format != tex->format || entry->raw[0] != raw[0] || entry->raw[1] != raw[1]) {
+        tex->decoder(block, entry->texels);
+        entry->raw[0] = raw[0];
+        entry->raw[1] = raw[1];
+        entry->format = tex->format;
+    }
+
+    return entry->texels[((y & 3) << 2) | (x & 3)];
+}
+
+static inline pf_color_t
+pf_texture2d_texel_INTERNAL(
+    const pf_texture2d_t* tex,
+    uint32_t x, uint32_t y)
+{
+    if (tex->decoder == NULL) {
+        return tex->getter(tex->texels, pf_texture2d_index_INTERNAL(tex, x, y));
+    }
+    return pf_texture2d_get_block_texel_INTERNAL(tex, x, y);
+}
+
+/* Internal Mipmap Functions */
+
+static inline void
+pf_texture2d_level_INTERNAL(
+    pf_texture2d_t* out_level,
+    const pf_texture2d_t* tex,
+    uint32_t level)
+{
+    // NOTE: The view shares the sampler and mapper of the texture, the levels
+    //       of a power of two texture being themselves powers of two
+
+    *out_level = *tex;
+    out_level->texels = tex->mipmaps[level - 1];
+    out_level->w = PF_MAX(1, tex->w >> level);
+    out_level->h = PF_MAX(1, tex->h >> level);
+    out_level->tx = 1.0f / out_level->w;
+    out_level->ty = 1.0f / out_level->h;
+    out_level->num_mipmaps = 0;
+}
+
+static void
+pf_texture2d_copy_level_INTERNAL(
+    const pf_texture2d_t* dst,
+    const pf_texture2d_t* src)
+{
+    // NOTE: Both textures have the same size and format, only their layout differs
+
+    const size_t bpp = pf_pixel_get_bytes(src->format);
+    const uint8_t* src_texels = src->texels;
+    uint8_t* dst_texels = dst->texels;
+
+#ifdef _OPENMP
+#   pragma omp parallel for \
+        if ((size_t)src->w * src->h >= PF_OMP_BUFFER_MAP_SIZE_THRESHOLD)
+#endif //_OPENMP
+    for (uint32_t y = 0; y < src->h; ++y) {
+        for (uint32_t x = 0; x < src->w; ++x) {
+            memcpy(dst_texels + pf_texture2d_index_INTERNAL(dst, x, y) * bpp,
+                   src_texels + pf_texture2d_index_INTERNAL(src, x, y) * bpp, bpp);
+        }
+    }
+}
+
+/* Internal Bilinear Kernels */
+
+/*
+    The weights are converted to 8.8 fixed point and the channels are interpolated
+    two by two, red with blue and green with alpha, in the 16-bit halves of 32-bit
+    integers. A channel times a weight never exceeds 255 * 256, so the halves can't
+    overflow into each other. The scalar and SIMD kernels give identical results.
+*/
+
+static inline uint32_t
+pf_texture2d_bilinear_weight_INTERNAL(float coord)
+{
+    return (uint32_t)((coord - floorf(coord)) * 256.0f);
+}
+
+static inline pf_color_t
+pf_texture2d_bilerp_INTERNAL(
+    pf_color_t c00, pf_color_t c10,
+    pf_color_t c01, pf_color_t c11,
+    uint32_t fx, uint32_t fy)
+{
+    const uint32_t mask = 0x00FF00FF;
+    const uint32_t ifx = 256 - fx, ify = 256 - fy;
+
+    uint32_t rb0 = (((c00.v & mask) * ifx + (c10.v & mask) * fx) >> 8) & mask;
+    uint32_t rb1 = (((c01.v & mask) * ifx + (c11.v & mask) * fx) >> 8) & mask;
+    uint32_t ga0 = ((((c00.v >> 8) & mask) * ifx + ((c10.v >> 8) & mask) * fx) >> 8) & mask;
+    uint32_t ga1 = ((((c01.v >> 8) & mask) * ifx + ((c11.v >> 8) & mask) * fx) >> 8) & mask;
+
+    uint32_t rb = ((rb0 * ify + rb1 * fy) >> 8) & mask;
+    uint32_t ga = ((ga0 * ify + ga1 * fy) >> 8) & mask;
+
+    return (pf_color_t) { .v = rb | (ga << 8) };
+}
+
+#if PF_SIMD_SIZE > 1
+
+static inline pf_simd_i_t
+pf_texture2d_bilerp_simd_INTERNAL(
+    pf_simd_i_t c00, pf_simd_i_t c10,
+    pf_simd_i_t c01, pf_simd_i_t c11,
+    pf_simd_i_t fx, pf_simd_i_t fy)
+{
+    // NOTE: 'fx' and 'fy' hold the weights in both 16-bit halves of each lane
+
+    const pf_simd_i_t mask = pf_simd_set1_i32(0x00FF00FF);
+    const pf_simd_i_t one = pf_simd_set1_i32(0x01000100);
+
+    pf_simd_i_t ifx = pf_simd_sub_i32(one, fx);
+    pf_simd_i_t ify = pf_simd_sub_i32(one, fy);
+
+#   define PF_LERP_I16(a, b, ia, fa) \
+        pf_simd_srli_i16(pf_simd_add_i16(pf_simd_mullo_i16(a, ia), pf_simd_mullo_i16(b, fa)), 8)
+
+    pf_simd_i_t rb0 = PF_LERP_I16(pf_simd_and_i32(c00, mask), pf_simd_and_i32(c10, mask), ifx, fx);
+    pf_simd_i_t rb1 = PF_LERP_I16(pf_simd_and_i32(c01, mask), pf_simd_and_i32(c11, mask), ifx, fx);
+    pf_simd_i_t ga0 = PF_LERP_I16(pf_simd_and_i32(pf_simd_srli_i32(c00, 8), mask), pf_simd_and_i32(pf_simd_srli_i32(c10, 8), mask), ifx, fx);
+    pf_simd_i_t ga1 = PF_LERP_I16(pf_simd_and_i32(pf_simd_srli_i32(c01, 8), mask), pf_simd_and_i32(pf_simd_srli_i32(c11, 8), mask), ifx, fx);
+
+    pf_simd_i_t rb = PF_LERP_I16(rb0, rb1, ify, fy);
+    pf_simd_i_t ga = PF_LERP_I16(ga0, ga1, ify, fy);
+
+#   undef PF_LERP_I16
+
+    return pf_simd_or_i32(rb, pf_simd_slli_i32(ga, 8));
+}
+
+static inline pf_simd_i_t
+pf_texture2d_bilinear_weight_simd_INTERNAL(pf_simd_t coord)
+{
+    pf_simd_t frac = pf_simd_sub_ps(coord, pf_simd_floor_ps(coord));
+    pf_simd_i_t weight = pf_simd_cvttf32_i32(pf_simd_mul_ps(frac, pf_simd_set1_ps(256.0f)));
+    return pf_simd_or_i32(weight, pf_simd_slli_i32(weight, 16));
+}
+
+#endif //PF_SIMD_SIZE
+
+/* Internal Specialized Samplers */
+
+static inline pf_color_t
+pf_texture2d_fetch_gray_INTERNAL(const void* texels, size_t index)
+{
+    uint8_t gray = ((const uint8_t*)texels)[index];
+    return (pf_color_t) { .c = { gray, gray, gray, 255 } };
+}
+
+static inline pf_color_t
+pf_texture2d_fetch_gray_alpha_INTERNAL(const void* texels, size_t index)
+{
+    const uint8_t* texel = (const uint8_t*)texels + 2 * index;
+    return (pf_color_t) { .c = { texel[0], texel[0], texel[0], texel[1] } };
+}
+
+static inline pf_color_t
+pf_texture2d_fetch_rgb888_INTERNAL(const void* texels, size_t index)
+{
+    const uint8_t* texel = (const uint8_t*)texels + 3 * index;
+    return (pf_color_t) { .c = { texel[0], texel[1], texel[2], 255 } };
+}
+
+static inline pf_color_t
+pf_texture2d_fetch_rgba8888_INTERNAL(const void* texels, size_t index)
+{
+    return ((const pf_color_t*)texels)[index];
+}
+
+/*
+    Each specialized sampler inlines the mapping and the texel fetch of one format and
+    one mapper. Since the 'mapper' and 'getter' of a texture can be replaced after its
+    creation, they fall back to the generic samplers when they no longer match.
+*/
+
+#define PF_TEXTURE2D_DEFINE_SAMPLERS_INTERNAL(FORMAT, WRAP)                                 \
+                                                                                            \
+    static pf_color_t                                                                       \
+    pf_texture2d_sample_nearest_##FORMAT##_##WRAP##_INTERNAL(                               \
+        const pf_texture2d_t* tex,                                                          \
+        float u, float v)                                                                   \
+    {                                                                                       \
+        if (tex->mapper != pf_texture2d_uv_map_##WRAP || tex->getter != pf_pixel_get_##FORMAT) { \
+            return pf_texture2d_sample_nearest(tex, u, v);                                  \
+        }                                                                                   \
+        uint32_t x, y;                                                                      \
+        pf_texture2d_map_##WRAP##_INTERNAL(tex, &x, &y, u, v);                              \
+        return pf_texture2d_fetch_##FORMAT##_INTERNAL(                                      \
+            tex->texels, pf_texture2d_index_INTERNAL(tex, x, y));                           \
+    }                                                                                       \
+                                                                                            \
+    static pf_color_t                                                                       \
+    pf_texture2d_sample_bilinear_##FORMAT##_##WRAP##_INTERNAL(                              \
+        const pf_texture2d_t* tex,                                                          \
+        float u, float v)                                                                   \
+    {                                                                                       \
+        if (tex->mapper != pf_texture2d_uv_map_##WRAP || tex->getter != pf_pixel_get_##FORMAT) { \
+            return pf_texture2d_sample_bilinear(tex, u, v);                                 \
+        }                                                                                   \
+        uint32_t x0, y0, x1, y1;                                                            \
+        pf_texture2d_map_##WRAP##_INTERNAL(tex, &x0, &y0, u, v);                            \
+        pf_texture2d_map_##WRAP##_INTERNAL(tex, &x1, &y1, u + tex->tx, v + tex->ty);        \
+        uint32_t fx = pf_texture2d_bilinear_weight_INTERNAL(u * (tex->w - 1));              \
+        uint32_t fy = pf_texture2d_bilinear_weight_INTERNAL(v * (tex->h - 1));              \
+        const void* texels = tex->texels;                                                   \
+        pf_color_t c00 = pf_texture2d_fetch_##FORMAT##_INTERNAL(texels, pf_texture2d_index_INTERNAL(tex, x0, y0)); \
+        pf_color_t c10 = pf_texture2d_fetch_##FORMAT##_INTERNAL(texels, pf_texture2d_index_INTERNAL(tex, x1, y0)); \
+        pf_color_t c01 = pf_texture2d_fetch_##FORMAT##_INTERNAL(texels, pf_texture2d_index_INTERNAL(tex, x0, y1)); \
+        pf_color_t c11 = pf_texture2d_fetch_##FORMAT##_INTERNAL(texels, pf_texture2d_index_INTERNAL(tex, x1, y1)); \
+        return pf_texture2d_bilerp_INTERNAL(c00, c10, c01, c11, fx, fy);                    \
+    }
+
+#define PF_TEXTURE2D_DEFINE_FORMAT_SAMPLERS_INTERNAL(FORMAT)                                \
+    PF_TEXTURE2D_DEFINE_SAMPLERS_INTERNAL(FORMAT, wrap_pot)                                 \
+    PF_TEXTURE2D_DEFINE_SAMPLERS_INTERNAL(FORMAT, wrap)                                     \
+    PF_TEXTURE2D_DEFINE_SAMPLERS_INTERNAL(FORMAT, clamp)
+
+PF_TEXTURE2D_DEFINE_FORMAT_SAMPLERS_INTERNAL(gray)
+PF_TEXTURE2D_DEFINE_FORMAT_SAMPLERS_INTERNAL(gray_alpha)
+PF_TEXTURE2D_DEFINE_FORMAT_SAMPLERS_INTERNAL(rgb888)
+PF_TEXTURE2D_DEFINE_FORMAT_SAMPLERS_INTERNAL(rgba8888)
+
+#define PF_TEXTURE2D_SAMPLER_ENTRY_INTERNAL(FORMAT) {                                       \
+    { pf_texture2d_sample_nearest_##FORMAT##_wrap_pot_INTERNAL,                             \
+      pf_texture2d_sample_bilinear_##FORMAT##_wrap_pot_INTERNAL },                          \
+    { pf_texture2d_sample_nearest_##FORMAT##_wrap_INTERNAL,                                 \
+      pf_texture2d_sample_bilinear_##FORMAT##_wrap_INTERNAL },                              \
+    { pf_texture2d_sample_nearest_##FORMAT##_clamp_INTERNAL,                                \
+      pf_texture2d_sample_bilinear_##FORMAT##_clamp_INTERNAL }                              \
+}
+
+// NOTE: Indexed by format, mapper (wrap_pot, wrap, clamp) and filter,
+//       the missing formats use the generic samplers
+static const pf_texture2d_sampler_fn
+pf_texture2d_samplers_INTERNAL[PF_PIXELFORMAT_BGRA8888 + 1][3][2] = {
+    [PF_PIXELFORMAT_GRAY]       = PF_TEXTURE2D_SAMPLER_ENTRY_INTERNAL(gray),
+    [PF_PIXELFORMAT_GRAY_ALPHA] = PF_TEXTURE2D_SAMPLER_ENTRY_INTERNAL(gray_alpha),
+    [PF_PIXELFORMAT_RGB888]     = PF_TEXTURE2D_SAMPLER_ENTRY_INTERNAL(rgb888),
+    [PF_PIXELFORMAT_RGBA8888]   = PF_TEXTURE2D_SAMPLER_ENTRY_INTERNAL(rgba8888),
+};
+
+/* Public API */
 
 pf_texture2d_t
 pf_texture2d_create(
@@ -31,24 +392,20 @@ pf_texture2d_create(
     texture.w = w;
     texture.h = h;
 
-    texture.sampler = pf_texture2d_sample_nearest;
-
-    if ((w & (w - 1)) == 0 && (h & (h - 1)) == 0) {
-        texture.mapper = pf_texture2d_uv_map_wrap_pot;
-    } else {
-        texture.mapper = pf_texture2d_uv_map_wrap;
-    }
-
     pf_pixel_default_getter_setter(
         &texture.getter,
         &texture.setter,
         format);
 
+    texture.decoder = pf_pixel_default_block_decoder(format);
+
     texture.tx = 1.0f/w;
     texture.ty = 1.0f/h;
 
     texture.format = format;
 
+    pf_texture2d_set_sampling(&texture, PF_TEXTURE_WRAP_REPEAT, PF_TEXTURE_FILTER_NEAREST);
+
     return texture;
 }
 
@@ -60,7 +417,7 @@ pf_texture2d_create_with_copy(
     pf_texture2d_t texture = { 0 };
     if (w == 0 || h == 0) return texture;
 
-    size_t size = w * h * pf_pixel_get_bytes(format);
+    size_t size = pf_pixel_get_image_bytes(format, w, h);
 
     texture.texels = malloc(size);
     memcpy(texture.texels, pixels, size);
@@ -68,24 +425,35 @@ pf_texture2d_create_with_copy(
     texture.w = w;
     texture.h = h;
 
-    texture.sampler = pf_texture2d_sample_nearest;
-
-    if ((w & (w - 1)) == 0 && (h & (h - 1)) == 0) {
-        texture.mapper = pf_texture2d_uv_map_wrap_pot;
-    } else {
-        texture.mapper = pf_texture2d_uv_map_wrap;
-    }
-
     pf_pixel_default_getter_setter(
         &texture.getter,
         &texture.setter,
         format);
 
+    texture.decoder = pf_pixel_default_block_decoder(format);
+
     texture.tx = 1.0f/w;
     texture.ty = 1.0f/h;
 
     texture.format = format;
 
+    pf_texture2d_set_sampling(&texture, PF_TEXTURE_WRAP_REPEAT, PF_TEXTURE_FILTER_NEAREST);
+
+    return texture;
+}
+
+pf_texture2d_t
+pf_texture2d_create_ex(
+    void* pixels, uint32_t w, uint32_t h,
+    pf_pixelformat_e format,
+    pf_texture2d_layout_e layout)
+{
+    pf_texture2d_t texture = pf_texture2d_create(pixels, w, h, format);
+
+    if (texture.w > 0 && layout != PF_TEXTURE_LAYOUT_LINEAR) {
+        pf_texture2d_set_layout(&texture, layout);
+    }
+
     return texture;
 }
 
@@ -94,9 +462,130 @@ pf_texture2d_delete(
     pf_texture2d_t* tex)
 {
     PF_FREE(tex->texels);
+    if (tex->num_mipmaps > 0) {
+        PF_FREE(tex->mipmaps[0]);
+    }
     *tex = (pf_texture2d_t) { 0 };
 }
 
+pf_color_t
+pf_texture2d_get_texel(
+    const pf_texture2d_t* tex,
+    uint32_t x, uint32_t y)
+{
+    return pf_texture2d_texel_INTERNAL(tex, x, y);
+}
+
+size_t
+pf_texture2d_get_index(
+    const pf_texture2d_t* tex,
+    uint32_t x, uint32_t y)
+{
+    return pf_texture2d_index_INTERNAL(tex, x, y);
+}
+
+bool
+pf_texture2d_premultiply(
+    pf_texture2d_t* tex)
+{
+    if (tex->getter == NULL || tex->setter == NULL) {
+        fprintf(stderr, "ERROR: Only uncompressed textures can be premultiplied\n");
+        return false;
+    }
+
+    // NOTE: Every stored texel is converted, the padding of the tiled layout included
+    size_t count = pf_texture2d_level_bytes_INTERNAL(tex, tex->w, tex->h) / pf_pixel_get_bytes(tex->format);
+
+    if (tex->format == PF_PIXELFORMAT_RGBA8888) {
+        pf_color_t* texels = tex->texels;
+        for (size_t i = 0; i < count; ++i) {
+            texels[i] = pf_color_premultiply(texels[i]);
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            tex->setter(tex->texels, i, pf_color_premultiply(tex->getter(tex->texels, i)));
+        }
+    }
+
+    if (tex->num_mipmaps > 0) {
+        return pf_texture2d_gen_mipmaps(tex);
+    }
+
+    return true;
+}
+
+/* Layout Functions */
+
+bool
+pf_texture2d_set_layout(
+    pf_texture2d_t* tex,
+    pf_texture2d_layout_e layout)
+{
+    if (tex->layout == layout) {
+        return true;
+    }
+
+    if (tex->getter == NULL || tex->decoder != NULL) {
+        fprintf(stderr, "ERROR: Only uncompressed textures can change their layout\n");
+        return false;
+    }
+
+    if (layout == PF_TEXTURE_LAYOUT_MORTON && ((tex->w & (tex->w - 1)) != 0 || (tex->h & (tex->h - 1)) != 0)) {
+        fprintf(stderr, "ERROR: The Morton layout requires power of two dimensions\n");
+        return false;
+    }
+
+    pf_texture2d_t result = *tex;
+    result.layout = layout;
+
+    /* Allocate the new base level and mipmaps */
+
+    size_t sizes[PF_MAX_MIPMAPS];
+    size_t total = 0;
+
+    for (uint32_t i = 0; i < tex->num_mipmaps; ++i) {
+        uint32_t w = PF_MAX(1, tex->w >> (i + 1));
+        uint32_t h = PF_MAX(1, tex->h >> (i + 1));
+        sizes[i] = pf_texture2d_level_bytes_INTERNAL(&result, w, h);
+        total += sizes[i];
+    }
+
+    // NOTE: Zeroed so that the padding of the tiled layout is deterministic
+    result.texels = PF_CALLOC(1, pf_texture2d_level_bytes_INTERNAL(&result, tex->w, tex->h));
+    uint8_t* data = (total > 0) ? PF_CALLOC(1, total) : NULL;
+
+    if (result.texels == NULL || (total > 0 && data == NULL)) {
+        if (result.texels != NULL) PF_FREE(result.texels);
+        if (data != NULL) PF_FREE(data);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < tex->num_mipmaps; ++i) {
+        result.mipmaps[i] = data;
+        data += sizes[i];
+    }
+
+    /* Reorder every level */
+
+    pf_texture2d_copy_level_INTERNAL(&result, tex);
+
+    for (uint32_t i = 1; i <= tex->num_mipmaps; ++i) {
+        pf_texture2d_t src, dst;
+        pf_texture2d_level_INTERNAL(&src, tex, i);
+        pf_texture2d_level_INTERNAL(&dst, &result, i);
+        pf_texture2d_copy_level_INTERNAL(&dst, &src);
+    }
+
+    PF_FREE(tex->texels);
+    if (tex->num_mipmaps > 0) {
+        PF_FREE(tex->mipmaps[0]);
+    }
+
+    *tex = result;
+
+    return true;
+}
+
 /* Map Functions */
 
 void
@@ -105,8 +594,7 @@ pf_texture2d_uv_map_wrap_pot(
     uint32_t* x, uint32_t* y,
     float u, float v)
 {
-    *x = (uint32_t)((u - (int)u)*(tex->w - 1)) & (tex->w - 1);
-    *y = (uint32_t)((v - (int)v)*(tex->h - 1)) & (tex->h - 1);
+    pf_texture2d_map_wrap_pot_INTERNAL(tex, x, y, u, v);
 }
 
 void
@@ -115,8 +603,7 @@ pf_texture2d_uv_map_wrap(
     uint32_t* x, uint32_t* y,
     float u, float v)
 {
-    *x = (uint32_t)((u - (int)u)*(tex->w - 1)) % tex->w;
-    *y = (uint32_t)((v - (int)v)*(tex->h - 1)) % tex->h;
+    pf_texture2d_map_wrap_INTERNAL(tex, x, y, u, v);
 }
 
 void
@@ -125,8 +612,7 @@ pf_texture2d_uv_map_clamp(
     uint32_t* x, uint32_t* y,
     float u, float v)
 {
-    *x = (uint32_t)PF_CLAMP((int)(u*(tex->w - 1)), 0, (int)tex->w - 1);
-    *y = (uint32_t)PF_CLAMP((int)(v*(tex->h - 1)), 0, (int)tex->h - 1);
+    pf_texture2d_map_clamp_INTERNAL(tex, x, y, u, v);
 }
 
 
@@ -138,7 +624,7 @@ pf_texture2d_sample_nearest(
     float u, float v)
 {
     uint32_t x, y; tex->mapper(tex, &x, &y, u, v);
-    return tex->getter(tex->texels, y * tex->w + x);
+    return pf_texture2d_texel_INTERNAL(tex, x, y);
 }
 
 pf_color_t
@@ -147,27 +633,361 @@ pf_texture2d_sample_bilinear(
     float u, float v)
 {
     uint32_t x0, y0, x1, y1;
-    float fx, fy;
 
     tex->mapper(tex, &x0, &y0, u, v);
     tex->mapper(tex, &x1, &y1, u + tex->tx, v + tex->ty);
 
-    // Calculer les fractions fx, fy
-    fx = u * tex->w - x0;
-    fy = v * tex->h - y0;
+    // NOTE: The mappers scale the coordinates by (size - 1) before wrapping them,
+    //       the fraction is the same before and after wrapping
+    uint32_t fx = pf_texture2d_bilinear_weight_INTERNAL(u * (tex->w - 1));
+    uint32_t fy = pf_texture2d_bilinear_weight_INTERNAL(v * (tex->h - 1));
+
+    pf_color_t c00 = pf_texture2d_texel_INTERNAL(tex, x0, y0);
+    pf_color_t c10 = pf_texture2d_texel_INTERNAL(tex, x1, y0);
+    pf_color_t c01 = pf_texture2d_texel_INTERNAL(tex, x0, y1);
+    pf_color_t c11 = pf_texture2d_texel_INTERNAL(tex, x1, y1);
+
+    return pf_texture2d_bilerp_INTERNAL(c00, c10, c01, c11, fx, fy);
+}
+
+void
+pf_texture2d_sample_bilinear_batch(
+    const pf_texture2d_t* tex,
+    pf_color_t* restrict colors,
+    const float* restrict u,
+    const float* restrict v,
+    size_t count)
+{
+    size_t i = 0;
+
+    // NOTE: The SIMD path requires linear RGBA8888 texels and the 'wrap_pot' or 'clamp'
+    //       mapper, the other textures and the remaining coordinates are sampled one by one
+
+#if PF_SIMD_SIZE > 1
+    bool wrap_pot = (tex->mapper == pf_texture2d_uv_map_wrap_pot);
+    bool clamp = (tex->mapper == pf_texture2d_uv_map_clamp);
+
+    if ((wrap_pot || clamp) && tex->getter == pf_pixel_get_rgba8888 && tex->layout == PF_TEXTURE_LAYOUT_LINEAR) {
+        const int32_t* texels = tex->texels;
+        const pf_simd_t w_max = pf_simd_set1_ps(tex->w - 1);
+        const pf_simd_t h_max = pf_simd_set1_ps(tex->h - 1);
+        const pf_simd_t tx = pf_simd_set1_ps(tex->tx);
+        const pf_simd_t ty = pf_simd_set1_ps(tex->ty);
+        const pf_simd_i_t x_max = pf_simd_set1_i32(tex->w - 1);
+        const pf_simd_i_t y_max = pf_simd_set1_i32(tex->h - 1);
+        const pf_simd_i_t stride = pf_simd_set1_i32(tex->w);
+        const pf_simd_i_t zero = pf_simd_setzero_i32();
+
+        // NOTE: Same operations as the scalar mappers, lane by lane
+#       define PF_MAP_SIMD(c, c_max, i_max)                                                 \
+            (wrap_pot                                                                       \
+                ? pf_simd_and_i32(pf_simd_cvttf32_i32(pf_simd_mul_ps(pf_simd_sub_ps(c,      \
+                    pf_simd_cvti32_ps(pf_simd_cvttf32_i32(c))), c_max)), i_max)             \
+                : pf_simd_min_i32(pf_simd_max_i32(pf_simd_cvttf32_i32(                      \
+                    pf_simd_mul_ps(c, c_max)), zero), i_max))
+
+        for (; i + PF_SIMD_SIZE <= count; i += PF_SIMD_SIZE) {
+            pf_simd_t su = pf_simd_load_ps(u + i);
+            pf_simd_t sv = pf_simd_load_ps(v + i);
+
+            pf_simd_i_t x0 = PF_MAP_SIMD(su, w_max, x_max);
+            pf_simd_i_t y0 = PF_MAP_SIMD(sv, h_max, y_max);
+            pf_simd_i_t x1 = PF_MAP_SIMD(pf_simd_add_ps(su, tx), w_max, x_max);
+            pf_simd_i_t y1 = PF_MAP_SIMD(pf_simd_add_ps(sv, ty), h_max, y_max);
+
+            pf_simd_i_t fx = pf_texture2d_bilinear_weight_simd_INTERNAL(pf_simd_mul_ps(su, w_max));
+            pf_simd_i_t fy = pf_texture2d_bilinear_weight_simd_INTERNAL(pf_simd_mul_ps(sv, h_max));
+
+            y0 = pf_simd_mullo_i32(y0, stride);
+            y1 = pf_simd_mullo_i32(y1, stride);
+
+            pf_simd_i_t c00 = pf_simd_gather_i32(texels, pf_simd_add_i32(y0, x0));
+            pf_simd_i_t c10 = pf_simd_gather_i32(texels, pf_simd_add_i32(y0, x1));
+            pf_simd_i_t c01 = pf_simd_gather_i32(texels, pf_simd_add_i32(y1, x0));
+            pf_simd_i_t c11 = pf_simd_gather_i32(texels, pf_simd_add_i32(y1, x1));
+
+            pf_simd_store_i32(colors + i, pf_texture2d_bilerp_simd_INTERNAL(c00, c10, c01, c11, fx, fy));
+        }
+
+#       undef PF_MAP_SIMD
+    }
+#endif //PF_SIMD_SIZE
+
+    for (; i < count; ++i) {
+        colors[i] = pf_texture2d_sample_bilinear(tex, u[i], v[i]);
+    }
+}
+
+
+void
+pf_texture2d_fetch_span(
+    const pf_texture2d_t* tex,
+    pf_color_t* restrict colors,
+    const int rect[4],
+    float x, float y,
+    float dx, float dy,
+    pf_texture2d_filter_e filter,
+    size_t count)
+{
+    const int x_first = rect[0], y_first = rect[1];
+    const int x_last = rect[2] - 1, y_last = rect[3] - 1;
+    const bool direct = (tex->getter == pf_pixel_get_rgba8888 && tex->layout == PF_TEXTURE_LAYOUT_LINEAR);
+    const pf_color_t* texels = tex->texels;
+
+    size_t i = 0;
+
+    if (filter == PF_TEXTURE_FILTER_NEAREST) {
+        if (direct) {
+            for (; i < count; ++i) {
+                int tx = PF_CLAMP((int)floorf(x + i * dx), x_first, x_last);
+                int ty = PF_CLAMP((int)floorf(y + i * dy), y_first, y_last);
+                colors[i] = texels[(size_t)ty * tex->w + tx];
+            }
+        } else {
+            for (; i < count; ++i) {
+                int tx = PF_CLAMP((int)floorf(x + i * dx), x_first, x_last);
+                int ty = PF_CLAMP((int)floorf(y + i * dy), y_first, y_last);
+                colors[i] = pf_texture2d_texel_INTERNAL(tex, tx, ty);
+            }
+        }
+        return;
+    }
+
+    // NOTE: The texel centers are at half integers, the two neighbors
+    //       are clamped separately so that the edge texels are repeated
+
+    x -= 0.5f, y -= 0.5f;
+
+#if PF_SIMD_SIZE > 1
+    if (direct) {
+        const pf_simd_i_t lanes = pf_simd_setr_i32(0, 1, 2, 3, 4, 5, 6, 7);
+        const pf_simd_t sx = pf_simd_set1_ps(x), sdx = pf_simd_set1_ps(dx);
+        const pf_simd_t sy = pf_simd_set1_ps(y), sdy = pf_simd_set1_ps(dy);
+        const pf_simd_i_t x_min = pf_simd_set1_i32(x_first), x_max = pf_simd_set1_i32(x_last);
+        const pf_simd_i_t y_min = pf_simd_set1_i32(y_first), y_max = pf_simd_set1_i32(y_last);
+        const pf_simd_i_t stride = pf_simd_set1_i32(tex->w);
+        const pf_simd_i_t one = pf_simd_set1_i32(1);
+
+        for (; i + PF_SIMD_SIZE <= count; i += PF_SIMD_SIZE) {
+            pf_simd_t si = pf_simd_cvti32_ps(pf_simd_add_i32(lanes, pf_simd_set1_i32((int32_t)i)));
+            pf_simd_t cx = pf_simd_add_ps(sx, pf_simd_mul_ps(si, sdx));
+            pf_simd_t cy = pf_simd_add_ps(sy, pf_simd_mul_ps(si, sdy));
+
+            pf_simd_i_t x0 = pf_simd_cvttf32_i32(pf_simd_floor_ps(cx));
+            pf_simd_i_t y0 = pf_simd_cvttf32_i32(pf_simd_floor_ps(cy));
+            pf_simd_i_t x1 = pf_simd_min_i32(pf_simd_max_i32(pf_simd_add_i32(x0, one), x_min), x_max);
+            pf_simd_i_t y1 = pf_simd_min_i32(pf_simd_max_i32(pf_simd_add_i32(y0, one), y_min), y_max);
+            x0 = pf_simd_min_i32(pf_simd_max_i32(x0, x_min), x_max);
+            y0 = pf_simd_min_i32(pf_simd_max_i32(y0, y_min), y_max);
+
+            pf_simd_i_t fx = pf_texture2d_bilinear_weight_simd_INTERNAL(cx);
+            pf_simd_i_t fy = pf_texture2d_bilinear_weight_simd_INTERNAL(cy);
+
+            y0 = pf_simd_mullo_i32(y0, stride);
+            y1 = pf_simd_mullo_i32(y1, stride);
+
+            const int32_t* base = (const int32_t*)texels;
+            pf_simd_i_t c00 = pf_simd_gather_i32(base, pf_simd_add_i32(y0, x0));
+            pf_simd_i_t c10 = pf_simd_gather_i32(base, pf_simd_add_i32(y0, x1));
+            pf_simd_i_t c01 = pf_simd_gather_i32(base, pf_simd_add_i32(y1, x0));
+            pf_simd_i_t c11 = pf_simd_gather_i32(base, pf_simd_add_i32(y1, x1));
+
+            pf_simd_store_i32(colors + i, pf_texture2d_bilerp_simd_INTERNAL(c00, c10, c01, c11, fx, fy));
+        }
+    }
+#endif //PF_SIMD_SIZE
+
+    for (; i < count; ++i) {
+        float cx = x + (float)i * dx;
+        float cy = y + (float)i * dy;
+
+        int x0 = (int)floorf(cx), y0 = (int)floorf(cy);
+        int x1 = PF_CLAMP(x0 + 1, x_first, x_last);
+        int y1 = PF_CLAMP(y0 + 1, y_first, y_last);
+        x0 = PF_CLAMP(x0, x_first, x_last);
+        y0 = PF_CLAMP(y0, y_first, y_last);
+
+        colors[i] = pf_texture2d_bilerp_INTERNAL(
+            pf_texture2d_texel_INTERNAL(tex, x0, y0), pf_texture2d_texel_INTERNAL(tex, x1, y0),
+            pf_texture2d_texel_INTERNAL(tex, x0, y1), pf_texture2d_texel_INTERNAL(tex, x1, y1),
+            pf_texture2d_bilinear_weight_INTERNAL(cx), pf_texture2d_bilinear_weight_INTERNAL(cy));
+    }
+}
+
+void
+pf_texture2d_set_sampling(
+    pf_texture2d_t* tex,
+    pf_texture2d_wrap_e wrap,
+    pf_texture2d_filter_e filter)
+{
+    int mapper = 2;
+
+    if (wrap == PF_TEXTURE_WRAP_CLAMP) {
+        tex->mapper = pf_texture2d_uv_map_clamp;
+    } else if ((tex->w & (tex->w - 1)) == 0 && (tex->h & (tex->h - 1)) == 0) {
+        tex->mapper = pf_texture2d_uv_map_wrap_pot;
+        mapper = 0;
+    } else {
+        tex->mapper = pf_texture2d_uv_map_wrap;
+        mapper = 1;
+    }
+
+    tex->sampler = (filter == PF_TEXTURE_FILTER_BILINEAR)
+        ? pf_texture2d_sample_bilinear : pf_texture2d_sample_nearest;
+
+    // NOTE: The specialized samplers assume the default getter of the format
+    if (tex->format > PF_PIXELFORMAT_UNKNOWN && tex->format <= PF_PIXELFORMAT_BGRA8888) {
+        pf_texture2d_sampler_fn sampler = pf_texture2d_samplers_INTERNAL[tex->format][mapper][filter];
+        if (sampler != NULL) tex->sampler = sampler;
+    }
+}
+
+
+/* Mipmap Functions */
+
+bool
+pf_texture2d_gen_mipmaps(
+    pf_texture2d_t* tex)
+{
+    if (tex->getter == NULL || tex->setter == NULL) {
+        fprintf(stderr, "ERROR: Mipmaps can only be generated for uncompressed formats\n");
+        return false;
+    }
+
+    if (tex->num_mipmaps > 0) {
+        PF_FREE(tex->mipmaps[0]);
+        tex->num_mipmaps = 0;
+    }
+
+    /* Count the levels and allocate them at once */
+
+    uint32_t num_levels = 0;
+    size_t sizes[PF_MAX_MIPMAPS];
+    size_t total = 0;
+
+    while (num_levels < PF_MAX_MIPMAPS && ((tex->w >> num_levels) > 1 || (tex->h >> num_levels) > 1)) {
+        uint32_t w = PF_MAX(1, tex->w >> (num_levels + 1));
+        uint32_t h = PF_MAX(1, tex->h >> (num_levels + 1));
+        sizes[num_levels++] = pf_texture2d_level_bytes_INTERNAL(tex, w, h);
+        total += sizes[num_levels - 1];
+    }
+
+    if (num_levels == 0) {
+        return true;
+    }
+
+    uint8_t* data = PF_MALLOC(total);
+    if (data == NULL) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < num_levels; ++i) {
+        tex->mipmaps[i] = data;
+        data += sizes[i];
+    }
+
+    /* Box filter each level from the previous one */
+
+    for (uint32_t i = 0; i < num_levels; ++i) {
+        pf_texture2d_t src, dst;
+        if (i == 0) src = *tex;
+        else pf_texture2d_level_INTERNAL(&src, tex, i);
+        pf_texture2d_level_INTERNAL(&dst, tex, i + 1);
+
+#ifdef _OPENMP
+#       pragma omp parallel for \
+            if ((size_t)dst.w * dst.h >= PF_OMP_BUFFER_MAP_SIZE_THRESHOLD)
+#endif //_OPENMP
+        for (uint32_t y = 0; y < dst.h; ++y) {
+            uint32_t y0 = PF_MIN(2 * y, src.h - 1);
+            uint32_t y1 = PF_MIN(2 * y + 1, src.h - 1);
+            for (uint32_t x = 0; x < dst.w; ++x) {
+                uint32_t x0 = PF_MIN(2 * x, src.w - 1);
+                uint32_t x1 = PF_MIN(2 * x + 1, src.w - 1);
+                pf_color_t c[4] = {
+                    tex->getter(src.texels, pf_texture2d_index_INTERNAL(&src, x0, y0)),
+                    tex->getter(src.texels, pf_texture2d_index_INTERNAL(&src, x1, y0)),
+                    tex->getter(src.texels, pf_texture2d_index_INTERNAL(&src, x0, y1)),
+                    tex->getter(src.texels, pf_texture2d_index_INTERNAL(&src, x1, y1))
+                };
+                pf_color_t result;
+                for (int k = 0; k < 4; ++k) {
+                    result.a[k] = (c[0].a[k] + c[1].a[k] + c[2].a[k] + c[3].a[k] + 2) >> 2;
+                }
+                tex->setter(dst.texels, pf_texture2d_index_INTERNAL(&dst, x, y), result);
+            }
+        }
+    }
+
+    tex->num_mipmaps = num_levels;
+
+    return true;
+}
+
+float
+pf_texture2d_compute_lod(
+    const pf_texture2d_t* tex,
+    const pf_vec2_t duv_dx,
+    const pf_vec2_t duv_dy)
+{
+    float dx_u = duv_dx[0] * tex->w, dx_v = duv_dx[1] * tex->h;
+    float dy_u = duv_dy[0] * tex->w, dy_v = duv_dy[1] * tex->h;
+
+    float len_sq = PF_MAX(dx_u * dx_u + dx_v * dx_v, dy_u * dy_u + dy_v * dy_v);
+
+    // NOTE: Half of log2 of the squared length, avoiding the square root
+    return (len_sq > 0.0f) ? 0.5f * log2f(len_sq) : 0.0f;
+}
+
+pf_color_t
+pf_texture2d_sample_nearest_mip(
+    const pf_texture2d_t* tex,
+    float u, float v, float lod)
+{
+    if (lod < 0.5f || tex->num_mipmaps == 0) {
+        return tex->sampler(tex, u, v);
+    }
+
+    uint32_t level = PF_MIN((uint32_t)(lod + 0.5f), tex->num_mipmaps);
 
-    // Obtenir les couleurs des quatre pixels
-    pf_color_t c00 = tex->getter(tex->texels, y0 * tex->w + x0);
-    pf_color_t c10 = tex->getter(tex->texels, y0 * tex->w + x1);
-    pf_color_t c01 = tex->getter(tex->texels, y1 * tex->w + x0);
-    pf_color_t c11 = tex->getter(tex->texels, y1 * tex->w + x1);
+    pf_texture2d_t view;
+    pf_texture2d_level_INTERNAL(&view, tex, level);
 
-    // Interpoler les couleurs horizontalement
-    pf_color_t c0 = pf_color_lerpf(c00, c10, fx);
-    pf_color_t c1 = pf_color_lerpf(c01, c11, fx);
+    return view.sampler(&view, u, v);
+}
+
+pf_color_t
+pf_texture2d_sample_trilinear(
+    const pf_texture2d_t* tex,
+    float u, float v, float lod)
+{
+    if (lod <= 0.0f || tex->num_mipmaps == 0) {
+        return pf_texture2d_sample_bilinear(tex, u, v);
+    }
 
-    // Interpoler les couleurs verticalement
-    return pf_color_lerpf(c0, c1, fy);
+    if (lod >= tex->num_mipmaps) {
+        pf_texture2d_t view;
+        pf_texture2d_level_INTERNAL(&view, tex, tex->num_mipmaps);
+        return pf_texture2d_sample_bilinear(&view, u, v);
+    }
+
+    uint32_t level = (uint32_t)lod;
+    float t = lod - level;
+
+    pf_texture2d_t view;
+    pf_color_t c0;
+
+    if (level == 0) {
+        c0 = pf_texture2d_sample_bilinear(tex, u, v);
+    } else {
+        pf_texture2d_level_INTERNAL(&view, tex, level);
+        c0 = pf_texture2d_sample_bilinear(&view, u, v);
+    }
+
+    pf_texture2d_level_INTERNAL(&view, tex, level + 1);
+    pf_color_t c1 = pf_texture2d_sample_bilinear(&view, u, v);
+
+    return pf_color_lerpf(c0, c1, t);
 }
 
 
@@ -179,6 +999,72 @@ pf_texture2d_sample_bilinear(
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+/* Internal DDS Loading Functions */
+
+static inline uint32_t
+pfext_dds_read_u32_INTERNAL(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static pf_texture2d_t
+pfext_texture2d_load_dds_INTERNAL(
+    const uint8_t* data, size_t size)
+{
+    // NOTE: Only the first level of block-compressed DDS files is loaded, given by
+    //       their FourCC code or their DX10 header, the other formats go through stbi
+
+    pf_texture2d_t texture = { 0 };
+
+    if (size < 128 || pfext_dds_read_u32_INTERNAL(data + 4) != 124) {
+        fprintf(stderr, "ERROR: Invalid DDS header\n");
+        return texture;
+    }
+
+    uint32_t h = pfext_dds_read_u32_INTERNAL(data + 12);
+    uint32_t w = pfext_dds_read_u32_INTERNAL(data + 16);
+    const uint8_t* fourcc = data + 84;
+    size_t offset = 128;
+
+    pf_pixelformat_e format = PF_PIXELFORMAT_UNKNOWN;
+
+    if (memcmp(fourcc, "DXT1", 4) == 0) format = PF_PIXELFORMAT_BC1;
+    else if (memcmp(fourcc, "DXT5", 4) == 0) format = PF_PIXELFORMAT_BC3;
+    else if (memcmp(fourcc, "ATI1", 4) == 0 || memcmp(fourcc, "BC4U", 4) == 0) format = PF_PIXELFORMAT_BC4;
+    else if (memcmp(fourcc, "ATI2", 4) == 0 || memcmp(fourcc, "BC5U", 4) == 0) format = PF_PIXELFORMAT_BC5;
+    else if (memcmp(fourcc, "DX10", 4) == 0 && size >= 148) {
+        switch (pfext_dds_read_u32_INTERNAL(data + 128)) {
+            case 71: case 72: format = PF_PIXELFORMAT_BC1; break;   // BC1_UNORM(_SRGB)
+            case 77: case 78: format = PF_PIXELFORMAT_BC3; break;   // BC3_UNORM(_SRGB)
+            case 80: format = PF_PIXELFORMAT_BC4; break;            // BC4_UNORM
+            case 83: format = PF_PIXELFORMAT_BC5; break;            // BC5_UNORM
+            default: break;
+        }
+        offset = 148;
+    }
+
+    if (format == PF_PIXELFORMAT_UNKNOWN) {
+        fprintf(stderr, "ERROR: Unsupported DDS pixel format\n");
+        return texture;
+    }
+
+    size_t bytes = pf_pixel_get_image_bytes(format, w, h);
+
+    if (w == 0 || h == 0 || size - offset < bytes) {
+        fprintf(stderr, "ERROR: Truncated DDS file\n");
+        return texture;
+    }
+
+    void* texels = PF_MALLOC(bytes);
+    if (texels == NULL) return texture;
+
+    memcpy(texels, data + offset, bytes);
+
+    return pf_texture2d_create(texels, w, h, format);
+}
+
+/* Public API */
+
 pf_texture2d_t
 pfext_texture2d_load(
     const char* file_path)
@@ -186,6 +1072,30 @@ pfext_texture2d_load(
     pf_pixelformat_e format = PF_PIXELFORMAT_UNKNOWN;
     pf_texture2d_t texture = { 0 };
 
+    FILE* file = fopen(file_path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "ERROR: Unable to open '%s'\n", file_path);
+        return texture;
+    }
+
+    char magic[4] = { 0 };
+    bool dds = fread(magic, 1, 4, file) == 4 && memcmp(magic, "DDS ", 4) == 0;
+
+    if (dds) {
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        uint8_t* data = (size > 0) ? PF_MALLOC(size) : NULL;
+        if (data != NULL && fread(data, 1, size, file) == (size_t)size) {
+            texture = pfext_texture2d_load_dds_INTERNAL(data, size);
+        }
+        if (data != NULL) PF_FREE(data);
+        fclose(file);
+        return texture;
+    }
+
+    fclose(file);
+
     int w, h, comp;
     void* buffer = stbi_load(file_path, &w, &h, &comp, 0);
 
@@ -207,6 +1117,20 @@ pfext_texture2d_load(
     return texture;
 }
 
+pf_texture2d_t
+pfext_texture2d_load_ex(
+    const char* file_path,
+    bool premultiply)
+{
+    pf_texture2d_t texture = pfext_texture2d_load(file_path);
+
+    if (premultiply && texture.texels != NULL) {
+        pf_texture2d_premultiply(&texture);
+    }
+
+    return texture;
+}
+
 pf_texture2d_t
 pfext_texture2d_load_from_memory(
     const void* buffer, size_t size)
@@ -214,6 +1138,10 @@ pfext_texture2d_load_from_memory(
     pf_pixelformat_e format = PF_PIXELFORMAT_UNKNOWN;
     pf_texture2d_t texture = { 0 };
 
+    if (size >= 4 && memcmp(buffer, "DDS ", 4) == 0) {
+        return pfext_texture2d_load_dds_INTERNAL(buffer, size);
+    }
+
     int w, h, comp;
     void* img_data = stbi_load_from_memory(buffer, (int)size, &w, &h, &comp, 0);
 
@@ -241,7 +1169,7 @@ pfext_texture2d_gen_color(
     pf_color_t color, pf_pixelformat_e format)
 {
     pf_texture2d_t texture = { 0 };
-    if (format <= PF_PIXELFORMAT_UNKNOWN) return texture;
+    if (format <= PF_PIXELFORMAT_UNKNOWN || pf_pixel_is_compressed(format)) return texture;
 
     size_t size = w * h;
 
@@ -0,0 +1,382 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "pixelfactory/core/pf_texture_atlas.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+/* Internal Atlas Functions */
+
+static bool
+pf_texture_atlas_add_page_INTERNAL(
+    pf_texture_atlas_t* atlas)
+{
+    uint32_t page = atlas->num_pages;
+
+    if (page >= atlas->max_pages) {
+        return false;
+    }
+
+    // NOTE: The skyline has at most one node per aligned column
+    pf_texture_atlas_node_t* nodes = PF_MALLOC((atlas->w / atlas->alignment + 1) * sizeof(pf_texture_atlas_node_t));
+    void* texels = PF_CALLOC(1, pf_pixel_get_image_bytes(atlas->format, atlas->w, atlas->h));
+
+    if (nodes == NULL || texels == NULL) {
+        fprintf(stderr, "ERROR: Failed to allocate the page %u of the texture atlas\n", page);
+        if (nodes != NULL) PF_FREE(nodes);
+        if (texels != NULL) PF_FREE(texels);
+        return false;
+    }
+
+    nodes[0] = (pf_texture_atlas_node_t) { 0, 0, atlas->w };
+
+    atlas->pages[page] = pf_texture2d_create(texels, atlas->w, atlas->h, atlas->format);
+    atlas->skylines[page] = nodes;
+    atlas->num_nodes[page] = 1;
+    atlas->num_pages++;
+
+    return true;
+}
+
+static bool
+pf_texture_atlas_find_INTERNAL(
+    const pf_texture_atlas_t* atlas,
+    uint32_t page, uint32_t w, uint32_t h,
+    uint32_t* node, uint32_t* x, uint32_t* y)
+{
+    /*
+        Bottom-left skyline packing: the rectangle is tried on the left of each node, resting
+        on the highest node below it, and the position where its top is the lowest is kept.
+    */
+
+    const pf_texture_atlas_node_t* nodes = atlas->skylines[page];
+    const uint32_t num_nodes = atlas->num_nodes[page];
+
+    uint32_t best_top = UINT32_MAX;
+
+    for (uint32_t i = 0; i < num_nodes; ++i) {
+        uint32_t left = nodes[i].x;
+        if (left + w > atlas->w) break;
+
+        uint32_t top = 0;
+        for (uint32_t j = i; j < num_nodes && nodes[j].x < left + w; ++j) {
+            top = PF_MAX(top, nodes[j].y);
+        }
+
+        if (top + h <= atlas->h && top + h < best_top) {
+            best_top = top + h;
+            *node = i, *x = left, *y = top;
+        }
+    }
+
+    return best_top != UINT32_MAX;
+}
+
+static void
+pf_texture_atlas_insert_INTERNAL(
+    pf_texture_atlas_t* atlas,
+    uint32_t page, uint32_t node,
+    uint32_t x, uint32_t y,
+    uint32_t w, uint32_t h)
+{
+    pf_texture_atlas_node_t* nodes = atlas->skylines[page];
+    uint32_t num_nodes = atlas->num_nodes[page];
+
+    /* Cut the nodes covered by the new one, starting at 'node' */
+
+    uint32_t right = x + w;
+    uint32_t end = node;
+
+    while (end < num_nodes && nodes[end].x + nodes[end].w <= right) {
+        end++;
+    }
+
+    if (end < num_nodes && nodes[end].x < right) {
+        nodes[end].w -= right - nodes[end].x;
+        nodes[end].x = right;
+    }
+
+    /* Replace them by the new node */
+
+    memmove(nodes + node + 1, nodes + end, (num_nodes - end) * sizeof(pf_texture_atlas_node_t));
+    num_nodes -= end - node - 1;
+
+    nodes[node] = (pf_texture_atlas_node_t) { x, y + h, w };
+
+    /* Merge the neighbors at the same height */
+
+    uint32_t n = 0;
+    for (uint32_t i = 1; i < num_nodes; ++i) {
+        if (nodes[i].y == nodes[n].y) {
+            nodes[n].w += nodes[i].w;
+        } else {
+            nodes[++n] = nodes[i];
+        }
+    }
+
+    atlas->num_nodes[page] = n + 1;
+}
+
+static void
+pf_texture_atlas_copy_INTERNAL(
+    pf_texture2d_t* page,
+    const pf_texture2d_t* tex,
+    const int src_rect[4],
+    uint32_t x, uint32_t y,
+    uint32_t w, uint32_t h,
+    uint32_t padding)
+{
+    // NOTE: The whole cell is filled, the texels around the source
+    //       rectangle replicating its nearest edge
+
+    const int src_w = src_rect[2] - src_rect[0];
+    const int src_h = src_rect[3] - src_rect[1];
+
+    const bool direct = (tex->format == page->format
+        && tex->layout == PF_TEXTURE_LAYOUT_LINEAR
+        && page->layout == PF_TEXTURE_LAYOUT_LINEAR
+        && tex->getter != NULL);
+
+    const size_t bpp = pf_pixel_get_image_bytes(page->format, 1, 1);
+
+    for (uint32_t j = 0; j < h; ++j) {
+        int sy = src_rect[1] + PF_CLAMP((int)j - (int)padding, 0, src_h - 1);
+        size_t row = (size_t)(y + j) * page->w + x;
+
+        for (uint32_t i = 0; i < w; ++i) {
+            int dx = (int)i - (int)padding;
+
+            // NOTE: Whole rows of the source rectangle are copied at once when possible
+            if (direct && dx == 0) {
+                memcpy((uint8_t*)page->texels + (row + i) * bpp,
+                       (const uint8_t*)tex->texels + ((size_t)sy * tex->w + src_rect[0]) * bpp,
+                       src_w * bpp);
+                i += src_w - 1;
+                continue;
+            }
+
+            int sx = src_rect[0] + PF_CLAMP(dx, 0, src_w - 1);
+            page->setter(page->texels, pf_texture2d_get_index(page, x + i, y + j),
+                pf_texture2d_get_texel(tex, sx, sy));
+        }
+    }
+}
+
+static bool
+pf_texture_atlas_add_rect_INTERNAL(
+    pf_texture_atlas_t* atlas,
+    const pf_texture2d_t* tex,
+    const int src_rect[4],
+    pf_texture_atlas_region_t* region)
+{
+    const uint32_t src_w = src_rect[2] - src_rect[0];
+    const uint32_t src_h = src_rect[3] - src_rect[1];
+
+    const uint32_t align = atlas->alignment;
+    const uint32_t cell_w = (src_w + 2 * atlas->padding + align - 1) / align * align;
+    const uint32_t cell_h = (src_h + 2 * atlas->padding + align - 1) / align * align;
+
+    if (cell_w > atlas->w || cell_h > atlas->h) {
+        fprintf(stderr, "ERROR: Texture of %ux%u too large for the %ux%u atlas pages\n",
+            src_w, src_h, atlas->w, atlas->h);
+        return false;
+    }
+
+    /* Find a place in the current pages, or in a new one */
+
+    uint32_t page = 0, node = 0, x = 0, y = 0;
+
+    for (;; ++page) {
+        if (page == atlas->num_pages && !pf_texture_atlas_add_page_INTERNAL(atlas)) {
+            return false;
+        }
+        if (pf_texture_atlas_find_INTERNAL(atlas, page, cell_w, cell_h, &node, &x, &y)) {
+            break;
+        }
+    }
+
+    /* Reserve the cell and copy the texels */
+
+    pf_texture_atlas_insert_INTERNAL(atlas, page, node, x, y, cell_w, cell_h);
+    pf_texture_atlas_copy_INTERNAL(&atlas->pages[page], tex, src_rect, x, y, cell_w, cell_h, atlas->padding);
+
+    const int x1 = x + atlas->padding;
+    const int y1 = y + atlas->padding;
+
+    region->page = page;
+    region->rect[0] = x1;
+    region->rect[1] = y1;
+    region->rect[2] = x1 + src_w;
+    region->rect[3] = y1 + src_h;
+    region->uv[0] = (float)region->rect[0] / atlas->w;
+    region->uv[1] = (float)region->rect[1] / atlas->h;
+    region->uv[2] = (float)region->rect[2] / atlas->w;
+    region->uv[3] = (float)region->rect[3] / atlas->h;
+
+    return true;
+}
+
+/* Public API */
+
+pf_texture_atlas_t
+pf_texture_atlas_create(
+    uint32_t w, uint32_t h,
+    pf_pixelformat_e format,
+    uint32_t max_pages,
+    uint32_t padding,
+    uint32_t mip_levels)
+{
+    pf_texture_atlas_t atlas = { 0 };
+
+    if (pf_pixel_is_compressed(format)) {
+        fprintf(stderr, "ERROR: Texture atlases cannot use compressed formats\n");
+        return atlas;
+    }
+
+    if (mip_levels >= 16 || w == 0 || h == 0 || w % (1u << mip_levels) || h % (1u << mip_levels)) {
+        fprintf(stderr, "ERROR: The size of the atlas pages must be a multiple of 2^%u\n", mip_levels);
+        return atlas;
+    }
+
+    atlas.max_pages = PF_CLAMP(max_pages, 1, PF_TEXTURE_ATLAS_MAX_PAGES);
+    atlas.w = w;
+    atlas.h = h;
+    atlas.padding = padding;
+    atlas.alignment = 1u << mip_levels;
+    atlas.format = format;
+
+    if (!pf_texture_atlas_add_page_INTERNAL(&atlas)) {
+        return (pf_texture_atlas_t) { 0 };
+    }
+
+    return atlas;
+}
+
+void
+pf_texture_atlas_delete(
+    pf_texture_atlas_t* atlas)
+{
+    for (uint32_t i = 0; i < atlas->num_pages; ++i) {
+        pf_texture2d_delete(&atlas->pages[i]);
+        PF_FREE(atlas->skylines[i]);
+    }
+    *atlas = (pf_texture_atlas_t) { 0 };
+}
+
+void
+pf_texture_atlas_clear(
+    pf_texture_atlas_t* atlas)
+{
+    size_t size = pf_pixel_get_image_bytes(atlas->format, atlas->w, atlas->h);
+
+    for (uint32_t i = 0; i < atlas->num_pages; ++i) {
+        memset(atlas->pages[i].texels, 0, size);
+        atlas->skylines[i][0] = (pf_texture_atlas_node_t) { 0, 0, atlas->w };
+        atlas->num_nodes[i] = 1;
+    }
+}
+
+bool
+pf_texture_atlas_add(
+    pf_texture_atlas_t* atlas,
+    const pf_texture2d_t* tex,
+    const int* src_rect,
+    pf_texture_atlas_region_t* region)
+{
+    if (atlas->num_pages == 0 || tex->texels == NULL) {
+        return false;
+    }
+
+    int rect[4] = { 0, 0, (int)tex->w, (int)tex->h };
+
+    if (src_rect != NULL) {
+        rect[0] = PF_CLAMP(PF_MIN(src_rect[0], src_rect[2]), 0, (int)tex->w);
+        rect[1] = PF_CLAMP(PF_MIN(src_rect[1], src_rect[3]), 0, (int)tex->h);
+        rect[2] = PF_CLAMP(PF_MAX(src_rect[0], src_rect[2]), 0, (int)tex->w);
+        rect[3] = PF_CLAMP(PF_MAX(src_rect[1], src_rect[3]), 0, (int)tex->h);
+    }
+
+    if (rect[0] >= rect[2] || rect[1] >= rect[3]) {
+        return false;
+    }
+
+    return pf_texture_atlas_add_rect_INTERNAL(atlas, tex, rect, region);
+}
+
+bool
+pf_texture_atlas_add_pixels(
+    pf_texture_atlas_t* atlas,
+    const void* pixels,
+    uint32_t w, uint32_t h,
+    pf_pixelformat_e format,
+    pf_texture_atlas_region_t* region)
+{
+    // NOTE: The texture only wraps the pixels to read them, it is not deleted
+    pf_texture2d_t tex = pf_texture2d_create((void*)pixels, w, h, format);
+    return pf_texture_atlas_add(atlas, &tex, NULL, region);
+}
+
+static int
+pf_texture_atlas_compare_INTERNAL(
+    const void* a,
+    const void* b)
+{
+    // NOTE: Sorts {height, index} pairs by decreasing height, then by index
+    const size_t* pa = a;
+    const size_t* pb = b;
+
+    if (pa[0] != pb[0]) {
+        return (pa[0] > pb[0]) ? -1 : 1;
+    }
+    return (pa[1] < pb[1]) ? -1 : (pa[1] > pb[1]);
+}
+
+size_t
+pf_texture_atlas_add_batch(
+    pf_texture_atlas_t* atlas,
+    const pf_texture2d_t* textures,
+    size_t count,
+    pf_texture_atlas_region_t* regions)
+{
+    size_t* order = PF_MALLOC(2 * count * sizeof(size_t));
+    if (order == NULL) return 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        order[2 * i + 0] = textures[i].h;
+        order[2 * i + 1] = i;
+    }
+
+    qsort(order, count, 2 * sizeof(size_t), pf_texture_atlas_compare_INTERNAL);
+
+    size_t num_packed = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t index = order[2 * i + 1];
+        if (pf_texture_atlas_add(atlas, &textures[index], NULL, &regions[index])) {
+            num_packed++;
+        } else {
+            regions[index] = (pf_texture_atlas_region_t) { 0 };
+        }
+    }
+
+    PF_FREE(order);
+
+    return num_packed;
+}
@@ -1,4 +1,124 @@
 #include "pixelfactory/core/pf_vertexbuffer.h"
+#include "pixelfactory/math/pf_vec3.h"
+#include <float.h>
+#include <stdio.h>
+
+#ifdef _OPENMP
+#   include <omp.h>
+#endif //_OPENMP
+
+#if defined(_WIN32)
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <windows.h>
+#else
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+/* Internal File Mapping Functions */
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    uint32_t refs;
+} pf_mapping_INTERNAL_t;
+
+#ifdef PF_EXT_VERTEXBUFFER
+
+static pf_mapping_INTERNAL_t*
+pf_mapping_open_INTERNAL(
+    const char* file_path)
+{
+    // NOTE: The file is mapped copy-on-write, so that the data can be modified in place
+    //       (e.g. by 'pfext_vertexbuffer_optimize') without ever altering the file
+
+    uint8_t* data = NULL;
+    size_t size = 0;
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(file_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        HANDLE map = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        if (map != NULL) {
+            data = MapViewOfFile(map, FILE_MAP_COPY, 0, 0, 0);
+            size = (size_t)file_size.QuadPart;
+            CloseHandle(map);
+        }
+    }
+
+    CloseHandle(file);
+#else
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        size = (size_t)st.st_size;
+        if (data == MAP_FAILED) data = NULL;
+    }
+
+    close(fd);
+#endif
+
+    if (data == NULL) {
+        return NULL;
+    }
+
+    pf_mapping_INTERNAL_t* mapping = PF_MALLOC(sizeof(pf_mapping_INTERNAL_t));
+    if (mapping == NULL) {
+#if defined(_WIN32)
+        UnmapViewOfFile(data);
+#else
+        munmap(data, size);
+#endif
+        return NULL;
+    }
+
+    mapping->data = data;
+    mapping->size = size;
+    mapping->refs = 1;
+
+    return mapping;
+}
+
+#endif //PF_EXT_VERTEXBUFFER
+
+static void
+pf_mapping_release_INTERNAL(
+    pf_mapping_INTERNAL_t* mapping)
+{
+    if (--mapping->refs > 0) {
+        return;
+    }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(mapping->data);
+#else
+    munmap(mapping->data, mapping->size);
+#endif
+
+    PF_FREE(mapping);
+}
+
+static bool
+pf_mapping_contains_INTERNAL(
+    const pf_mapping_INTERNAL_t* mapping,
+    const void* ptr)
+{
+    const uint8_t* p = ptr;
+    return mapping != NULL && p >= mapping->data && p < mapping->data + mapping->size;
+}
 
 /* Helper Vertex Buffer Functions */
 
@@ -91,23 +211,539 @@ void
 pf_vertexbuffer_delete(
     pf_vertexbuffer_t* vb)
 {
+    pf_mapping_INTERNAL_t* mapping = vb->mapping;
+
     for (int i = 0; i < PF_MAX_ATTRIBUTES; ++i) {
-        if (vb->attributes[i].buffer != NULL) {
-            PF_FREE(vb->attributes[i].buffer);
+        void* buffer = vb->attributes[i].buffer;
+        if (buffer == NULL || pf_mapping_contains_INTERNAL(mapping, buffer)) continue;
+
+        // NOTE: Interleaved attributes share the same buffer
+        bool shared = false;
+        for (int j = 0; j < i; ++j) {
+            if (vb->attributes[j].buffer == buffer) {
+                shared = true;
+                break;
+            }
+        }
+
+        if (!shared) {
+            PF_FREE(buffer);
         }
     }
+    if (vb->indices != NULL && !pf_mapping_contains_INTERNAL(mapping, vb->indices)) {
+        PF_FREE(vb->indices);
+    }
+    if (mapping != NULL) {
+        pf_mapping_release_INTERNAL(mapping);
+    }
     *vb = (pf_vertexbuffer_t) { 0 };
 }
 
 
+
+/* Internal Assembly Functions */
+
+/*
+    Assembly of the triangles of a vertex buffer, shared by the 2D and 3D draw paths.
+    The vertices are kept by the caller in three slots, strips and fans reusing the
+    last two vertices for each new triangle, and the primitive restart index starts
+    a new strip or fan. 'count' is the number of vertices since the last restart.
+*/
+
+// NOTE: Returns false for the restart index, which must be skipped, otherwise
+//       'slot' receives the slot where the new vertex must be stored
+bool
+pf_vertexbuffer_assemble_slot_INTERNAL(
+    const pf_vertexbuffer_t* vb, uint32_t* count,
+    uint32_t index, uint32_t* slot)
+{
+    if (vb->indices != NULL && vb->primitive_restart && index == PF_PRIMITIVE_RESTART_INDEX) {
+        *count = 0;
+        return false;
+    }
+
+    *slot = *count % 3;
+    if (vb->topology == PF_TRIANGLE_FAN) {
+        *slot = (*count == 0) ? 0 : 1 + ((*count - 1) & 1);
+    }
+
+    return true;
+}
+
+// NOTE: Counts the vertex stored in 'slot', returns true if a triangle is complete,
+//       'tri' then receiving the slots of its vertices in winding order
+bool
+pf_vertexbuffer_assemble_push_INTERNAL(
+    const pf_vertexbuffer_t* vb, uint32_t* count,
+    uint32_t slot, uint32_t tri[3])
+{
+    uint32_t n = ++(*count);
+
+    switch (vb->topology) {
+        case PF_TRIANGLE_STRIP:
+            if (n >= 3) {
+                // NOTE: Odd triangles of a strip swap their first two vertices to keep the winding order
+                tri[0] = (n - 3) % 3, tri[1] = (n - 2) % 3, tri[2] = slot;
+                if ((n & 1) == 0) PF_SWAP(tri[0], tri[1]);
+                return true;
+            }
+            break;
+        case PF_TRIANGLE_FAN:
+            if (n >= 3) {
+                tri[0] = 0, tri[1] = 3 - slot, tri[2] = slot;
+                return true;
+            }
+            break;
+        case PF_TRIANGLES:
+        default:
+            if (n % 3 == 0) {
+                tri[0] = 0, tri[1] = 1, tri[2] = 2;
+                return true;
+            }
+            break;
+    }
+
+    return false;
+}
+
+/* Level Of Detail Functions */
+
+typedef struct {
+    // NOTE: Symmetric 4x4 matrix of the quadric error, upper triangle only
+    float a00, a01, a02, a03;
+    float a11, a12, a13;
+    float a22, a23;
+    float a33;
+} pf_quadric_INTERNAL_t;
+
+typedef struct {
+    uint32_t u;     // Vertex removed by the collapse
+    uint32_t v;     // Vertex receiving the triangles of 'u'
+    float cost;
+} pf_collapse_INTERNAL_t;
+
+static int
+pf_collapse_compare_INTERNAL(const void* a, const void* b)
+{
+    float ca = ((const pf_collapse_INTERNAL_t*)a)->cost;
+    float cb = ((const pf_collapse_INTERNAL_t*)b)->cost;
+    return (ca > cb) - (ca < cb);
+}
+
+static int
+pf_edge_compare_INTERNAL(const void* a, const void* b)
+{
+    uint32_t ea = *(const uint32_t*)a;
+    uint32_t eb = *(const uint32_t*)b;
+    return (ea > eb) - (ea < eb);
+}
+
+static void
+pf_quadric_add_plane_INTERNAL(
+    pf_quadric_INTERNAL_t* q,
+    const pf_vec3_t n, float d, float w)
+{
+    q->a00 += w * n[0] * n[0]; q->a01 += w * n[0] * n[1]; q->a02 += w * n[0] * n[2]; q->a03 += w * n[0] * d;
+    q->a11 += w * n[1] * n[1]; q->a12 += w * n[1] * n[2]; q->a13 += w * n[1] * d;
+    q->a22 += w * n[2] * n[2]; q->a23 += w * n[2] * d;
+    q->a33 += w * d * d;
+}
+
+static void
+pf_quadric_add_INTERNAL(
+    pf_quadric_INTERNAL_t* dst,
+    const pf_quadric_INTERNAL_t* q)
+{
+    float* a = (float*)dst;
+    const float* b = (const float*)q;
+    for (int_fast8_t i = 0; i < 10; ++i) {
+        a[i] += b[i];
+    }
+}
+
+static float
+pf_quadric_error_INTERNAL(
+    const pf_quadric_INTERNAL_t* q1,
+    const pf_quadric_INTERNAL_t* q2,
+    const float* p)
+{
+    pf_quadric_INTERNAL_t q = *q1;
+    pf_quadric_add_INTERNAL(&q, q2);
+
+    float x = p[0], y = p[1], z = p[2];
+
+    float error = x * x * q.a00 + 2 * x * y * q.a01 + 2 * x * z * q.a02 + 2 * x * q.a03
+                + y * y * q.a11 + 2 * y * z * q.a12 + 2 * y * q.a13
+                + z * z * q.a22 + 2 * z * q.a23
+                + q.a33;
+
+    return fabsf(error);
+}
+
+static void
+pf_triangle_normal_INTERNAL(
+    pf_vec3_t n, const float* p1, const float* p2, const float* p3)
+{
+    pf_vec3_t e1, e2;
+    pf_vec3_sub(e1, p2, p1);
+    pf_vec3_sub(e2, p3, p1);
+    pf_vec3_cross(n, e1, e2);
+}
+
+static bool
+pf_collapse_flips_INTERNAL(
+    const float* points, size_t stride,
+    const uint16_t* indices, const uint32_t* offsets, const uint32_t* adjacency,
+    uint32_t u, uint32_t v)
+{
+    /*
+        Check if moving 'u' onto 'v' would flip (or collapse to
+        a sliver) one of the triangles that remain around 'u'
+    */
+
+    for (uint32_t a = offsets[u]; a < offsets[u + 1]; ++a) {
+        const uint16_t* tri = indices + 3 * adjacency[a];
+        if (tri[0] == v || tri[1] == v || tri[2] == v) continue;
+
+        const float* p[3];
+        const float* q[3];
+
+        for (int_fast8_t k = 0; k < 3; ++k) {
+            p[k] = points + tri[k] * stride;
+            q[k] = (tri[k] == u) ? points + v * stride : p[k];
+        }
+
+        pf_vec3_t n0, n1;
+        pf_triangle_normal_INTERNAL(n0, p[0], p[1], p[2]);
+        pf_triangle_normal_INTERNAL(n1, q[0], q[1], q[2]);
+
+        float d = pf_vec3_dot(n0, n1);
+        if (d <= 0.25f * pf_vec3_len(n0) * pf_vec3_len(n1)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool
+pf_vertexbuffer_check_lod_INTERNAL(
+    const pf_vertexbuffer_t* vb,
+    const char* operation)
+{
+    const pf_attribute_t* positions = &vb->attributes[PF_ATTRIB_POSITION];
+    if (vb->indices == NULL || !positions->used || positions->type != PF_ATTRIB_FLOAT || positions->comp < 3) {
+        fprintf(stderr, "ERROR: %s requires an indexed vertex buffer with 3D float positions\n", operation);
+        return false;
+    }
+
+    if (vb->topology != PF_TRIANGLES || vb->primitive_restart) {
+        fprintf(stderr, "ERROR: %s is only supported for triangle lists\n", operation);
+        return false;
+    }
+
+    return true;
+}
+
+uint16_t*
+pf_vertexbuffer_simplify(
+    const pf_vertexbuffer_t* vb,
+    uint32_t target_num_indices,
+    uint32_t* out_num_indices)
+{
+    /*
+        Quadric error metrics simplification (Garland & Heckbert, 1997)
+        Edges are collapsed onto one of their endpoints, so that the vertices of the
+        buffer are preserved and only a new index buffer is produced. Vertices on the
+        border of the mesh (including attribute seams) are locked to keep the silhouette.
+        Collapses are done by passes, choosing the cheapest independent collapses of each pass.
+    */
+
+    *out_num_indices = 0;
+
+    if (!pf_vertexbuffer_check_lod_INTERNAL(vb, "Simplification")) {
+        return NULL;
+    }
+
+    const pf_attribute_t* positions = &vb->attributes[PF_ATTRIB_POSITION];
+    const float* points = pf_attribute_get_elem_ptr(positions, 0);
+    const size_t stride = pf_attribute_get_stride(positions) / sizeof(float);
+    const uint32_t num_vertices = vb->num_vertices;
+
+    uint32_t num_indices = vb->num_indices - vb->num_indices % 3;
+    target_num_indices -= target_num_indices % 3;
+
+    uint16_t* result = PF_MALLOC(num_indices * sizeof(uint16_t));
+    pf_quadric_INTERNAL_t* quadrics = PF_CALLOC(num_vertices, sizeof(pf_quadric_INTERNAL_t));
+    bool* locked = PF_CALLOC(num_vertices, sizeof(bool));
+    bool* touched = PF_MALLOC(num_vertices * sizeof(bool));
+    uint32_t* remap = PF_MALLOC(num_vertices * sizeof(uint32_t));
+    uint32_t* offsets = PF_MALLOC((num_vertices + 1) * sizeof(uint32_t));
+    uint32_t* adjacency = PF_MALLOC(num_indices * sizeof(uint32_t));
+    uint32_t* edges = PF_MALLOC(num_indices * sizeof(uint32_t));
+    pf_collapse_INTERNAL_t* collapses = PF_MALLOC(2 * num_indices * sizeof(pf_collapse_INTERNAL_t));
+
+    if (!result || !quadrics || !locked || !touched || !remap || !offsets || !adjacency || !edges || !collapses) {
+        fprintf(stderr, "ERROR: Unable to allocate memory for mesh simplification\n");
+        PF_FREE(result);
+        result = NULL;
+        goto finish;
+    }
+
+    for (uint32_t i = 0; i < num_indices; ++i) {
+        if (vb->indices[i] >= num_vertices) {
+            fprintf(stderr, "ERROR: Unable to simplify vertex buffer, index out of range\n");
+            PF_FREE(result);
+            result = NULL;
+            goto finish;
+        }
+        result[i] = vb->indices[i];
+    }
+
+    /* Compute the quadric of each vertex from its area weighted triangle planes */
+
+    for (uint32_t i = 0; i < num_indices; i += 3) {
+        const float* p1 = points + result[i + 0] * stride;
+        const float* p2 = points + result[i + 1] * stride;
+        const float* p3 = points + result[i + 2] * stride;
+
+        pf_vec3_t n;
+        pf_triangle_normal_INTERNAL(n, p1, p2, p3);
+
+        float area = pf_vec3_len(n);
+        if (area == 0.0f) continue;
+
+        pf_vec3_scale(n, n, 1.0f / area);
+        float d = -pf_vec3_dot(n, p1);
+
+        for (int_fast8_t k = 0; k < 3; ++k) {
+            pf_quadric_add_plane_INTERNAL(&quadrics[result[i + k]], n, d, area);
+        }
+    }
+
+    /* Lock the vertices on border edges, ie. edges used by only one triangle */
+
+    for (uint32_t i = 0; i < num_indices; ++i) {
+        uint32_t a = result[i];
+        uint32_t b = result[i - i % 3 + (i + 1) % 3];
+        edges[i] = (PF_MIN(a, b) << 16) | PF_MAX(a, b);
+    }
+
+    qsort(edges, num_indices, sizeof(uint32_t), pf_edge_compare_INTERNAL);
+
+    for (uint32_t i = 0; i < num_indices;) {
+        uint32_t j = i + 1;
+        while (j < num_indices && edges[j] == edges[i]) ++j;
+        if (j - i == 1) {
+            locked[edges[i] >> 16] = true;
+            locked[edges[i] & 0xFFFF] = true;
+        }
+        i = j;
+    }
+
+    /* Collapse edges by passes until the target is reached */
+
+    while (num_indices > target_num_indices) {
+
+        // Build the vertex to triangles adjacency of the current indices
+        memset(offsets, 0, (num_vertices + 1) * sizeof(uint32_t));
+        for (uint32_t i = 0; i < num_indices; ++i) {
+            offsets[result[i] + 1]++;
+        }
+        for (uint32_t v = 0; v < num_vertices; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+        for (uint32_t i = 0; i < num_indices; ++i) {
+            adjacency[offsets[result[i]]++] = i / 3;
+        }
+        for (uint32_t v = num_vertices; v > 0; --v) {
+            offsets[v] = offsets[v - 1];
+        }
+        offsets[0] = 0;
+
+        // List every possible collapse with its cost
+        uint32_t num_collapses = 0;
+        for (uint32_t i = 0; i < num_indices; ++i) {
+            uint32_t a = result[i];
+            uint32_t b = result[i - i % 3 + (i + 1) % 3];
+            if (!locked[a]) {
+                collapses[num_collapses++] = (pf_collapse_INTERNAL_t) {
+                    a, b, pf_quadric_error_INTERNAL(&quadrics[a], &quadrics[b], points + b * stride)
+                };
+            }
+            if (!locked[b]) {
+                collapses[num_collapses++] = (pf_collapse_INTERNAL_t) {
+                    b, a, pf_quadric_error_INTERNAL(&quadrics[a], &quadrics[b], points + a * stride)
+                };
+            }
+        }
+
+        qsort(collapses, num_collapses, sizeof(pf_collapse_INTERNAL_t), pf_collapse_compare_INTERNAL);
+
+        // Apply the cheapest collapses that don't share any triangle
+        for (uint32_t v = 0; v < num_vertices; ++v) {
+            remap[v] = v;
+            touched[v] = false;
+        }
+
+        uint32_t goal = (num_indices - target_num_indices) / 3;
+        uint32_t removed = 0;
+        uint32_t applied = 0;
+
+        for (uint32_t c = 0; c < num_collapses && removed < goal; ++c) {
+            uint32_t u = collapses[c].u;
+            uint32_t v = collapses[c].v;
+
+            if (touched[u] || touched[v]) continue;
+            if (pf_collapse_flips_INTERNAL(points, stride, result, offsets, adjacency, u, v)) continue;
+
+            remap[u] = v;
+            pf_quadric_add_INTERNAL(&quadrics[v], &quadrics[u]);
+
+            for (uint32_t a = offsets[u]; a < offsets[u + 1]; ++a) {
+                const uint16_t* tri = result + 3 * adjacency[a];
+                if (tri[0] == v || tri[1] == v || tri[2] == v) removed++;
+                touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = true;
+            }
+
+            applied++;
+        }
+
+        if (applied == 0) {
+            break;
+        }
+
+        // Rewrite the indices and remove the degenerate triangles
+        uint32_t write = 0;
+        for (uint32_t i = 0; i < num_indices; i += 3) {
+            uint16_t a = (uint16_t)remap[result[i + 0]];
+            uint16_t b = (uint16_t)remap[result[i + 1]];
+            uint16_t c = (uint16_t)remap[result[i + 2]];
+            if (a == b || b == c || c == a) continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+
+        num_indices = write;
+    }
+
+    *out_num_indices = num_indices;
+
+finish:
+    PF_FREE(quadrics);
+    PF_FREE(locked);
+    PF_FREE(touched);
+    PF_FREE(remap);
+    PF_FREE(offsets);
+    PF_FREE(adjacency);
+    PF_FREE(edges);
+    PF_FREE(collapses);
+
+    return result;
+}
+
+pf_vertexbuffer_lod_t
+pf_vertexbuffer_lod_create(
+    const pf_vertexbuffer_t* vb,
+    uint32_t num_levels,
+    float reduction)
+{
+    pf_vertexbuffer_lod_t lod = { 0 };
+
+    if (!pf_vertexbuffer_check_lod_INTERNAL(vb, "LOD chain generation")) {
+        return lod;
+    }
+
+    num_levels = PF_CLAMP(num_levels, 1, PF_MAX_LOD_LEVELS);
+    reduction = PF_CLAMP(reduction, 0.05f, 0.95f);
+
+    /* Compute the bounding sphere of the mesh */
+
+    const pf_attribute_t* positions = &vb->attributes[PF_ATTRIB_POSITION];
+    const float* points = pf_attribute_get_elem_ptr(positions, 0);
+    const size_t stride = pf_attribute_get_stride(positions) / sizeof(float);
+
+    pf_vec3_t min = { FLT_MAX, FLT_MAX, FLT_MAX };
+    pf_vec3_t max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    for (uint32_t i = 0; i < vb->num_vertices; ++i) {
+        for (int_fast8_t j = 0; j < PF_MIN(positions->comp, 3); ++j) {
+            min[j] = PF_MIN(min[j], points[i * stride + j]);
+            max[j] = PF_MAX(max[j], points[i * stride + j]);
+        }
+    }
+
+    for (int_fast8_t j = 0; j < 3; ++j) {
+        lod.center[j] = (positions->comp > j) ? 0.5f * (min[j] + max[j]) : 0.0f;
+    }
+
+    for (uint32_t i = 0; i < vb->num_vertices; ++i) {
+        pf_vec3_t p = { 0 };
+        for (int_fast8_t j = 0; j < PF_MIN(positions->comp, 3); ++j) {
+            p[j] = points[i * stride + j];
+        }
+        lod.radius = PF_MAX(lod.radius, pf_vec3_distance(p, lod.center));
+    }
+
+    /* The first level is the original index buffer */
+
+    lod.indices[0] = vb->indices;
+    lod.num_indices[0] = vb->num_indices;
+    lod.num_levels = 1;
+
+    /* Each following level is simplified from the previous one */
+
+    pf_vertexbuffer_t level = *vb;
+
+    for (uint32_t i = 1; i < num_levels; ++i) {
+        level.indices = lod.indices[i - 1];
+        level.num_indices = lod.num_indices[i - 1];
+
+        uint32_t target = (uint32_t)(level.num_indices * reduction);
+        uint32_t count = 0;
+
+        uint16_t* indices = pf_vertexbuffer_simplify(&level, target, &count);
+        if (indices == NULL) break;
+
+        // NOTE: Stop the chain when the simplification no longer makes significant progress
+        if (count == 0 || count > 0.95f * level.num_indices) {
+            PF_FREE(indices);
+            break;
+        }
+
+        lod.indices[i] = indices;
+        lod.num_indices[i] = count;
+        lod.num_levels++;
+    }
+
+    return lod;
+}
+
+void
+pf_vertexbuffer_lod_delete(
+    pf_vertexbuffer_lod_t* lod)
+{
+    pf_mapping_INTERNAL_t* mapping = lod->mapping;
+
+    // NOTE: The first level belongs to the vertex buffer
+    for (uint32_t i = 1; i < lod->num_levels; ++i) {
+        if (!pf_mapping_contains_INTERNAL(mapping, lod->indices[i])) {
+            PF_FREE(lod->indices[i]);
+        }
+    }
+    if (mapping != NULL) {
+        pf_mapping_release_INTERNAL(mapping);
+    }
+    *lod = (pf_vertexbuffer_lod_t) { 0 };
+}
+
+
 /* VERTEX BUFFER EXTENSION */
 
 
 #ifdef PF_EXT_VERTEXBUFFER
 
-#define TINYOBJ_LOADER_C_IMPLEMENTATION
-#include "tinyobj_loader_c.h"
-
 #define CGLTF_IMPLEMENTATION
 #include "cgltf.h"
 
@@ -117,282 +753,1363 @@ DIAGNOSTIC_IGNORE_UNUSED_PARAMETER
 #   include "par_shapes.h"
 DIAGNOSTIC_POP
 
-static void
-pfext_objloader_file_reader_INTERNAL(
-    void *ctx, const char *filename,
-    int is_mtl, const char *obj_filename,
-    char **buf, size_t *len)
-{
-    (void)obj_filename;
-    (void)is_mtl;
-    (void)ctx;
-
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        *buf = NULL;
-        *len = 0;
-        return;
-    }
+/* Internal Validation Functions */
 
-    fseek(file, 0, SEEK_END);
-    *len = ftell(file);
-    fseek(file, 0, SEEK_SET);
+static bool
+pfext_check_indices_INTERNAL(
+    const uint16_t* indices, uint64_t count,
+    uint64_t num_vertices, bool restart)
+{
+    // NOTE: Every index must refer to a vertex, except the restart index when enabled
 
-    *buf = (char *)PF_MALLOC(*len);
-    if (*buf == NULL) {
-        fclose(file);
-        *len = 0;
-        return;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (indices[i] >= num_vertices && !(restart && indices[i] == PF_PRIMITIVE_RESTART_INDEX)) {
+            return false;
+        }
     }
+    return true;
+}
 
-    int r = fread(*buf, 1, *len, file);
-    (void)r;
+/* Internal OBJ Loading Functions */
+
+/*
+    The file is read by blocks of 'PF_OBJ_BLOCK_SIZE' bytes, only the complete lines of
+    a block being parsed, and each block is split at line boundaries into one chunk
+    per thread. A first pass counts the elements of each chunk so that the second one
+    can parse them in parallel directly at their final place, the relative indices
+    being resolved on the fly. The corners of the faces are finally deduplicated in
+    parallel, each thread owning the (v, vt, vn) triplets of one hash partition.
+*/
+
+#define PFEXT_OBJ_ABSENT UINT32_MAX
+#define PFEXT_OBJ_INVALID (UINT32_MAX - 1)
+
+typedef struct {
+    uint32_t v, vt, vn;
+} pfext_obj_corner_INTERNAL_t;
+
+typedef struct {
+    size_t num_positions;
+    size_t num_texcoords;
+    size_t num_normals;
+    size_t num_corners;
+} pfext_obj_counts_INTERNAL_t;
+
+typedef struct {
+    float* positions;
+    float* texcoords;
+    float* normals;
+    pfext_obj_corner_INTERNAL_t* corners;
+    pfext_obj_counts_INTERNAL_t count;
+    pfext_obj_counts_INTERNAL_t capacity;
+} pfext_obj_data_INTERNAL_t;
+
+static inline bool
+pfext_obj_is_space_INTERNAL(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
 
-    fclose(file);
+static inline const char*
+pfext_obj_skip_spaces_INTERNAL(const char* p, const char* end)
+{
+    while (p < end && pfext_obj_is_space_INTERNAL(*p)) ++p;
+    return p;
 }
 
-pf_vertexbuffer_t
-pfext_vertexbuffer_load_obj(
-    const char* file_path,
-    bool triangulate)
+static inline const char*
+pfext_obj_skip_token_INTERNAL(const char* p, const char* end)
+{
+    while (p < end && !pfext_obj_is_space_INTERNAL(*p)) ++p;
+    return p;
+}
+
+static const char*
+pfext_obj_parse_float_INTERNAL(const char* p, const char* end, float* out)
 {
-    pf_vertexbuffer_t vertexbuffer = { 0 };
+    // NOTE: Up to 19 significant digits are kept, which is exact once rounded to a float
 
-    // Initialize variables for tinyobj
-    tinyobj_attrib_t attrib;
-    tinyobj_shape_t* shapes = NULL;
-    size_t num_shapes;
-    tinyobj_material_t* materials = NULL;
-    size_t num_materials;
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
 
-    // Open the OBJ file
-    FILE *file = fopen(file_path, "r");
-    if (!file) {
-        fprintf(stderr, "ERROR: Unable to load file [%s]\n", file_path);
-        return vertexbuffer;
-    }
-
-    // Load the OBJ file
-    int result = tinyobj_parse_obj(
-        &attrib, &shapes, &num_shapes,
-        &materials, &num_materials, file_path,
-        pfext_objloader_file_reader_INTERNAL, file,
-        triangulate ? TINYOBJ_FLAG_TRIANGULATE : 0);
-
-    if (result != TINYOBJ_SUCCESS) {
-        fprintf(stderr, "ERROR: Unable to load OBJ mesh [%s]\n", file_path);
-        fclose(file);
-        return vertexbuffer;
-    }
-
-    // Define the number of vertices and indices
-    vertexbuffer.num_vertices = attrib.num_vertices / 3;
-    vertexbuffer.num_indices = attrib.num_face_num_verts;
-
-    // Load vertex positions
-    pf_attribute_t* position_attr = &vertexbuffer.attributes[PF_ATTRIB_POSITION];
-    position_attr->type = PF_ATTRIB_FLOAT;
-    position_attr->comp = 3; // x, y, z
-    position_attr->size = vertexbuffer.num_vertices * 3 * sizeof(float);
-    position_attr->buffer = PF_MALLOC(position_attr->size);
-    if (position_attr->buffer == NULL) {
-        fprintf(stderr, "ERROR: Unable to allocate memory for vertex positions\n");
-        goto finish;
+    p = pfext_obj_skip_spaces_INTERNAL(p, end);
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p++ == '-');
     }
-    memcpy(position_attr->buffer, attrib.vertices, position_attr->size);
-    position_attr->used = true;
-
-    // Load texture coordinates, if present
-    if (attrib.num_texcoords > 0) {
-        pf_attribute_t* texcoord_attr = &vertexbuffer.attributes[PF_ATTRIB_TEXCOORD];
-        texcoord_attr->type = PF_ATTRIB_FLOAT;
-        texcoord_attr->comp = 2; // u, v
-        texcoord_attr->size = vertexbuffer.num_vertices * 2 * sizeof(float);
-        texcoord_attr->buffer = PF_MALLOC(texcoord_attr->size);
-        if (texcoord_attr->buffer == NULL) {
-            fprintf(stderr, "ERROR: Unable to allocate memory for texture coordinates\n");
-            goto finish;
+
+    uint64_t mantissa = 0;
+    int exponent = 0, digits = 0;
+
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += (mantissa > 0);
+        } else {
+            ++exponent;
+        }
+    }
+
+    if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += (mantissa > 0);
+                --exponent;
+            }
+        }
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        bool exp_negative = false;
+        if (++p < end && (*p == '-' || *p == '+')) {
+            exp_negative = (*p++ == '-');
         }
-        memcpy(texcoord_attr->buffer, attrib.texcoords, texcoord_attr->size);
-        texcoord_attr->used = true;
+        int value = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+            if (value < 10000) value = value * 10 + (*p - '0');
+        }
+        exponent += exp_negative ? -value : value;
+    }
+
+    double value = (double)mantissa;
+
+    if (exponent < 0) {
+        value = (exponent >= -22) ? value / powers[-exponent] : value * pow(10.0, exponent);
+    } else if (exponent > 0) {
+        value = (exponent <= 22) ? value * powers[exponent] : value * pow(10.0, exponent);
+    }
+
+    *out = (float)(negative ? -value : value);
+
+    return p;
+}
+
+static const char*
+pfext_obj_parse_index_INTERNAL(const char* p, const char* end, size_t count, uint32_t* out)
+{
+    // NOTE: OBJ indices start at one, negative ones are relative to the
+    //       number of elements defined so far ('count')
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p++ == '-');
+    }
+
+    uint64_t value = 0;
+    bool valid = false;
+
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        if (value <= UINT32_MAX) value = value * 10 + (*p - '0');
+        valid = true;
+    }
+
+    if (!valid || value == 0) {
+        *out = PFEXT_OBJ_INVALID;
+    } else if (negative) {
+        *out = (value <= count) ? (uint32_t)(count - value) : PFEXT_OBJ_INVALID;
+    } else {
+        *out = (value - 1 < PFEXT_OBJ_INVALID) ? (uint32_t)(value - 1) : PFEXT_OBJ_INVALID;
+    }
+
+    return p;
+}
+
+static size_t
+pfext_obj_num_face_corners_INTERNAL(const char* p, const char* end, bool triangulate)
+{
+    // NOTE: Polygons are triangulated as fans, they are skipped without 'triangulate'
+
+    size_t num_vertices = 0;
+
+    for (p = pfext_obj_skip_spaces_INTERNAL(p, end); p < end; p = pfext_obj_skip_spaces_INTERNAL(p, end)) {
+        p = pfext_obj_skip_token_INTERNAL(p, end);
+        num_vertices++;
+    }
+
+    if (num_vertices < 3 || (!triangulate && num_vertices > 3)) {
+        return 0;
+    }
+
+    return 3 * (num_vertices - 2);
+}
+
+static void
+pfext_obj_count_INTERNAL(
+    const char* p, const char* end, bool triangulate,
+    pfext_obj_counts_INTERNAL_t* counts)
+{
+    while (p < end) {
+        const char* eol = memchr(p, '\n', end - p);
+        if (eol == NULL) eol = end;
+
+        p = pfext_obj_skip_spaces_INTERNAL(p, eol);
+        size_t len = eol - p;
+
+        if (len >= 2 && p[0] == 'v' && pfext_obj_is_space_INTERNAL(p[1])) {
+            counts->num_positions++;
+        } else if (len >= 3 && p[0] == 'v' && p[1] == 't' && pfext_obj_is_space_INTERNAL(p[2])) {
+            counts->num_texcoords++;
+        } else if (len >= 3 && p[0] == 'v' && p[1] == 'n' && pfext_obj_is_space_INTERNAL(p[2])) {
+            counts->num_normals++;
+        } else if (len >= 2 && p[0] == 'f' && pfext_obj_is_space_INTERNAL(p[1])) {
+            counts->num_corners += pfext_obj_num_face_corners_INTERNAL(p + 1, eol, triangulate);
+        }
+
+        p = (eol < end) ? eol + 1 : end;
+    }
+}
+
+static void
+pfext_obj_parse_INTERNAL(
+    const char* p, const char* end, bool triangulate,
+    pfext_obj_data_INTERNAL_t* data,
+    pfext_obj_counts_INTERNAL_t cursor)
+{
+    // NOTE: 'cursor' gives the number of each element defined before this chunk
+
+    while (p < end) {
+        const char* eol = memchr(p, '\n', end - p);
+        if (eol == NULL) eol = end;
+
+        p = pfext_obj_skip_spaces_INTERNAL(p, eol);
+        size_t len = eol - p;
+
+        if (len >= 2 && p[0] == 'v' && pfext_obj_is_space_INTERNAL(p[1])) {
+            float* v = data->positions + 3 * cursor.num_positions++;
+            p = pfext_obj_parse_float_INTERNAL(p + 1, eol, &v[0]);
+            p = pfext_obj_parse_float_INTERNAL(p, eol, &v[1]);
+            p = pfext_obj_parse_float_INTERNAL(p, eol, &v[2]);
+        } else if (len >= 3 && p[0] == 'v' && p[1] == 't' && pfext_obj_is_space_INTERNAL(p[2])) {
+            float* vt = data->texcoords + 2 * cursor.num_texcoords++;
+            p = pfext_obj_parse_float_INTERNAL(p + 2, eol, &vt[0]);
+            p = pfext_obj_parse_float_INTERNAL(p, eol, &vt[1]);
+        } else if (len >= 3 && p[0] == 'v' && p[1] == 'n' && pfext_obj_is_space_INTERNAL(p[2])) {
+            float* vn = data->normals + 3 * cursor.num_normals++;
+            p = pfext_obj_parse_float_INTERNAL(p + 2, eol, &vn[0]);
+            p = pfext_obj_parse_float_INTERNAL(p, eol, &vn[1]);
+            p = pfext_obj_parse_float_INTERNAL(p, eol, &vn[2]);
+        } else if (len >= 2 && p[0] == 'f' && pfext_obj_is_space_INTERNAL(p[1])) {
+            if (pfext_obj_num_face_corners_INTERNAL(p + 1, eol, triangulate) > 0) {
+                pfext_obj_corner_INTERNAL_t first = { 0 }, prev = { 0 };
+                int i = 0;
+
+                for (p = pfext_obj_skip_spaces_INTERNAL(p + 1, eol); p < eol; p = pfext_obj_skip_spaces_INTERNAL(p, eol), ++i) {
+                    pfext_obj_corner_INTERNAL_t corner = { 0, PFEXT_OBJ_ABSENT, PFEXT_OBJ_ABSENT };
+
+                    p = pfext_obj_parse_index_INTERNAL(p, eol, cursor.num_positions, &corner.v);
+                    if (p < eol && *p == '/') {
+                        if (++p < eol && *p != '/') {
+                            p = pfext_obj_parse_index_INTERNAL(p, eol, cursor.num_texcoords, &corner.vt);
+                        }
+                        if (p < eol && *p == '/') {
+                            p = pfext_obj_parse_index_INTERNAL(p + 1, eol, cursor.num_normals, &corner.vn);
+                        }
+                    }
+                    p = pfext_obj_skip_token_INTERNAL(p, eol);
+
+                    if (i >= 2) {
+                        pfext_obj_corner_INTERNAL_t* tri = data->corners + cursor.num_corners;
+                        tri[0] = first, tri[1] = prev, tri[2] = corner;
+                        cursor.num_corners += 3;
+                    }
+
+                    if (i == 0) first = corner;
+                    prev = corner;
+                }
+            }
+        }
+
+        p = (eol < end) ? eol + 1 : end;
+    }
+}
+
+static bool
+pfext_obj_reserve_INTERNAL(
+    void** array, size_t* capacity,
+    size_t count, size_t elem_size)
+{
+    if (count <= *capacity) {
+        return true;
+    }
+
+    size_t new_capacity = PF_MAX(count, 2 * *capacity);
+
+    void* grown = PF_REALLOC(*array, new_capacity * elem_size);
+    if (grown == NULL) return false;
+
+    *array = grown;
+    *capacity = new_capacity;
+
+    return true;
+}
+
+static inline uint32_t
+pfext_obj_hash_INTERNAL(const pfext_obj_corner_INTERNAL_t* corner)
+{
+    uint32_t h = corner->v * 0x9E3779B1u;
+    h = (h ^ (h >> 15) ^ corner->vt) * 0x85EBCA77u;
+    h = (h ^ (h >> 13) ^ corner->vn) * 0xC2B2AE3Du;
+    return h ^ (h >> 16);
+}
+
+static inline bool
+pfext_obj_corner_equal_INTERNAL(const pfext_obj_corner_INTERNAL_t* a, const pfext_obj_corner_INTERNAL_t* b)
+{
+    return a->v == b->v && a->vt == b->vt && a->vn == b->vn;
+}
+
+static size_t
+pfext_obj_deduplicate_INTERNAL(
+    const pfext_obj_corner_INTERNAL_t* corners, size_t num_corners,
+    int num_partitions, uint32_t* ids, uint32_t* firsts)
+{
+    /*
+        Writes in 'ids' the vertex of each corner, and in 'firsts' the first corner of
+        each vertex. The corners are first grouped by partition, in their original
+        order, then each partition is deduplicated with its own hash table.
+        Returns the number of vertices, or SIZE_MAX if out of memory.
+    */
+
+    const int num_ranges = num_partitions;
+    const size_t range_size = (num_corners + num_ranges - 1) / num_ranges;
+
+    uint32_t* hashes = PF_MALLOC(num_corners * sizeof(uint32_t));
+    uint32_t* order = PF_MALLOC(num_corners * sizeof(uint32_t));
+    size_t* offsets = PF_CALLOC((size_t)num_ranges * num_partitions + 1, sizeof(size_t));
+    size_t* num_unique = PF_CALLOC(num_partitions + 1, sizeof(size_t));
+    size_t result = SIZE_MAX;
+    bool success = true;
+
+    if (!hashes || !order || !offsets || !num_unique) {
+        goto finish;
+    }
+
+    /* Partition of each corner, by range of corners */
+
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(static)
+#endif //_OPENMP
+    for (int r = 0; r < num_ranges; ++r) {
+        size_t* count = offsets + (size_t)r * num_partitions;
+        size_t end = PF_MIN((r + 1) * range_size, num_corners);
+        for (size_t i = r * range_size; i < end; ++i) {
+            hashes[i] = pfext_obj_hash_INTERNAL(&corners[i]);
+            count[(uint64_t)hashes[i] * num_partitions >> 32]++;
+        }
+    }
+
+    // NOTE: The counts become the offsets of each (partition, range) pair in 'order'
+
+    size_t total = 0;
+    for (int p = 0; p < num_partitions; ++p) {
+        for (int r = 0; r < num_ranges; ++r) {
+            size_t* slot = &offsets[(size_t)r * num_partitions + p];
+            size_t count = *slot;
+            *slot = total;
+            total += count;
+        }
+    }
+
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(static)
+#endif //_OPENMP
+    for (int r = 0; r < num_ranges; ++r) {
+        size_t* cursor = offsets + (size_t)r * num_partitions;
+        size_t end = PF_MIN((r + 1) * range_size, num_corners);
+        for (size_t i = r * range_size; i < end; ++i) {
+            order[cursor[(uint64_t)hashes[i] * num_partitions >> 32]++] = (uint32_t)i;
+        }
+    }
+
+    /* Deduplication of each partition */
+
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(dynamic) reduction(&&:success)
+#endif //_OPENMP
+    for (int p = 0; p < num_partitions; ++p) {
+        // NOTE: After the scatter, the cursors of the last range are the ends of the partitions
+        size_t begin = (p == 0) ? 0 : offsets[(size_t)(num_ranges - 1) * num_partitions + p - 1];
+        size_t end = offsets[(size_t)(num_ranges - 1) * num_partitions + p];
+
+        size_t table_size = 16;
+        while (table_size < 2 * (end - begin)) table_size *= 2;
+
+        uint32_t* table = PF_MALLOC(table_size * sizeof(uint32_t));
+        if (table == NULL) {
+            success = false;
+            continue;
+        }
+
+        for (size_t i = 0; i < table_size; ++i) {
+            table[i] = UINT32_MAX;
+        }
+
+        uint32_t count = 0;
+
+        for (size_t k = begin; k < end; ++k) {
+            uint32_t i = order[k];
+            size_t slot = hashes[i] & (table_size - 1);
+
+            while (table[slot] != UINT32_MAX && !pfext_obj_corner_equal_INTERNAL(&corners[firsts[begin + table[slot]]], &corners[i])) {
+                slot = (slot + 1) & (table_size - 1);
+            }
+
+            if (table[slot] == UINT32_MAX) {
+                table[slot] = count;
+                firsts[begin + count++] = i;
+            }
+
+            ids[i] = table[slot];
+        }
+
+        num_unique[p + 1] = count;
+
+        PF_FREE(table);
+    }
+
+    if (!success) {
+        goto finish;
+    }
+
+    /* Numbering of the vertices of all the partitions */
+
+    for (int p = 0; p < num_partitions; ++p) {
+        num_unique[p + 1] += num_unique[p];
+    }
+
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(static)
+#endif //_OPENMP
+    for (int p = 0; p < num_partitions; ++p) {
+        size_t begin = (p == 0) ? 0 : offsets[(size_t)(num_ranges - 1) * num_partitions + p - 1];
+        size_t end = offsets[(size_t)(num_ranges - 1) * num_partitions + p];
+        for (size_t k = begin; k < end; ++k) {
+            ids[order[k]] += (uint32_t)num_unique[p];
+        }
+    }
+
+    // NOTE: Compacts the first corners, each partition only moves backward
+    for (int p = 1; p < num_partitions; ++p) {
+        size_t begin = offsets[(size_t)(num_ranges - 1) * num_partitions + p - 1];
+        memmove(firsts + num_unique[p], firsts + begin, (num_unique[p + 1] - num_unique[p]) * sizeof(uint32_t));
+    }
+
+    result = num_unique[num_partitions];
+
+finish:
+    if (hashes) PF_FREE(hashes);
+    if (order) PF_FREE(order);
+    if (offsets) PF_FREE(offsets);
+    if (num_unique) PF_FREE(num_unique);
+
+    return result;
+}
+
+/* Loading Functions */
+
+pf_vertexbuffer_t
+pfext_vertexbuffer_load_obj(
+    const char* file_path,
+    bool triangulate)
+{
+    pf_vertexbuffer_t vb = { 0 };
+
+    FILE* file = fopen(file_path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "ERROR: Unable to load file [%s]\n", file_path);
+        return vb;
+    }
+
+#ifdef _OPENMP
+    const int num_chunks = omp_get_max_threads();
+#else
+    const int num_chunks = 1;
+#endif
+
+    pfext_obj_data_INTERNAL_t data = { 0 };
+
+    size_t block_size = PF_OBJ_BLOCK_SIZE;
+    char* block = PF_MALLOC(block_size);
+    const char** bounds = PF_MALLOC((num_chunks + 1) * sizeof(const char*));
+    pfext_obj_counts_INTERNAL_t* cursors = PF_MALLOC(num_chunks * sizeof(pfext_obj_counts_INTERNAL_t));
+
+    uint32_t* ids = NULL;
+    uint32_t* firsts = NULL;
+
+    bool success = (block != NULL && bounds != NULL && cursors != NULL);
+    bool overflow = false;
+    bool eof = false;
+    size_t length = 0;
+
+    /* Parsing of the file block by block */
+
+    while (success && !eof) {
+        length += fread(block + length, 1, block_size - length, file);
+        eof = (length < block_size);
+
+        if (ferror(file)) {
+            success = false;
+            break;
+        }
+
+        size_t parsed = length;
+
+        if (!eof) {
+            while (parsed > 0 && block[parsed - 1] != '\n') --parsed;
+            if (parsed == 0) {
+                // NOTE: The block is grown when a single line does not fit in it
+                char* grown = PF_REALLOC(block, 2 * block_size);
+                if (grown == NULL) success = false;
+                else block = grown, block_size *= 2;
+                continue;
+            }
+        }
+
+        bounds[0] = block;
+        bounds[num_chunks] = block + parsed;
+
+        for (int c = 1; c < num_chunks; ++c) {
+            const char* p = PF_MAX(block + parsed * c / num_chunks, bounds[c - 1]);
+            const char* eol = memchr(p, '\n', block + parsed - p);
+            bounds[c] = (eol != NULL) ? eol + 1 : block + parsed;
+        }
+
+        /* Counting of the elements of each chunk */
+
+#ifdef _OPENMP
+#       pragma omp parallel for schedule(static)
+#endif //_OPENMP
+        for (int c = 0; c < num_chunks; ++c) {
+            cursors[c] = (pfext_obj_counts_INTERNAL_t) { 0 };
+            pfext_obj_count_INTERNAL(bounds[c], bounds[c + 1], triangulate, &cursors[c]);
+        }
+
+        pfext_obj_counts_INTERNAL_t total = data.count;
+
+        for (int c = 0; c < num_chunks; ++c) {
+            pfext_obj_counts_INTERNAL_t count = cursors[c];
+            cursors[c] = total;
+            total.num_positions += count.num_positions;
+            total.num_texcoords += count.num_texcoords;
+            total.num_normals += count.num_normals;
+            total.num_corners += count.num_corners;
+        }
+
+        // NOTE: Each position yields at least one distinct vertex once referenced,
+        //       so the file can be rejected before the remaining blocks are read
+        if (total.num_positions > UINT16_MAX + 1) {
+            overflow = true;
+            break;
+        }
+
+        success = pfext_obj_reserve_INTERNAL((void**)&data.positions, &data.capacity.num_positions, total.num_positions, 3 * sizeof(float))
+               && pfext_obj_reserve_INTERNAL((void**)&data.texcoords, &data.capacity.num_texcoords, total.num_texcoords, 2 * sizeof(float))
+               && pfext_obj_reserve_INTERNAL((void**)&data.normals, &data.capacity.num_normals, total.num_normals, 3 * sizeof(float))
+               && pfext_obj_reserve_INTERNAL((void**)&data.corners, &data.capacity.num_corners, total.num_corners, sizeof(pfext_obj_corner_INTERNAL_t));
+
+        if (!success) {
+            break;
+        }
+
+        /* Parsing of each chunk at its final place */
+
+#ifdef _OPENMP
+#       pragma omp parallel for schedule(static)
+#endif //_OPENMP
+        for (int c = 0; c < num_chunks; ++c) {
+            pfext_obj_parse_INTERNAL(bounds[c], bounds[c + 1], triangulate, &data, cursors[c]);
+        }
+
+        data.count = total;
+
+        // NOTE: The incomplete last line is kept for the next block
+        memmove(block, block + parsed, length - parsed);
+        length -= parsed;
+    }
+
+    fclose(file);
+
+    if (overflow) {
+        fprintf(stderr, "ERROR: The OBJ file [%s] has more vertices than 16 bits indices can address\n", file_path);
+        goto finish;
+    }
+
+    if (!success) {
+        fprintf(stderr, "ERROR: Unable to read OBJ file [%s]\n", file_path);
+        goto finish;
+    }
+
+    if (data.count.num_corners == 0 || data.count.num_corners >= UINT32_MAX) {
+        fprintf(stderr, "ERROR: The OBJ file [%s] does not contain any supported face\n", file_path);
+        goto finish;
+    }
+
+    /* Deduplication of the (v, vt, vn) triplets */
+
+    const size_t num_corners = data.count.num_corners;
+
+    ids = PF_MALLOC(num_corners * sizeof(uint32_t));
+    firsts = PF_MALLOC(num_corners * sizeof(uint32_t));
+
+    if (ids == NULL || firsts == NULL) {
+        fprintf(stderr, "ERROR: Unable to allocate memory for OBJ vertices\n");
+        goto finish;
+    }
+
+    size_t num_vertices = pfext_obj_deduplicate_INTERNAL(data.corners, num_corners, num_chunks, ids, firsts);
+
+    if (num_vertices == SIZE_MAX) {
+        fprintf(stderr, "ERROR: Unable to allocate memory for OBJ vertices\n");
+        goto finish;
+    }
+
+    if (num_vertices > UINT16_MAX + 1) {
+        fprintf(stderr, "ERROR: The OBJ file [%s] has more vertices than 16 bits indices can address\n", file_path);
+        goto finish;
+    }
+
+    /* Creation of the vertex buffer */
+
+    const bool has_texcoords = (data.count.num_texcoords > 0);
+    const bool has_normals = (data.count.num_normals > 0);
+
+    vb.num_vertices = (uint32_t)num_vertices;
+    vb.num_indices = (uint32_t)num_corners;
+    vb.indices = PF_MALLOC(num_corners * sizeof(uint16_t));
+
+    pf_attribute_t* positions = &vb.attributes[PF_ATTRIB_POSITION];
+    pf_attribute_t* texcoords = &vb.attributes[PF_ATTRIB_TEXCOORD];
+    pf_attribute_t* normals = &vb.attributes[PF_ATTRIB_NORMAL];
+
+    positions->buffer = PF_MALLOC(num_vertices * 3 * sizeof(float));
+    if (has_texcoords) texcoords->buffer = PF_CALLOC(num_vertices * 2, sizeof(float));
+    if (has_normals) normals->buffer = PF_CALLOC(num_vertices * 3, sizeof(float));
+
+    if (!vb.indices || !positions->buffer || (has_texcoords && !texcoords->buffer) || (has_normals && !normals->buffer)) {
+        fprintf(stderr, "ERROR: Unable to allocate memory for OBJ vertices\n");
+        pf_vertexbuffer_delete(&vb);
+        goto finish;
+    }
+
+    positions->size = num_vertices;
+    positions->type = PF_ATTRIB_FLOAT;
+    positions->comp = 3;
+    positions->used = true;
+
+    texcoords->size = num_vertices;
+    texcoords->type = PF_ATTRIB_FLOAT;
+    texcoords->comp = 2;
+    texcoords->used = has_texcoords;
+
+    normals->size = num_vertices;
+    normals->type = PF_ATTRIB_FLOAT;
+    normals->comp = 3;
+    normals->used = has_normals;
+
+    bool valid = true;
+
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(static) reduction(&&:valid)
+#endif //_OPENMP
+    for (size_t i = 0; i < num_vertices; ++i) {
+        const pfext_obj_corner_INTERNAL_t* corner = &data.corners[firsts[i]];
+
+        if (corner->v >= data.count.num_positions) {
+            valid = false;
+            continue;
+        }
+        memcpy((float*)positions->buffer + 3 * i, data.positions + 3 * corner->v, 3 * sizeof(float));
+
+        if (corner->vt < data.count.num_texcoords) {
+            memcpy((float*)texcoords->buffer + 2 * i, data.texcoords + 2 * corner->vt, 2 * sizeof(float));
+        } else if (corner->vt != PFEXT_OBJ_ABSENT) {
+            valid = false;
+        }
+
+        if (corner->vn < data.count.num_normals) {
+            memcpy((float*)normals->buffer + 3 * i, data.normals + 3 * corner->vn, 3 * sizeof(float));
+        } else if (corner->vn != PFEXT_OBJ_ABSENT) {
+            valid = false;
+        }
+    }
+
+    if (!valid) {
+        fprintf(stderr, "ERROR: The OBJ file [%s] contains invalid face indices\n", file_path);
+        pf_vertexbuffer_delete(&vb);
+        goto finish;
+    }
+
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(static)
+#endif //_OPENMP
+    for (size_t i = 0; i < num_corners; ++i) {
+        vb.indices[i] = (uint16_t)ids[i];
+    }
+
+    // NOTE: The vertices and indices are reordered for the vertex cache,
+    //       overdraw and fetch locality, see 'pfext_vertexbuffer_optimize'
+    pfext_vertexbuffer_optimize(&vb);
+
+finish:
+    if (block) PF_FREE(block);
+    if (bounds) PF_FREE(bounds);
+    if (cursors) PF_FREE(cursors);
+    if (ids) PF_FREE(ids);
+    if (firsts) PF_FREE(firsts);
+    if (data.positions) PF_FREE(data.positions);
+    if (data.texcoords) PF_FREE(data.texcoords);
+    if (data.normals) PF_FREE(data.normals);
+    if (data.corners) PF_FREE(data.corners);
+
+    return vb;
+}
+
+static void
+pfext_cgltf_use_mapping_INTERNAL(
+    pf_vertexbuffer_t* vb, pf_mapping_INTERNAL_t* mapping)
+{
+    if (vb->mapping == NULL) {
+        vb->mapping = mapping;
+        mapping->refs++;
+    }
+}
+
+static bool
+pfext_cgltf_load_accessor_INTERNAL(
+    pf_vertexbuffer_t* vb, pf_attribute_t* attr,
+    const cgltf_accessor* accessor,
+    pf_mapping_INTERNAL_t* mapping)
+{
+    /*
+        Floats and normalized 8 and 16 bits data, as allowed by 'KHR_mesh_quantization',
+        are used in place when they lie in the mapped file, otherwise they are copied in
+        their compact form. Any other data, or sparse accessors, are expanded to floats.
+    */
+
+    cgltf_size count = accessor->count;
+    cgltf_size comp = cgltf_num_components(accessor->type);
+    cgltf_size comp_size = cgltf_component_size(accessor->component_type);
+
+    attr->size = count;
+    attr->comp = (uint8_t)comp;
+    attr->used = true;
+
+    bool compact = !accessor->is_sparse && accessor->buffer_view != NULL;
+
+    switch (accessor->component_type) {
+        case cgltf_component_type_r_32f: attr->type = PF_ATTRIB_FLOAT; break;
+        case cgltf_component_type_r_8: attr->type = PF_ATTRIB_SNORM8; break;
+        case cgltf_component_type_r_8u: attr->type = PF_ATTRIB_UNORM8; break;
+        case cgltf_component_type_r_16: attr->type = PF_ATTRIB_SNORM16; break;
+        case cgltf_component_type_r_16u: attr->type = PF_ATTRIB_UNORM16; break;
+        default: compact = false; break;
+    }
+
+    if (accessor->normalized == (accessor->component_type == cgltf_component_type_r_32f)) {
+        compact = false;
+    }
+
+    const uint8_t* src = compact ? cgltf_buffer_view_data(accessor->buffer_view) : NULL;
+
+    if (src != NULL) {
+        if (pf_mapping_contains_INTERNAL(mapping, src)
+            && (uintptr_t)(src + accessor->offset) % comp_size == 0
+            && accessor->stride % comp_size == 0)
+        {
+            attr->buffer = (void*)src;
+            attr->offset = accessor->offset;
+            attr->stride = accessor->stride;
+            pfext_cgltf_use_mapping_INTERNAL(vb, mapping);
+            return true;
+        }
+
+        size_t elem_size = pf_attribute_get_elem_size(attr);
+        uint8_t* dst = PF_MALLOC(count * elem_size);
+        if (dst == NULL) return false;
+
+        src += accessor->offset;
+        for (cgltf_size i = 0; i < count; ++i) {
+            memcpy(dst + i * elem_size, src + i * accessor->stride, elem_size);
+        }
+
+        attr->buffer = dst;
+        return true;
+    }
+
+    attr->type = PF_ATTRIB_FLOAT;
+    attr->buffer = PF_MALLOC(count * comp * sizeof(float));
+    if (attr->buffer == NULL) return false;
+
+    cgltf_accessor_unpack_floats(accessor, attr->buffer, count * comp);
+
+    return true;
+}
+
+static bool
+pfext_cgltf_load_colors_INTERNAL(
+    pf_vertexbuffer_t* vb,
+    const cgltf_accessor* accessor,
+    pf_mapping_INTERNAL_t* mapping)
+{
+    // NOTE: Colors are stored as 'pf_color_t', only the normalized unsigned bytes RGBA
+    //       colors can be used in place, the others are converted
+
+    pf_attribute_t* attr = &vb->attributes[PF_ATTRIB_COLOR];
+
+    attr->size = accessor->count;
+    attr->type = PF_ATTRIB_UBYTE;
+    attr->comp = 4;
+    attr->used = true;
+
+    if (!accessor->is_sparse && accessor->buffer_view != NULL && accessor->normalized
+        && accessor->component_type == cgltf_component_type_r_8u && accessor->type == cgltf_type_vec4)
+    {
+        const uint8_t* src = cgltf_buffer_view_data(accessor->buffer_view);
+        if (pf_mapping_contains_INTERNAL(mapping, src)) {
+            attr->buffer = (void*)src;
+            attr->offset = accessor->offset;
+            attr->stride = accessor->stride;
+            pfext_cgltf_use_mapping_INTERNAL(vb, mapping);
+            return true;
+        }
+    }
+
+    pf_color_t* colors = PF_MALLOC(accessor->count * sizeof(pf_color_t));
+    if (colors == NULL) return false;
+
+    for (cgltf_size i = 0; i < accessor->count; ++i) {
+        float values[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        cgltf_accessor_read_float(accessor, i, values, 4);
+        for (int_fast8_t j = 0; j < 4; ++j) {
+            colors[i].a[j] = (uint8_t)(PF_CLAMP(values[j], 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+    }
+
+    attr->buffer = colors;
+
+    return true;
+}
+
+static bool
+pfext_cgltf_load_indices_INTERNAL(
+    pf_vertexbuffer_t* vb,
+    const cgltf_accessor* accessor,
+    pf_mapping_INTERNAL_t* mapping)
+{
+    vb->num_indices = accessor->count;
+
+    if (!accessor->is_sparse && accessor->buffer_view != NULL
+        && accessor->component_type == cgltf_component_type_r_16u
+        && accessor->stride == sizeof(uint16_t))
+    {
+        const uint8_t* src = cgltf_buffer_view_data(accessor->buffer_view);
+        if (pf_mapping_contains_INTERNAL(mapping, src) && (uintptr_t)(src + accessor->offset) % sizeof(uint16_t) == 0) {
+            vb->indices = (uint16_t*)(src + accessor->offset);
+            pfext_cgltf_use_mapping_INTERNAL(vb, mapping);
+            return true;
+        }
+    }
+
+    vb->indices = PF_MALLOC(accessor->count * sizeof(uint16_t));
+    if (vb->indices == NULL) return false;
+
+    for (cgltf_size k = 0; k < accessor->count; ++k) {
+        cgltf_size index = cgltf_accessor_read_index(accessor, k);
+        if (index > UINT16_MAX) {
+            fprintf(stderr, "ERROR: GLTF index [%zu] exceeds what 16 bits indices can address\n", (size_t)index);
+            return false;
+        }
+        vb->indices[k] = (uint16_t)index;
+    }
+
+    return true;
+}
+
+static bool
+pfext_cgltf_load_topology_INTERNAL(
+    pf_vertexbuffer_t* vb,
+    cgltf_primitive_type type)
+{
+    switch (type) {
+        case cgltf_primitive_type_triangles:
+            vb->topology = PF_TRIANGLES;
+            return true;
+        case cgltf_primitive_type_triangle_strip:
+            vb->topology = PF_TRIANGLE_STRIP;
+            return true;
+        case cgltf_primitive_type_triangle_fan:
+            vb->topology = PF_TRIANGLE_FAN;
+            return true;
+        default:
+            fprintf(stderr, "ERROR: GLTF points and lines primitives are not supported\n");
+            return false;
+    }
+}
+
+pf_vertexbuffer_t*
+pfext_vertexbuffer_load_gltf(
+    const char* file_path,
+    int* num_vertexbuffer)
+{
+    pf_vertexbuffer_t* vbs = NULL;
+    *num_vertexbuffer = 0;
+
+    pf_mapping_INTERNAL_t* mapping = pf_mapping_open_INTERNAL(file_path);
+    if (mapping == NULL) {
+        fprintf(stderr, "ERROR: Unable to load file [%s]\n", file_path);
+        return NULL;
+    }
+
+    cgltf_options options = {0};
+    cgltf_data* data = NULL;
+
+    cgltf_result err = cgltf_parse(&options, mapping->data, mapping->size, &data);
+    if (err != cgltf_result_success) {
+        fprintf(stderr, "ERROR: Unable to parse GLTF file [%s]\n", file_path);
+        goto finish;
+    }
+
+    err = cgltf_load_buffers(&options, data, file_path);
+    if (err != cgltf_result_success) {
+        fprintf(stderr, "ERROR: Unable to load GLTF model [%s]\n", file_path);
+        goto finish;
+    }
+
+    // NOTE: Checks the accessors against their buffers before anything is read from them
+    err = cgltf_validate(data);
+    if (err != cgltf_result_success) {
+        fprintf(stderr, "ERROR: The GLTF model [%s] is malformed\n", file_path);
+        goto finish;
+    }
+
+    if (data->meshes_count == 0) {
+        fprintf(stderr, "ERROR: The GLTF model [%s] does not contain any mesh\n", file_path);
+        goto finish;
+    }
+
+    cgltf_size num_primitives = 0;
+    for (cgltf_size i = 0; i < data->meshes_count; ++i) {
+        num_primitives += data->meshes[i].primitives_count;
+    }
+
+    if (num_primitives == 0) {
+        fprintf(stderr, "ERROR: The GLTF model [%s] does not contain any primitive\n", file_path);
+        goto finish;
+    }
+
+    vbs = PF_CALLOC(num_primitives, sizeof(pf_vertexbuffer_t));
+    if (vbs == NULL) {
+        fprintf(stderr, "ERROR: Unable to allocate memory for vertex buffers\n");
+        goto finish;
+    }
+
+    bool success = true;
+    cgltf_size num_loaded = 0;
+
+    for (cgltf_size i = 0; i < data->meshes_count && success; ++i) {
+        const cgltf_mesh* mesh = &data->meshes[i];
+
+        for (cgltf_size p = 0; p < mesh->primitives_count && success; ++p) {
+            const cgltf_primitive* primitive = &mesh->primitives[p];
+            pf_vertexbuffer_t* vb = &vbs[num_loaded++];
+
+            success = pfext_cgltf_load_topology_INTERNAL(vb, primitive->type);
+
+            for (cgltf_size j = 0; j < primitive->attributes_count && success; ++j) {
+                const cgltf_attribute* attribute = &primitive->attributes[j];
+                if (attribute->data->type == cgltf_type_scalar || attribute->index != 0) {
+                    continue;
+                }
+
+                switch (attribute->type) {
+                    case cgltf_attribute_type_position:
+                        success = pfext_cgltf_load_accessor_INTERNAL(vb, &vb->attributes[PF_ATTRIB_POSITION], attribute->data, mapping);
+                        vb->num_vertices = attribute->data->count;
+                        break;
+                    case cgltf_attribute_type_texcoord:
+                        success = pfext_cgltf_load_accessor_INTERNAL(vb, &vb->attributes[PF_ATTRIB_TEXCOORD], attribute->data, mapping);
+                        break;
+                    case cgltf_attribute_type_normal:
+                        success = pfext_cgltf_load_accessor_INTERNAL(vb, &vb->attributes[PF_ATTRIB_NORMAL], attribute->data, mapping);
+                        break;
+                    case cgltf_attribute_type_color:
+                        success = pfext_cgltf_load_colors_INTERNAL(vb, attribute->data, mapping);
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            if (success && primitive->indices != NULL) {
+                success = pfext_cgltf_load_indices_INTERNAL(vb, primitive->indices, mapping);
+                if (success && !pfext_check_indices_INTERNAL(vb->indices, vb->num_indices, vb->num_vertices, false)) {
+                    fprintf(stderr, "ERROR: GLTF primitive indices refer to missing vertices\n");
+                    success = false;
+                }
+            }
+        }
+    }
+
+    if (!success) {
+        fprintf(stderr, "ERROR: Unable to load the meshes of GLTF model [%s]\n", file_path);
+        for (cgltf_size i = 0; i < num_loaded; ++i) {
+            pf_vertexbuffer_delete(&vbs[i]);
+        }
+        PF_FREE(vbs);
+        vbs = NULL;
+        goto finish;
+    }
+
+    *num_vertexbuffer = (int)num_primitives;
+
+    // NOTE: The converted vertex buffers are reordered like the OBJ ones, those used
+    //       in place from the file are expected to be already optimized by the
+    //       exporter, reordering them would copy the written pages
+    for (int i = 0; i < *num_vertexbuffer; ++i) {
+        if (vbs[i].mapping == NULL) {
+            pfext_vertexbuffer_optimize(&vbs[i]);
+        }
+    }
+
+finish:
+    if (data != NULL) {
+        cgltf_free(data);
+    }
+
+    // NOTE: Releases the reference of the loader, the file remains mapped
+    //       as long as a vertex buffer points into it
+    pf_mapping_release_INTERNAL(mapping);
+
+    return vbs;
+}
+
+/* Internal Binary Cache Definitions */
+
+/*
+    Layout of a binary vertex buffer file: the header, followed by one descriptor per
+    attribute and one per LOD level, then the arrays themselves, each one aligned on
+    'PF_VERTEXBUFFER_BIN_ALIGNMENT' bytes. All offsets are relative to the start of
+    the file, an attribute whose offset is zero is not used. The first LOD level
+    shares the index array of the vertex buffer.
+*/
+
+#define PFEXT_BIN_VERSION 1
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t num_vertices;
+    uint32_t num_indices;
+    uint32_t topology;
+    uint32_t primitive_restart;
+    uint32_t num_attributes;
+    uint32_t num_levels;
+    uint64_t indices_offset;
+    float center[3];
+    float radius;
+} pfext_bin_header_INTERNAL_t;
+
+typedef struct {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t type;
+    uint32_t comp;
+} pfext_bin_attribute_INTERNAL_t;
+
+typedef struct {
+    uint64_t offset;
+    uint64_t num_indices;
+} pfext_bin_level_INTERNAL_t;
+
+static uint64_t
+pfext_bin_align_INTERNAL(
+    uint64_t offset)
+{
+    const uint64_t align = PF_VERTEXBUFFER_BIN_ALIGNMENT;
+    return (offset + align - 1) / align * align;
+}
+
+static bool
+pfext_bin_write_INTERNAL(
+    FILE* file, uint64_t* position,
+    uint64_t offset, const void* data, size_t size)
+{
+    // NOTE: Pads with zeros up to 'offset' before writing the data
+
+    static const uint8_t zeros[PF_VERTEXBUFFER_BIN_ALIGNMENT] = { 0 };
+
+    while (*position < offset) {
+        size_t count = (size_t)PF_MIN(offset - *position, sizeof(zeros));
+        if (fwrite(zeros, 1, count, file) != count) return false;
+        *position += count;
+    }
+
+    if (size > 0 && fwrite(data, 1, size, file) != size) {
+        return false;
+    }
+
+    *position += size;
+
+    return true;
+}
+
+static const void*
+pfext_bin_section_INTERNAL(
+    const pf_mapping_INTERNAL_t* mapping,
+    uint64_t offset, uint64_t count,
+    size_t elem_size, size_t align)
+{
+    // NOTE: Returns NULL if the array is not entirely in the file or is misaligned
+
+    if (offset == 0 || offset > mapping->size || offset % align != 0) {
+        return NULL;
+    }
+    if (count > (mapping->size - offset) / elem_size) {
+        return NULL;
+    }
+    return mapping->data + offset;
+}
+
+/* Binary Cache Functions */
+
+bool
+pfext_vertexbuffer_save_bin(
+    const char* file_path,
+    const pf_vertexbuffer_t* vb,
+    const pf_vertexbuffer_lod_t* lod)
+{
+    pfext_bin_header_INTERNAL_t header = { 0 };
+    pfext_bin_attribute_INTERNAL_t attributes[PF_MAX_ATTRIBUTES] = { 0 };
+    pfext_bin_level_INTERNAL_t levels[PF_MAX_LOD_LEVELS] = { 0 };
+
+    uint32_t num_levels = (lod != NULL && vb->indices != NULL) ? lod->num_levels : 0;
+
+    memcpy(header.magic, "PFVB", 4);
+    header.version = PFEXT_BIN_VERSION;
+    header.num_vertices = vb->num_vertices;
+    header.num_indices = (vb->indices != NULL) ? vb->num_indices : 0;
+    header.topology = vb->topology;
+    header.primitive_restart = vb->primitive_restart;
+    header.num_attributes = PF_MAX_ATTRIBUTES;
+    header.num_levels = num_levels;
+
+    if (lod != NULL) {
+        memcpy(header.center, lod->center, sizeof(header.center));
+        header.radius = lod->radius;
+    }
+
+    /* Layout of the arrays */
+
+    uint64_t offset = sizeof(header) + sizeof(attributes) + num_levels * sizeof(pfext_bin_level_INTERNAL_t);
+
+    for (int i = 0; i < PF_MAX_ATTRIBUTES; ++i) {
+        const pf_attribute_t* attr = &vb->attributes[i];
+        if (!attr->used || attr->buffer == NULL) continue;
+
+        offset = pfext_bin_align_INTERNAL(offset);
+        attributes[i].offset = offset;
+        attributes[i].size = attr->size;
+        attributes[i].type = attr->type;
+        attributes[i].comp = attr->comp;
+        offset += attr->size * pf_attribute_get_elem_size(attr);
+    }
+
+    if (header.num_indices > 0) {
+        offset = pfext_bin_align_INTERNAL(offset);
+        header.indices_offset = offset;
+        offset += header.num_indices * sizeof(uint16_t);
+    }
+
+    for (uint32_t i = 0; i < num_levels; ++i) {
+        if (i == 0) {
+            levels[i].offset = header.indices_offset;
+            levels[i].num_indices = header.num_indices;
+            continue;
+        }
+        offset = pfext_bin_align_INTERNAL(offset);
+        levels[i].offset = offset;
+        levels[i].num_indices = lod->num_indices[i];
+        offset += lod->num_indices[i] * sizeof(uint16_t);
+    }
+
+    /* Writing of the file */
+
+    FILE* file = fopen(file_path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "ERROR: Unable to open file [%s] for writing\n", file_path);
+        return false;
     }
 
-    // Load normals, if present
-    if (attrib.num_normals > 0) {
-        pf_attribute_t* normal_attr = &vertexbuffer.attributes[PF_ATTRIB_NORMAL];
-        normal_attr->type = PF_ATTRIB_FLOAT;
-        normal_attr->comp = 3; // nx, ny, nz
-        normal_attr->size = vertexbuffer.num_vertices * 3 * sizeof(float);
-        normal_attr->buffer = PF_MALLOC(normal_attr->size);
-        if (normal_attr->buffer == NULL) {
-            fprintf(stderr, "ERROR: Unable to allocate memory for normals\n");
-            goto finish;
+    uint64_t position = 0;
+
+    bool success = pfext_bin_write_INTERNAL(file, &position, 0, &header, sizeof(header))
+        && pfext_bin_write_INTERNAL(file, &position, position, attributes, sizeof(attributes))
+        && pfext_bin_write_INTERNAL(file, &position, position, levels, num_levels * sizeof(pfext_bin_level_INTERNAL_t));
+
+    for (int i = 0; i < PF_MAX_ATTRIBUTES && success; ++i) {
+        const pf_attribute_t* attr = &vb->attributes[i];
+        if (attributes[i].offset == 0) continue;
+
+        size_t elem_size = pf_attribute_get_elem_size(attr);
+
+        // NOTE: Interleaved attributes are written one element at a time
+        if (pf_attribute_get_stride(attr) == elem_size) {
+            success = pfext_bin_write_INTERNAL(file, &position, attributes[i].offset,
+                pf_attribute_get_elem_ptr(attr, 0), attr->size * elem_size);
+        } else {
+            success = pfext_bin_write_INTERNAL(file, &position, attributes[i].offset, NULL, 0);
+            for (size_t j = 0; j < attr->size && success; ++j) {
+                success = pfext_bin_write_INTERNAL(file, &position, position,
+                    pf_attribute_get_elem_ptr(attr, j), elem_size);
+            }
         }
-        memcpy(normal_attr->buffer, attrib.normals, normal_attr->size);
-        normal_attr->used = true;
     }
 
-    // Load indices
-    vertexbuffer.indices = (uint16_t*)PF_MALLOC(vertexbuffer.num_indices * sizeof(uint16_t));
-    if (vertexbuffer.indices == NULL) {
-        fprintf(stderr, "ERROR: Unable to allocate memory for indices\n");
-        goto finish;
+    if (success && header.num_indices > 0) {
+        success = pfext_bin_write_INTERNAL(file, &position, header.indices_offset,
+            vb->indices, header.num_indices * sizeof(uint16_t));
     }
-    for (size_t f = 0; f < attrib.num_face_num_verts; f++) {
-        vertexbuffer.indices[f] = (uint16_t)attrib.faces[f].v_idx;
+
+    for (uint32_t i = 1; i < num_levels && success; ++i) {
+        success = pfext_bin_write_INTERNAL(file, &position, levels[i].offset,
+            lod->indices[i], levels[i].num_indices * sizeof(uint16_t));
     }
 
-finish:
-    // Free tinyobj resources
-    tinyobj_attrib_free(&attrib);
-    tinyobj_shapes_free(shapes, num_shapes);
-    tinyobj_materials_free(materials, num_materials);
+    if (fclose(file) != 0) {
+        success = false;
+    }
 
-    return vertexbuffer;
-}
+    if (!success) {
+        fprintf(stderr, "ERROR: Unable to write binary vertex buffer [%s]\n", file_path);
+    }
 
-static void
-pfext_cgltf_copy_accessor_data_INTERNAL(
-    void** dest, cgltf_accessor* accessor)
-{
-    *dest = PF_MALLOC(accessor->count * sizeof(float) * cgltf_num_components(accessor->type));
-    cgltf_accessor_unpack_floats(accessor, *dest, accessor->count * cgltf_num_components(accessor->type));
+    return success;
 }
 
-pf_vertexbuffer_t*
-pfext_vertexbuffer_load_gltf(
+pf_vertexbuffer_t
+pfext_vertexbuffer_load_bin(
     const char* file_path,
-    int* num_vertexbuffer)
+    pf_vertexbuffer_lod_t* lod)
 {
-    pf_vertexbuffer_t* vbs = NULL;
-    *num_vertexbuffer = 0;
+    pf_vertexbuffer_t vb = { 0 };
 
-    cgltf_options options = {0};
-    cgltf_data* data = NULL;
+    if (lod != NULL) {
+        *lod = (pf_vertexbuffer_lod_t) { 0 };
+    }
 
-    cgltf_result err = cgltf_parse_file(&options, file_path, &data);
-    if (err != cgltf_result_success) {
+    pf_mapping_INTERNAL_t* mapping = pf_mapping_open_INTERNAL(file_path);
+    if (mapping == NULL) {
         fprintf(stderr, "ERROR: Unable to load file [%s]\n", file_path);
-        exit(EXIT_FAILURE);
+        return vb;
     }
 
-    err = cgltf_load_buffers(&options, data, file_path);
-    if (err != cgltf_result_success) {
-        fprintf(stderr, "ERROR: Unable to load GLTF model [%s]\n", file_path);
-        cgltf_free(data);
-        exit(EXIT_FAILURE);
-    }
+    /* Validation of the header */
 
-    if (data->meshes_count == 0) {
-        fprintf(stderr, "ERROR: The GLTF model [%s] does not contain any mesh\n", file_path);
-        cgltf_free(data);
-        exit(EXIT_FAILURE);
+    const pfext_bin_header_INTERNAL_t* header = (const void*)mapping->data;
+
+    if (mapping->size < sizeof(*header) || memcmp(header->magic, "PFVB", 4) != 0 || header->version != PFEXT_BIN_VERSION) {
+        fprintf(stderr, "ERROR: The file [%s] is not a supported binary vertex buffer\n", file_path);
+        pf_mapping_release_INTERNAL(mapping);
+        return vb;
     }
 
-    vbs = PF_CALLOC(data->meshes_count, sizeof(pf_vertexbuffer_t));
-    *num_vertexbuffer = data->meshes_count;
+    const uint64_t num_attributes = header->num_attributes;
+    const uint64_t num_levels = header->num_levels;
 
-    for (cgltf_size i = 0; i < data->meshes_count; ++i) {
-        cgltf_mesh* cgltf_mesh = &data->meshes[i];
-        pf_vertexbuffer_t* vb = &vbs[i];
+    const pfext_bin_attribute_INTERNAL_t* attributes = pfext_bin_section_INTERNAL(mapping, sizeof(*header),
+        num_attributes, sizeof(pfext_bin_attribute_INTERNAL_t), sizeof(uint64_t));
 
-        if (cgltf_mesh->primitives_count == 0) {
-            continue;
-        }
+    const pfext_bin_level_INTERNAL_t* levels = pfext_bin_section_INTERNAL(mapping,
+        sizeof(*header) + num_attributes * sizeof(pfext_bin_attribute_INTERNAL_t),
+        num_levels, sizeof(pfext_bin_level_INTERNAL_t), sizeof(uint64_t));
 
-        cgltf_primitive* primitive = &cgltf_mesh->primitives[0];
+    bool success = (attributes != NULL && (levels != NULL || num_levels == 0))
+        && (header->topology <= PF_TRIANGLE_FAN);
 
-        for (cgltf_size j = 0; j < primitive->attributes_count; ++j) {
-            cgltf_attribute* attribute = &primitive->attributes[j];
-            if (attribute->data->type == cgltf_type_scalar) {
-                continue;
-            }
+    /* Attributes and indices, used in place */
 
-            switch (attribute->type) {
-                case cgltf_attribute_type_position: {
-                    pf_attribute_t* attr = &vb->attributes[PF_ATTRIB_POSITION];
-                    pfext_cgltf_copy_accessor_data_INTERNAL(&attr->buffer, attribute->data);
-                    vb->num_vertices = attribute->data->count;
-                    attr->size = attribute->data->count;
-                    attr->type = PF_ATTRIB_FLOAT;
-                    attr->used = true;
-                    attr->comp = 3;
-                } break;
-                case cgltf_attribute_type_texcoord: {
-                    pf_attribute_t* attr = &vb->attributes[PF_ATTRIB_TEXCOORD];
-                    pfext_cgltf_copy_accessor_data_INTERNAL(&attr->buffer, attribute->data);
-                    attr->size = attribute->data->count;
-                    attr->type = PF_ATTRIB_FLOAT;
-                    attr->used = true;
-                    attr->comp = 2;
-                } break;
-                case cgltf_attribute_type_normal: {
-                    pf_attribute_t* attr = &vb->attributes[PF_ATTRIB_NORMAL];
-                    pfext_cgltf_copy_accessor_data_INTERNAL(&attr->buffer, attribute->data);
-                    attr->size = attribute->data->count;
-                    attr->type = PF_ATTRIB_FLOAT;
-                    attr->used = true;
-                    attr->comp = 3;
-                } break;
-                case cgltf_attribute_type_color: {
-                    pf_attribute_t* attr = &vb->attributes[PF_ATTRIB_COLOR];
-                    attr->buffer = PF_MALLOC(attribute->data->count * sizeof(pf_color_t));
-                    cgltf_accessor_unpack_floats(attribute->data, (float*)attr->buffer, attribute->data->count * 4);
-                    attr->size = attribute->data->count;
-                    attr->type = PF_ATTRIB_UBYTE;
-                    attr->used = true;
-                    attr->comp = 4;
-                } break;
-                default:
-                    break;
-            }
-        }
+    for (uint64_t i = 0; i < num_attributes && success; ++i) {
+        const pfext_bin_attribute_INTERNAL_t* desc = &attributes[i];
+        if (desc->offset == 0) continue;
 
-        if (primitive->indices != NULL) {
-            vb->num_indices = primitive->indices->count;
-            vb->indices = PF_MALLOC(vb->num_indices * sizeof(uint16_t));
-            for (cgltf_size k = 0; k < primitive->indices->count; ++k) {
-                vb->indices[k] = (uint16_t)cgltf_accessor_read_index(primitive->indices, k);
-            }
+        // NOTE: Each attribute must have an element for every vertex
+        if (i >= PF_MAX_ATTRIBUTES || desc->type > PF_ATTRIB_UNORM_10_10_10_2 || desc->comp == 0 || desc->comp > 4
+            || desc->size < header->num_vertices) {
+            success = false;
+            break;
         }
-    }
 
-    // Load materials
-    /*
-    model.materials_count = data->materials_count;
-    model.materials = PF_CALLOC(data->materials_count, sizeof(material_t));
+        pf_attribute_t* attr = &vb.attributes[i];
+        attr->type = (pf_attrib_type_e)desc->type;
+        attr->comp = (uint8_t)desc->comp;
+        attr->size = (size_t)desc->size;
 
-    for (cgltf_size i = 0; i < data->materials_count; ++i) {
-        cgltf_material* cgltf_material = &data->materials[i];
-        material_t* material = &model.materials[i];
+        // NOTE: The packed types are read as a whole 'uint32_t'
+        size_t elem_size = pf_attribute_get_elem_size(attr);
+        size_t align = (attr->type >= PF_ATTRIB_SNORM_10_10_10_2) ? sizeof(uint32_t) : elem_size / attr->comp;
 
-        material->tex_diffuse = default_texture;
-        material->col_diffuse = PF_WHITE;
+        attr->buffer = (void*)pfext_bin_section_INTERNAL(mapping, desc->offset, desc->size, elem_size, align);
 
-        if (cgltf_material->has_pbr_metallic_roughness) {
-            cgltf_texture_view* texture_view = &cgltf_material->pbr_metallic_roughness.base_color_texture;
-            if (texture_view->texture && texture_view->texture->image) {
-                material->tex_diffuse = load_texture(texture_view->texture->image, filename);
-            }
+        attr->used = success = (attr->buffer != NULL);
+    }
 
-            float* color_factor = cgltf_material->pbr_metallic_roughness.base_color_factor;
-            if (color_factor) material->col_diffuse = pf_color_from_factor(color_factor);
-        }
+    if (success && header->num_indices > 0) {
+        vb.indices = (uint16_t*)pfext_bin_section_INTERNAL(mapping,
+            header->indices_offset, header->num_indices, sizeof(uint16_t), sizeof(uint16_t));
+        success = (vb.indices != NULL) && pfext_check_indices_INTERNAL(vb.indices,
+            header->num_indices, header->num_vertices, header->primitive_restart);
     }
 
-    // Map meshes to materials (assuming one material per mesh for simplicity)
-    model.mesh_material = PF_MALLOC(data->meshes_count * sizeof(size_t));
-    for (cgltf_size i = 0; i < data->meshes_count; ++i) {
-        cgltf_mesh* cgltf_mesh = &data->meshes[i];
-        if (cgltf_mesh->primitives_count > 0) {
-            model.mesh_material[i] = cgltf_mesh->primitives[0].material - data->materials;
-        }
+    for (uint64_t i = 1; i < num_levels && i < PF_MAX_LOD_LEVELS && success && lod != NULL; ++i) {
+        const uint16_t* indices = pfext_bin_section_INTERNAL(mapping,
+            levels[i].offset, levels[i].num_indices, sizeof(uint16_t), sizeof(uint16_t));
+        success = (indices != NULL) && pfext_check_indices_INTERNAL(indices,
+            levels[i].num_indices, header->num_vertices, header->primitive_restart);
     }
-    */
 
-    cgltf_free(data);
+    if (!success) {
+        fprintf(stderr, "ERROR: The binary vertex buffer [%s] is corrupted\n", file_path);
+        pf_mapping_release_INTERNAL(mapping);
+        return (pf_vertexbuffer_t) { 0 };
+    }
 
-    return vbs;
+    vb.num_vertices = header->num_vertices;
+    vb.num_indices = header->num_indices;
+    vb.topology = (pf_topology_e)header->topology;
+    vb.primitive_restart = header->primitive_restart;
+
+    // NOTE: The vertex buffer takes over the reference of the loader
+    vb.mapping = mapping;
+
+    /* LOD chain, also used in place */
+
+    if (lod != NULL && num_levels > 0 && vb.indices != NULL) {
+        lod->indices[0] = vb.indices;
+        lod->num_indices[0] = vb.num_indices;
+        lod->num_levels = 1;
+
+        for (uint64_t i = 1; i < num_levels && i < PF_MAX_LOD_LEVELS; ++i) {
+            uint16_t* indices = (uint16_t*)pfext_bin_section_INTERNAL(mapping,
+                levels[i].offset, levels[i].num_indices, sizeof(uint16_t), sizeof(uint16_t));
+            if (indices == NULL) break;
+
+            lod->indices[i] = indices;
+            lod->num_indices[i] = (uint32_t)levels[i].num_indices;
+            lod->num_levels++;
+        }
+
+        memcpy(lod->center, header->center, sizeof(lod->center));
+        lod->radius = header->radius;
+
+        lod->mapping = mapping;
+        mapping->refs++;
+    }
+
+    return vb;
 }
 
 static void
@@ -409,17 +2126,17 @@ pfext_set_vb_from_par_shapes_mesh_INTERNAL(pf_vertexbuffer_t* vb, par_shapes_mes
     vb->attributes[PF_ATTRIB_TEXCOORD].buffer = mesh->tcoords;
     vb->attributes[PF_ATTRIB_TEXCOORD].size = mesh->npoints;
     vb->attributes[PF_ATTRIB_TEXCOORD].type = PF_ATTRIB_FLOAT;
-    vb->attributes[PF_ATTRIB_TEXCOORD].used = true;
+    vb->attributes[PF_ATTRIB_TEXCOORD].used = (mesh->tcoords != NULL);
     vb->attributes[PF_ATTRIB_TEXCOORD].comp = 2;
 
     vb->attributes[PF_ATTRIB_NORMAL].buffer = mesh->normals;
     vb->attributes[PF_ATTRIB_NORMAL].size = mesh->npoints;
     vb->attributes[PF_ATTRIB_NORMAL].type = PF_ATTRIB_FLOAT;
-    vb->attributes[PF_ATTRIB_NORMAL].used = true;
+    vb->attributes[PF_ATTRIB_NORMAL].used = (mesh->normals != NULL);
     vb->attributes[PF_ATTRIB_NORMAL].comp = 3;
 
     vb->indices = mesh->triangles;
-    vb->num_indices = mesh->ntriangles;
+    vb->num_indices = 3 * mesh->ntriangles;
 }
 
 pf_vertexbuffer_t
@@ -598,4 +2315,498 @@ pfext_vertexbuffer_gen_rock(
     return vb;
 }
 
+/* Optimization Functions */
+
+typedef struct {
+    uint32_t first;     // First triangle of the cluster
+    uint32_t count;     // Number of triangles in the cluster
+    float sort_key;     // Outward facing measure, larger renders first
+} pfext_cluster_INTERNAL_t;
+
+static int
+pfext_cluster_compare_INTERNAL(const void* a, const void* b)
+{
+    float ka = ((const pfext_cluster_INTERNAL_t*)a)->sort_key;
+    float kb = ((const pfext_cluster_INTERNAL_t*)b)->sort_key;
+    return (ka < kb) - (ka > kb);
+}
+
+static int32_t
+pfext_tipsify_skip_dead_end_INTERNAL(
+    const uint32_t* live, const uint32_t* dead_end, uint32_t* dead_end_count,
+    uint32_t* cursor, uint32_t num_vertices)
+{
+    // Look for a vertex recently emitted which still has triangles to render
+    while (*dead_end_count > 0) {
+        uint32_t v = dead_end[--(*dead_end_count)];
+        if (live[v] > 0) return (int32_t)v;
+    }
+
+    // Otherwise take the next vertex in input order which still has triangles
+    while (*cursor < num_vertices) {
+        uint32_t v = (*cursor)++;
+        if (live[v] > 0) return (int32_t)v;
+    }
+
+    return -1;
+}
+
+static uint32_t
+pfext_vertexbuffer_tipsify_INTERNAL(
+    const uint16_t* indices, uint32_t num_triangles, uint32_t num_vertices,
+    uint16_t* out_indices, uint32_t* out_clusters)
+{
+    /*
+        Tipsify (Sander, Nehab & Barczak, 2007)
+        Triangles are emitted by fanning around a vertex, then the next fanning vertex is
+        chosen among the vertices just emitted that will still be in the cache afterwards.
+        The positions where the cache had to be abandoned (dead-ends) are returned as hard
+        cluster boundaries, used afterwards by the overdraw ordering.
+    */
+
+    const uint32_t num_indices = 3 * num_triangles;
+    const uint32_t cache_size = PF_VERTEX_CACHE_SIZE;
+
+    uint32_t* live = PF_CALLOC(num_vertices, sizeof(uint32_t));
+    uint32_t* offsets = PF_CALLOC(num_vertices + 1, sizeof(uint32_t));
+    uint32_t* adjacency = PF_MALLOC(num_indices * sizeof(uint32_t));
+    uint32_t* cache_time = PF_CALLOC(num_vertices, sizeof(uint32_t));
+    uint32_t* dead_end = PF_MALLOC(num_indices * sizeof(uint32_t));
+    uint32_t* candidates = PF_MALLOC(num_indices * sizeof(uint32_t));
+    bool* emitted = PF_CALLOC(num_triangles, sizeof(bool));
+
+    uint32_t num_clusters = 0;
+
+    if (!live || !offsets || !adjacency || !cache_time || !dead_end || !candidates || !emitted) {
+        fprintf(stderr, "ERROR: Unable to allocate memory for vertex cache optimization\n");
+        goto finish;
+    }
+
+    /* Build the vertex to triangles adjacency */
+
+    for (uint32_t i = 0; i < num_indices; ++i) {
+        live[indices[i]]++;
+    }
+
+    for (uint32_t v = 0; v < num_vertices; ++v) {
+        offsets[v + 1] = offsets[v] + live[v];
+    }
+
+    for (uint32_t v = 0; v < num_vertices; ++v) {
+        cache_time[v] = offsets[v]; // NOTE: Used temporarily as fill cursor
+    }
+
+    for (uint32_t i = 0; i < num_indices; ++i) {
+        adjacency[cache_time[indices[i]]++] = i / 3;
+    }
+
+    memset(cache_time, 0, num_vertices * sizeof(uint32_t));
+
+    /* Emit the triangles */
+
+    uint32_t timestamp = cache_size + 1;
+    uint32_t dead_end_count = 0;
+    uint32_t cursor = 0;
+    uint32_t out_count = 0;
+
+    int32_t fanning = pfext_tipsify_skip_dead_end_INTERNAL(
+        live, dead_end, &dead_end_count, &cursor, num_vertices);
+
+    out_clusters[num_clusters++] = 0;
+
+    while (fanning >= 0) {
+        uint32_t num_candidates = 0;
+
+        for (uint32_t a = offsets[fanning]; a < offsets[fanning + 1]; ++a) {
+            uint32_t t = adjacency[a];
+            if (emitted[t]) continue;
+
+            for (int_fast8_t k = 0; k < 3; ++k) {
+                uint32_t v = indices[3 * t + k];
+                out_indices[out_count++] = (uint16_t)v;
+                dead_end[dead_end_count++] = v;
+                candidates[num_candidates++] = v;
+                live[v]--;
+
+                if (timestamp - cache_time[v] > cache_size) {
+                    cache_time[v] = timestamp++;
+                }
+            }
+
+            emitted[t] = true;
+        }
+
+        /* Select the next fanning vertex among the candidates */
+
+        int32_t best = -1;
+        int32_t best_priority = -1;
+
+        for (uint32_t c = 0; c < num_candidates; ++c) {
+            uint32_t v = candidates[c];
+            if (live[v] == 0) continue;
+
+            // NOTE: Only vertices that will still be in the cache after being fanned get a priority
+            int32_t priority = 0;
+            if (timestamp - cache_time[v] + 2 * live[v] <= cache_size) {
+                priority = (int32_t)(timestamp - cache_time[v]);
+            }
+
+            if (priority > best_priority) {
+                best_priority = priority;
+                best = (int32_t)v;
+            }
+        }
+
+        if (best < 0) {
+            best = pfext_tipsify_skip_dead_end_INTERNAL(
+                live, dead_end, &dead_end_count, &cursor, num_vertices);
+
+            if (best >= 0 && out_count < num_indices) {
+                out_clusters[num_clusters++] = out_count / 3;
+            }
+        }
+
+        fanning = best;
+    }
+
+finish:
+    PF_FREE(live);
+    PF_FREE(offsets);
+    PF_FREE(adjacency);
+    PF_FREE(cache_time);
+    PF_FREE(dead_end);
+    PF_FREE(candidates);
+    PF_FREE(emitted);
+
+    return num_clusters;
+}
+
+static uint32_t
+pfext_vertexbuffer_split_clusters_INTERNAL(
+    const uint16_t* indices, uint32_t num_triangles, uint32_t num_vertices,
+    uint32_t* clusters, uint32_t num_clusters)
+{
+    /*
+        Adds soft boundaries inside the hard clusters, wherever the cache miss ratio
+        of the cluster so far is not worse than the one of the whole mesh. This keeps
+        the cache efficiency while giving more freedom to the overdraw ordering.
+        The miss ratio of each cluster is measured from an empty cache, as in Tipsify.
+    */
+
+    uint32_t* cache_time = PF_CALLOC(num_vertices, sizeof(uint32_t));
+    uint32_t* result = PF_MALLOC(num_triangles * sizeof(uint32_t));
+
+    if (cache_time == NULL || result == NULL) {
+        PF_FREE(cache_time);
+        PF_FREE(result);
+        return num_clusters;
+    }
+
+    const uint32_t cache_size = PF_VERTEX_CACHE_SIZE;
+    uint32_t timestamp = cache_size + 1;
+
+    // Measure the global ACMR (average cache miss ratio)
+    uint32_t total_misses = 0;
+    for (uint32_t i = 0; i < 3 * num_triangles; ++i) {
+        uint32_t v = indices[i];
+        if (timestamp - cache_time[v] > cache_size) {
+            cache_time[v] = timestamp++;
+            total_misses++;
+        }
+    }
+
+    const float threshold = 1.05f * (float)total_misses / num_triangles;
+
+    // Split where the local ACMR drops below the global one
+    memset(cache_time, 0, num_vertices * sizeof(uint32_t));
+    timestamp = cache_size + 1;
+
+    uint32_t num_result = 0;
+    uint32_t next_hard = 0;
+    uint32_t cluster_start = 0;
+    uint32_t cluster_misses = 0;
+
+    for (uint32_t t = 0; t < num_triangles; ++t) {
+        bool hard = (next_hard < num_clusters && clusters[next_hard] == t);
+        bool soft = (t > cluster_start && cluster_misses <= threshold * (t - cluster_start));
+
+        if (hard || soft) {
+            result[num_result++] = t;
+            cluster_start = t;
+            cluster_misses = 0;
+            next_hard += hard;
+
+            // NOTE: The cluster may be moved anywhere, its misses are counted from an empty cache
+            timestamp += cache_size + 1;
+        }
+
+        for (int_fast8_t k = 0; k < 3; ++k) {
+            uint32_t v = indices[3 * t + k];
+            if (timestamp - cache_time[v] > cache_size) {
+                cache_time[v] = timestamp++;
+                cluster_misses++;
+            }
+        }
+    }
+
+    memcpy(clusters, result, num_result * sizeof(uint32_t));
+
+    PF_FREE(cache_time);
+    PF_FREE(result);
+
+    return num_result;
+}
+
+static void
+pfext_vertexbuffer_sort_clusters_INTERNAL(
+    const pf_attribute_t* positions, uint16_t* indices, uint32_t num_triangles,
+    const uint32_t* clusters, uint32_t num_clusters)
+{
+    /*
+        Orders the clusters so that the ones facing away from the mesh
+        center are rendered first, they are more likely to occlude the others.
+    */
+
+    pfext_cluster_INTERNAL_t* infos = PF_MALLOC(num_clusters * sizeof(pfext_cluster_INTERNAL_t));
+    pf_vec3_t* centroids = PF_MALLOC(num_clusters * sizeof(pf_vec3_t));
+    pf_vec3_t* normals = PF_MALLOC(num_clusters * sizeof(pf_vec3_t));
+    uint16_t* sorted = PF_MALLOC(3 * num_triangles * sizeof(uint16_t));
+
+    if (!infos || !centroids || !normals || !sorted) {
+        goto finish;
+    }
+
+    const float* points = pf_attribute_get_elem_ptr(positions, 0);
+    const size_t stride = pf_attribute_get_stride(positions) / sizeof(float);
+
+    pf_vec3_t mesh_center = { 0 };
+    float mesh_area = 0;
+
+    for (uint32_t c = 0; c < num_clusters; ++c) {
+        uint32_t first = clusters[c];
+        uint32_t last = (c + 1 < num_clusters) ? clusters[c + 1] : num_triangles;
+
+        infos[c].first = first;
+        infos[c].count = last - first;
+
+        pf_vec3_t center = { 0 };
+        pf_vec3_t normal = { 0 };
+        float area = 0;
+
+        for (uint32_t t = first; t < last; ++t) {
+            const float* p1 = points + indices[3 * t + 0] * stride;
+            const float* p2 = points + indices[3 * t + 1] * stride;
+            const float* p3 = points + indices[3 * t + 2] * stride;
+
+            pf_vec3_t e1, e2, n;
+            pf_vec3_sub(e1, p2, p1);
+            pf_vec3_sub(e2, p3, p1);
+            pf_vec3_cross(n, e1, e2);
+
+            float a = pf_vec3_len(n);
+
+            for (int_fast8_t i = 0; i < 3; ++i) {
+                center[i] += a * (p1[i] + p2[i] + p3[i]) / 3.0f;
+            }
+
+            pf_vec3_add(normal, normal, n);
+            area += a;
+        }
+
+        for (int_fast8_t i = 0; i < 3; ++i) {
+            mesh_center[i] += center[i];
+        }
+
+        if (area > 0) {
+            pf_vec3_scale(center, center, 1.0f / area);
+        }
+
+        pf_vec3_normalize(normal, normal);
+        pf_vec3_copy(centroids[c], center);
+        pf_vec3_copy(normals[c], normal);
+
+        mesh_area += area;
+    }
+
+    if (mesh_area > 0) {
+        pf_vec3_scale(mesh_center, mesh_center, 1.0f / mesh_area);
+    }
+
+    for (uint32_t c = 0; c < num_clusters; ++c) {
+        pf_vec3_t dir;
+        pf_vec3_sub(dir, centroids[c], mesh_center);
+        infos[c].sort_key = pf_vec3_dot(dir, normals[c]);
+    }
+
+    qsort(infos, num_clusters, sizeof(pfext_cluster_INTERNAL_t), pfext_cluster_compare_INTERNAL);
+
+    uint32_t out = 0;
+    for (uint32_t c = 0; c < num_clusters; ++c) {
+        memcpy(sorted + out, indices + 3 * infos[c].first, 3 * infos[c].count * sizeof(uint16_t));
+        out += 3 * infos[c].count;
+    }
+
+    memcpy(indices, sorted, 3 * num_triangles * sizeof(uint16_t));
+
+finish:
+    PF_FREE(infos);
+    PF_FREE(centroids);
+    PF_FREE(normals);
+    PF_FREE(sorted);
+}
+
+static void
+pfext_vertexbuffer_reorder_vertices_INTERNAL(
+    pf_vertexbuffer_t* vb)
+{
+    /*
+        Renumbers the vertices in the order of their first use by the index buffer,
+        the attributes are then permuted in place so that they are fetched linearly.
+        Vertices not referenced by any triangle are moved at the end of the buffers.
+    */
+
+    const uint32_t num_vertices = vb->num_vertices;
+    uint32_t* remap = PF_MALLOC(num_vertices * sizeof(uint32_t));
+    void* tmp = NULL;
+
+    if (remap == NULL) {
+        return;
+    }
+
+    for (uint32_t v = 0; v < num_vertices; ++v) {
+        remap[v] = UINT32_MAX;
+    }
+
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < vb->num_indices; ++i) {
+        uint16_t v = vb->indices[i];
+        if (remap[v] == UINT32_MAX) remap[v] = next++;
+        vb->indices[i] = (uint16_t)remap[v];
+    }
+
+    const uint32_t num_used = next;
+    for (uint32_t v = 0; v < num_vertices; ++v) {
+        if (remap[v] == UINT32_MAX) remap[v] = next++;
+    }
+
+    /*
+        Each buffer is reordered only once, an interleaved buffer being moved as a whole
+        vertex at a time, from the first byte to the last byte used by its attributes.
+    */
+
+    for (int i = 0; i < PF_MAX_ATTRIBUTES; ++i) {
+        pf_attribute_t* attr = &vb->attributes[i];
+        if (!attr->used || attr->buffer == NULL) continue;
+
+        bool done = false;
+        for (int j = 0; j < i; ++j) {
+            if (vb->attributes[j].used && vb->attributes[j].buffer == attr->buffer) {
+                done = true;
+                break;
+            }
+        }
+        if (done) continue;
+
+        size_t stride = pf_attribute_get_stride(attr);
+        size_t begin = attr->offset;
+        size_t end = attr->offset + pf_attribute_get_elem_size(attr);
+
+        for (int j = i + 1; j < PF_MAX_ATTRIBUTES; ++j) {
+            const pf_attribute_t* other = &vb->attributes[j];
+            if (other->used && other->buffer == attr->buffer) {
+                begin = PF_MIN(begin, other->offset);
+                end = PF_MAX(end, other->offset + pf_attribute_get_elem_size(other));
+            }
+        }
+
+        size_t size = PF_MIN(end - begin, stride);
+        char* base = (char*)attr->buffer + begin;
+
+        if (tmp == NULL) {
+            size_t max_stride = 0;
+            for (int j = i; j < PF_MAX_ATTRIBUTES; ++j) {
+                if (vb->attributes[j].used && vb->attributes[j].buffer != NULL) {
+                    max_stride = PF_MAX(max_stride, pf_attribute_get_stride(&vb->attributes[j]));
+                }
+            }
+            tmp = PF_MALLOC(num_vertices * max_stride);
+            if (tmp == NULL) break;
+        }
+
+        for (uint32_t v = 0; v < num_vertices; ++v) {
+            memcpy((char*)tmp + remap[v] * size, base + v * stride, size);
+        }
+
+        for (uint32_t v = 0; v < num_vertices; ++v) {
+            memcpy(base + v * stride, (char*)tmp + v * size, size);
+        }
+    }
+
+    vb->num_vertices = num_used;
+
+    PF_FREE(remap);
+    PF_FREE(tmp);
+}
+
+void
+pfext_vertexbuffer_optimize(
+    pf_vertexbuffer_t* vb)
+{
+    // NOTE: Only indexed triangle lists can be reordered
+    if (vb->indices == NULL || vb->topology != PF_TRIANGLES || vb->primitive_restart) {
+        return;
+    }
+
+    const uint32_t num_triangles = vb->num_indices / 3;
+    const uint32_t num_vertices = vb->num_vertices;
+
+    if (num_triangles == 0 || num_vertices == 0) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < 3 * num_triangles; ++i) {
+        if (vb->indices[i] >= num_vertices) {
+            fprintf(stderr, "ERROR: Unable to optimize vertex buffer, index out of range\n");
+            return;
+        }
+    }
+
+    uint16_t* indices = PF_MALLOC(3 * num_triangles * sizeof(uint16_t));
+    uint32_t* clusters = PF_MALLOC(num_triangles * sizeof(uint32_t));
+
+    if (indices == NULL || clusters == NULL) {
+        fprintf(stderr, "ERROR: Unable to allocate memory for vertex buffer optimization\n");
+        PF_FREE(indices);
+        PF_FREE(clusters);
+        return;
+    }
+
+    /* Reorder triangles for the post-transform vertex cache */
+
+    uint32_t num_clusters = pfext_vertexbuffer_tipsify_INTERNAL(
+        vb->indices, num_triangles, num_vertices, indices, clusters);
+
+    if (num_clusters > 0) {
+        memcpy(vb->indices, indices, 3 * num_triangles * sizeof(uint16_t));
+
+        /* Reorder clusters of triangles to reduce overdraw */
+
+        const pf_attribute_t* positions = &vb->attributes[PF_ATTRIB_POSITION];
+        if (positions->used && positions->type == PF_ATTRIB_FLOAT && positions->comp >= 3) {
+            num_clusters = pfext_vertexbuffer_split_clusters_INTERNAL(
+                vb->indices, num_triangles, num_vertices, clusters, num_clusters);
+            pfext_vertexbuffer_sort_clusters_INTERNAL(
+                positions, vb->indices, num_triangles, clusters, num_clusters);
+        }
+    }
+
+    PF_FREE(indices);
+    PF_FREE(clusters);
+
+    /* Reorder vertices for fetch locality */
+
+    pfext_vertexbuffer_reorder_vertices_INTERNAL(vb);
+}
+
+
 #endif //PF_EXT_VERTEXBUFFER
@@ -168,6 +168,7 @@ pf_renderer_point2d(
         color = rn->conf2d->color_blend(pf_framebuffer_get(&rn->fb, x, y), color);
     }
     pf_framebuffer_put(&rn->fb, x, y, color);
+    pf_framebuffer_damage_add(&rn->damage, x, y, x, y);
 }
 
 void
@@ -187,17 +188,19 @@ pf_renderer_circle2d(
         }
     }
 
+    // Damage
+    pf_framebuffer_damage_add(&rn->damage, cx - radius, cy - radius, cx + radius, cy + radius);
+
     // Rendering
     if (rn->conf2d != NULL && rn->conf2d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_CIRCLE_TRAVEL({
-            pf_color_t* ptr = rn->fb.buffer + offset;
-            *ptr = blend(*ptr, color);
+            pf_framebuffer_blend(&rn->fb, offset, color, blend);
         })
     }
     else {
         PF_CIRCLE_TRAVEL({
-            rn->fb.buffer[offset] = color;
+            pf_framebuffer_store(&rn->fb, offset, color);
         })
     }
 }
@@ -219,39 +222,38 @@ pf_renderer_circle2d_gradient(
         }
     }
 
+    // Damage
+    pf_framebuffer_damage_add(&rn->damage, cx - radius, cy - radius, cx + radius, cy + radius);
+
     // Rendering
     if (rn->conf2d != NULL && rn->conf2d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_CIRCLE_TRAVEL_EX({
-            pf_color_t* ptr = rn->fb.buffer + offset;
-            *ptr = blend(*ptr, pf_color_lerpi(c1, c2,
-                sqrtf((i - cx) * (i - cx) + (cy + y - cy) * (cy + y - cy)), radius));
+            pf_framebuffer_blend(&rn->fb, offset, pf_color_lerpi(c1, c2,
+                sqrtf((i - cx) * (i - cx) + (cy + y - cy) * (cy + y - cy)), radius), blend);
         }, {
-            pf_color_t* ptr = rn->fb.buffer + offset;
-            *ptr = blend(*ptr, pf_color_lerpi(c1, c2,
-                sqrtf((i - cx) * (i - cx) + (cy - y - cy) * (cy - y - cy)), radius));
+            pf_framebuffer_blend(&rn->fb, offset, pf_color_lerpi(c1, c2,
+                sqrtf((i - cx) * (i - cx) + (cy - y - cy) * (cy - y - cy)), radius), blend);
         }, {
-            pf_color_t* ptr = rn->fb.buffer + offset;
-            *ptr = blend(*ptr, pf_color_lerpi(c1, c2,
-                sqrtf((i - cx) * (i - cx) + (cy + x - cy) * (cy + x - cy)), radius));
+            pf_framebuffer_blend(&rn->fb, offset, pf_color_lerpi(c1, c2,
+                sqrtf((i - cx) * (i - cx) + (cy + x - cy) * (cy + x - cy)), radius), blend);
         }, {
-            pf_color_t* ptr = rn->fb.buffer + offset;
-            *ptr = blend(*ptr, pf_color_lerpi(c1, c2,
-                sqrtf((i - cx) * (i - cx) + (cy - x - cy) * (cy - x - cy)), radius));
+            pf_framebuffer_blend(&rn->fb, offset, pf_color_lerpi(c1, c2,
+                sqrtf((i - cx) * (i - cx) + (cy - x - cy) * (cy - x - cy)), radius), blend);
         })
     } else {
         PF_CIRCLE_TRAVEL_EX({
-            rn->fb.buffer[offset] = pf_color_lerpi(c1, c2,
-                sqrtf((i - cx) * (i - cx) + (cy + y - cy) * (cy + y - cy)), radius);
+            pf_framebuffer_store(&rn->fb, offset, pf_color_lerpi(c1, c2,
+                sqrtf((i - cx) * (i - cx) + (cy + y - cy) * (cy + y - cy)), radius));
         }, {
-            rn->fb.buffer[offset] = pf_color_lerpi(c1, c2,
-                sqrtf((i - cx) * (i - cx) + (cy - y - cy) * (cy - y - cy)), radius);
+            pf_framebuffer_store(&rn->fb, offset, pf_color_lerpi(c1, c2,
+                sqrtf((i - cx) * (i - cx) + (cy - y - cy) * (cy - y - cy)), radius));
         }, {
-            rn->fb.buffer[offset] = pf_color_lerpi(c1, c2,
-                sqrtf((i - cx) * (i - cx) + (cy + x - cy) * (cy + x - cy)), radius);
+            pf_framebuffer_store(&rn->fb, offset, pf_color_lerpi(c1, c2,
+                sqrtf((i - cx) * (i - cx) + (cy + x - cy) * (cy + x - cy)), radius));
         }, {
-            rn->fb.buffer[offset] = pf_color_lerpi(c1, c2,
-                sqrtf((i - cx) * (i - cx) + (cy - x - cy) * (cy - x - cy)), radius);
+            pf_framebuffer_store(&rn->fb, offset, pf_color_lerpi(c1, c2,
+                sqrtf((i - cx) * (i - cx) + (cy - x - cy) * (cy - x - cy)), radius));
         })
     }
 }
@@ -281,25 +283,26 @@ pf_renderer_circle2d_map(
         if (proc->uniforms != NULL) uniforms = proc->uniforms;
     }
 
+    // Damage
+    pf_framebuffer_damage_add(&rn->damage, cx - radius, cy - radius, cx + radius, cy + radius);
+
     // Rendering
     if (rn->conf2d != NULL && rn->conf2d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_CIRCLE_TRAVEL({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + offset;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
             fragment(rn, &vertex, &final_color, uniforms);
-            *ptr = blend(*ptr, final_color);
+            pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
         })
     } else {
         PF_CIRCLE_TRAVEL({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + offset;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
             fragment(rn, &vertex, &final_color, uniforms);
-            *ptr = final_color;
+            pf_framebuffer_store(&rn->fb, offset, final_color);
         })
     }
 }
@@ -321,18 +324,20 @@ pf_renderer_circle2d_lines(
         }
     }
 
+    // Damage
+    pf_framebuffer_damage_add(&rn->damage, cx - radius, cy - radius, cx + radius, cy + radius);
+
     // Rendering
     if (rn->conf2d != NULL && rn->conf2d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         if (blend != NULL) {
             PF_CIRCLE_LINE_TRAVEL({
-                pf_color_t* ptr = rn->fb.buffer + offset;
-                *ptr = blend(*ptr, color);
+                pf_framebuffer_blend(&rn->fb, offset, color, blend);
             })
         }
     } else {
         PF_CIRCLE_LINE_TRAVEL({
-            rn->fb.buffer[offset] = color;
+            pf_framebuffer_store(&rn->fb, offset, color);
         })
     }
 }
@@ -362,25 +367,26 @@ pf_renderer_circle2d_lines_map(
         if (proc->uniforms != NULL) uniforms = proc->uniforms;
     }
 
+    // Damage
+    pf_framebuffer_damage_add(&rn->damage, cx - radius, cy - radius, cx + radius, cy + radius);
+
     // Rendering
     if (rn->conf2d != NULL && rn->conf2d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_CIRCLE_LINE_TRAVEL({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + offset;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
             fragment(rn, &vertex, &final_color, uniforms);
-            *ptr = blend(*ptr, final_color);
+            pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
         })
     } else {
         PF_CIRCLE_LINE_TRAVEL({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + offset;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
             fragment(rn, &vertex, &final_color, uniforms);
-            *ptr = final_color;
+            pf_framebuffer_store(&rn->fb, offset, final_color);
         })
     }
 }
@@ -26,6 +26,7 @@
     if (pf_clip_line2d_INTERNAL(&x1, &y1, &x2, &y2, 0, 0, rn->fb.w - 1, rn->fb.h - 1) == 0) {    \
         return;                                                                         \
     }                                                                                   \
+    pf_framebuffer_damage_add(&rn->damage, x1, y1, x2, y2);                             \
     int_fast8_t y_longer = 0;                                                           \
     int short_len = y2 - y1;                                                            \
     int long_len = x2 - x1;                                                             \
@@ -231,13 +232,12 @@ pf_renderer_line2d(
     if (rn->conf2d != NULL && rn->conf2d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_LINE_TRAVEL({
-            pf_color_t* ptr = rn->fb.buffer + offset;
-            *ptr = blend(*ptr, color);
+            pf_framebuffer_blend(&rn->fb, offset, color, blend);
         })
     }
     else {
         PF_LINE_TRAVEL({
-            rn->fb.buffer[offset] = color;
+            pf_framebuffer_store(&rn->fb, offset, color);
         })
     }
 }
@@ -260,12 +260,11 @@ pf_renderer_line2d_gradient(
     if (rn->conf2d != NULL && rn->conf2d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_LINE_TRAVEL({
-            pf_color_t* ptr = rn->fb.buffer + offset;
-            *ptr = blend(*ptr, pf_color_lerpi(c1, c2, i, end));
+            pf_framebuffer_blend(&rn->fb, offset, pf_color_lerpi(c1, c2, i, end), blend);
         })
     } else {
         PF_LINE_TRAVEL({
-            rn->fb.buffer[offset] = pf_color_lerpi(c1, c2, i, end);
+            pf_framebuffer_store(&rn->fb, offset, pf_color_lerpi(c1, c2, i, end));
         })
     }
 }
@@ -296,20 +295,18 @@ pf_renderer_line2d_map(
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_LINE_TRAVEL({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + offset;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
             fragment(rn, &vertex, &final_color, uniforms);
-            *ptr = blend(*ptr, final_color);
+            pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
         })
     } else {
         PF_LINE_TRAVEL({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + offset;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
             fragment(rn, &vertex, &final_color, uniforms);
-            *ptr = final_color;
+            pf_framebuffer_store(&rn->fb, offset, final_color);
         })
     }
 }
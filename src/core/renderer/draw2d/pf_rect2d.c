@@ -85,6 +85,7 @@ pf_renderer_rect2d(
         int ymin = PF_CLAMP(PF_MIN(PF_MIN(p1[1], p2[1]), PF_MIN(p3[1], p4[1])), 0, (int)rn->fb.h - 1);
         int xmax = PF_CLAMP(PF_MAX(PF_MAX(p1[0], p2[0]), PF_MAX(p3[0], p4[0])), 0, (int)rn->fb.w - 1);
         int ymax = PF_CLAMP(PF_MAX(PF_MAX(p1[1], p2[1]), PF_MAX(p3[1], p4[1])), 0, (int)rn->fb.h - 1);
+        pf_framebuffer_damage_add(&rn->damage, xmin, ymin, xmax, ymax);
 
         // Invert View Matrix
         pf_mat3_t mat_view_inv;
@@ -95,24 +96,22 @@ pf_renderer_rect2d(
         if (rn->conf2d != NULL && rn->conf2d->color_blend != NULL) {
             pf_color_blend_fn blend = rn->conf2d->color_blend;
             PF_RECT_TRANSFORM_TRAVEL_OMP({
-                pf_color_t* ptr = rn->fb.buffer + offset;
-                *ptr = blend(*ptr, color);
+                pf_framebuffer_blend(&rn->fb, offset, color, blend);
             })
         } else {
             PF_RECT_TRANSFORM_TRAVEL_OMP({
-                rn->fb.buffer[offset] = color;
+                pf_framebuffer_store(&rn->fb, offset, color);
             })
         }
 #else
         if (rn->conf2d != NULL && rn->conf2d->color_blend != NULL) {
             pf_color_blend_fn blend = rn->conf2d->color_blend;
             PF_RECT_TRANSFORM_TRAVEL({
-                pf_color_t* ptr = rn->fb.buffer + offset;
-                *ptr = blend(*ptr, color);
+                pf_framebuffer_blend(&rn->fb, offset, color, blend);
             })
         } else {
             PF_RECT_TRANSFORM_TRAVEL({
-                rn->fb.buffer[offset] = color;
+                pf_framebuffer_store(&rn->fb, offset, color);
             })
         }
 #endif
@@ -121,28 +120,27 @@ pf_renderer_rect2d(
         int ymin = PF_CLAMP(y1, 0, (int)rn->fb.h - 1);
         int xmax = PF_CLAMP(x2, 0, (int)rn->fb.w - 1);
         int ymax = PF_CLAMP(y2, 0, (int)rn->fb.h - 1);
+        pf_framebuffer_damage_add(&rn->damage, xmin, ymin, xmax, ymax);
 #if defined(_OPENMP)
         if (rn->conf2d != NULL && rn->conf2d->color_blend != NULL) {
             pf_color_blend_fn blend = rn->conf2d->color_blend;
             PF_RECT_TRAVEL_OMP({
-                pf_color_t* ptr = rn->fb.buffer + offset;
-                *ptr = blend(*ptr, color);
+                pf_framebuffer_blend(&rn->fb, offset, color, blend);
             })
         } else {
             PF_RECT_TRAVEL_OMP({
-                rn->fb.buffer[offset] = color;
+                pf_framebuffer_store(&rn->fb, offset, color);
             })
         }
 #else
         if (rn->conf2d != NULL && rn->conf2d->color_blend != NULL) {
             pf_color_blend_fn blend = rn->conf2d->color_blend;
             PF_RECT_TRAVEL({
-                pf_color_t* ptr = rn->fb.buffer + offset;
-                *ptr = blend(*ptr, color);
+                pf_framebuffer_blend(&rn->fb, offset, color, blend);
             })
         } else {
             PF_RECT_TRAVEL({
-                rn->fb.buffer[offset] = color;
+                pf_framebuffer_store(&rn->fb, offset, color);
             })
         }
 #endif
@@ -184,6 +182,7 @@ pf_renderer_rect2d_gradient(
         int ymin = PF_CLAMP(PF_MIN(PF_MIN(p1[1], p2[1]), PF_MIN(p3[1], p4[1])), 0, (int)rn->fb.h - 1);
         int xmax = PF_CLAMP(PF_MAX(PF_MAX(p1[0], p2[0]), PF_MAX(p3[0], p4[0])), 0, (int)rn->fb.w - 1);
         int ymax = PF_CLAMP(PF_MAX(PF_MAX(p1[1], p2[1]), PF_MAX(p3[1], p4[1])), 0, (int)rn->fb.h - 1);
+        pf_framebuffer_damage_add(&rn->damage, xmin, ymin, xmax, ymax);
 
         // Invert View Matrix
         pf_mat3_t mat_view_inv;
@@ -196,10 +195,9 @@ pf_renderer_rect2d_gradient(
             PF_RECT_TRANSFORM_TRAVEL_OMP({
                 int ix = x - x1;
                 int iy = y - y1;
-                pf_color_t* ptr = rn->fb.buffer + offset;
                 pf_color_t color_top = pf_color_lerpi(col_tl, col_tr, ix, w);
                 pf_color_t color_bottom = pf_color_lerpi(col_bl, col_br, ix, w);
-                *ptr = blend(*ptr, pf_color_lerpi(color_top, color_bottom, iy, h));
+                pf_framebuffer_blend(&rn->fb, offset, pf_color_lerpi(color_top, color_bottom, iy, h), blend);
             })
         } else {
             PF_RECT_TRANSFORM_TRAVEL_OMP({
@@ -207,7 +205,7 @@ pf_renderer_rect2d_gradient(
                 int iy = y - y1;
                 pf_color_t color_top = pf_color_lerpi(col_tl, col_tr, ix, w);
                 pf_color_t color_bottom = pf_color_lerpi(col_bl, col_br, ix, w);
-                rn->fb.buffer[offset] = pf_color_lerpi(color_top, color_bottom, iy, h);
+                pf_framebuffer_store(&rn->fb, offset, pf_color_lerpi(color_top, color_bottom, iy, h));
             })
         }
 #else
@@ -216,10 +214,9 @@ pf_renderer_rect2d_gradient(
             PF_RECT_TRANSFORM_TRAVEL({
                 int ix = x - x1;
                 int iy = y - y1;
-                pf_color_t* ptr = rn->fb.buffer + offset;
                 pf_color_t color_top = pf_color_lerpi(col_tl, col_tr, ix, w);
                 pf_color_t color_bottom = pf_color_lerpi(col_bl, col_br, ix, w);
-                *ptr = blend(*ptr, pf_color_lerpi(color_top, color_bottom, iy, h));
+                pf_framebuffer_blend(&rn->fb, offset, pf_color_lerpi(color_top, color_bottom, iy, h), blend);
             })
         } else {
             PF_RECT_TRANSFORM_TRAVEL({
@@ -227,7 +224,7 @@ pf_renderer_rect2d_gradient(
                 int iy = y - y1;
                 pf_color_t color_top = pf_color_lerpi(col_tl, col_tr, ix, w);
                 pf_color_t color_bottom = pf_color_lerpi(col_bl, col_br, ix, w);
-                rn->fb.buffer[offset] = pf_color_lerpi(color_top, color_bottom, iy, h);
+                pf_framebuffer_store(&rn->fb, offset, pf_color_lerpi(color_top, color_bottom, iy, h));
             })
         }
 #endif
@@ -236,16 +233,16 @@ pf_renderer_rect2d_gradient(
         int ymin = PF_CLAMP(y1, 0, (int)rn->fb.h - 1);
         int xmax = PF_CLAMP(x2, 0, (int)rn->fb.w - 1);
         int ymax = PF_CLAMP(y2, 0, (int)rn->fb.h - 1);
+        pf_framebuffer_damage_add(&rn->damage, xmin, ymin, xmax, ymax);
 #if defined(_OPENMP)
         if (rn->conf2d != NULL && rn->conf2d->color_blend != NULL) {
             pf_color_blend_fn blend = rn->conf2d->color_blend;
             PF_RECT_TRAVEL_OMP({
                 int ix = x - x1;
                 int iy = y - y1;
-                pf_color_t* ptr = rn->fb.buffer + offset;
                 pf_color_t color_top = pf_color_lerpi(col_tl, col_tr, ix, w);
                 pf_color_t color_bottom = pf_color_lerpi(col_bl, col_br, ix, w);
-                *ptr = blend(*ptr, pf_color_lerpi(color_top, color_bottom, iy, h));
+                pf_framebuffer_blend(&rn->fb, offset, pf_color_lerpi(color_top, color_bottom, iy, h), blend);
             })
         } else {
             PF_RECT_TRAVEL_OMP({
@@ -253,7 +250,7 @@ pf_renderer_rect2d_gradient(
                 int iy = y - y1;
                 pf_color_t color_top = pf_color_lerpi(col_tl, col_tr, ix, w);
                 pf_color_t color_bottom = pf_color_lerpi(col_bl, col_br, ix, w);
-                rn->fb.buffer[offset] = pf_color_lerpi(color_top, color_bottom, iy, h);
+                pf_framebuffer_store(&rn->fb, offset, pf_color_lerpi(color_top, color_bottom, iy, h));
             })
         }
 #else
@@ -262,10 +259,9 @@ pf_renderer_rect2d_gradient(
             PF_RECT_TRAVEL({
                 int ix = x - x1;
                 int iy = y - y1;
-                pf_color_t* ptr = rn->fb.buffer + offset;
                 pf_color_t color_top = pf_color_lerpi(col_tl, col_tr, ix, w);
                 pf_color_t color_bottom = pf_color_lerpi(col_bl, col_br, ix, w);
-                *ptr = blend(*ptr, pf_color_lerpi(color_top, color_bottom, iy, h));
+                pf_framebuffer_blend(&rn->fb, offset, pf_color_lerpi(color_top, color_bottom, iy, h), blend);
             })
         } else {
             PF_RECT_TRAVEL({
@@ -273,7 +269,7 @@ pf_renderer_rect2d_gradient(
                 int iy = y - y1;
                 pf_color_t color_top = pf_color_lerpi(col_tl, col_tr, ix, w);
                 pf_color_t color_bottom = pf_color_lerpi(col_bl, col_br, ix, w);
-                rn->fb.buffer[offset] = pf_color_lerpi(color_top, color_bottom, iy, h);
+                pf_framebuffer_store(&rn->fb, offset, pf_color_lerpi(color_top, color_bottom, iy, h));
             })
         }
 #endif
@@ -319,6 +315,7 @@ pf_renderer_rect2d_map(
         int ymin = PF_CLAMP(PF_MIN(PF_MIN(p1[1], p2[1]), PF_MIN(p3[1], p4[1])), 0, (int)rn->fb.h - 1);
         int xmax = PF_CLAMP(PF_MAX(PF_MAX(p1[0], p2[0]), PF_MAX(p3[0], p4[0])), 0, (int)rn->fb.w - 1);
         int ymax = PF_CLAMP(PF_MAX(PF_MAX(p1[1], p2[1]), PF_MAX(p3[1], p4[1])), 0, (int)rn->fb.h - 1);
+        pf_framebuffer_damage_add(&rn->damage, xmin, ymin, xmax, ymax);
 
         // Invert View Matrix
         pf_mat3_t mat_view_inv;
@@ -330,20 +327,18 @@ pf_renderer_rect2d_map(
             pf_color_blend_fn blend = rn->conf2d->color_blend;
             PF_RECT_TRANSFORM_TRAVEL_OMP({
                 pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-                pf_color_t *ptr = rn->fb.buffer + offset;
-                pf_color_t final_color = *ptr;
+                pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
                 fragment(rn, &vertex, &final_color, uniforms);
-                *ptr = blend(*ptr, final_color);
+                pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
             })
         } else {
             PF_RECT_TRANSFORM_TRAVEL_OMP({
                 pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-                pf_color_t *ptr = rn->fb.buffer + offset;
-                pf_color_t final_color = *ptr;
+                pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
                 fragment(rn, &vertex, &final_color, uniforms);
-                *ptr = final_color;
+                pf_framebuffer_store(&rn->fb, offset, final_color);
             })
         }
 #else
@@ -351,20 +346,18 @@ pf_renderer_rect2d_map(
             pf_color_blend_fn blend = rn->conf2d->color_blend;
             PF_RECT_TRANSFORM_TRAVEL({
                 pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-                pf_color_t *ptr = rn->fb.buffer + offset;
-                pf_color_t final_color = *ptr;
+                pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
                 fragment(rn, &vertex, &final_color, uniforms);
-                *ptr = blend(*ptr, final_color);
+                pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
             })
         } else {
             PF_RECT_TRANSFORM_TRAVEL({
                 pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-                pf_color_t *ptr = rn->fb.buffer + offset;
-                pf_color_t final_color = *ptr;
+                pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
                 fragment(rn, &vertex, &final_color, uniforms);
-                *ptr = final_color;
+                pf_framebuffer_store(&rn->fb, offset, final_color);
             })
         }
 #endif
@@ -373,25 +366,24 @@ pf_renderer_rect2d_map(
         int ymin = PF_CLAMP(y1, 0, (int)rn->fb.h - 1);
         int xmax = PF_CLAMP(x2, 0, (int)rn->fb.w - 1);
         int ymax = PF_CLAMP(y2, 0, (int)rn->fb.h - 1);
+        pf_framebuffer_damage_add(&rn->damage, xmin, ymin, xmax, ymax);
 #if defined(_OPENMP)
         if (rn->conf2d != NULL && rn->conf2d->color_blend != NULL) {
             pf_color_blend_fn blend = rn->conf2d->color_blend;
             PF_RECT_TRAVEL_OMP({
                 pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-                pf_color_t *ptr = rn->fb.buffer + offset;
-                pf_color_t final_color = *ptr;
+                pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
                 fragment(rn, &vertex, &final_color, uniforms);
-                *ptr = blend(*ptr, final_color);
+                pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
             })
         } else {
             PF_RECT_TRAVEL_OMP({
                 pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-                pf_color_t *ptr = rn->fb.buffer + offset;
-                pf_color_t final_color = *ptr;
+                pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
                 fragment(rn, &vertex, &final_color, uniforms);
-                *ptr = final_color;
+                pf_framebuffer_store(&rn->fb, offset, final_color);
             })
         }
 #else
@@ -399,20 +391,18 @@ pf_renderer_rect2d_map(
             pf_color_blend_fn blend = rn->conf2d->color_blend;
             PF_RECT_TRAVEL({
                 pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-                pf_color_t *ptr = rn->fb.buffer + offset;
-                pf_color_t final_color = *ptr;
+                pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
                 fragment(rn, &vertex, &final_color, uniforms);
-                *ptr = blend(*ptr, final_color);
+                pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
             })
         } else {
             PF_RECT_TRAVEL({
                 pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-                pf_color_t *ptr = rn->fb.buffer + offset;
-                pf_color_t final_color = *ptr;
+                pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
                 fragment(rn, &vertex, &final_color, uniforms);
-                *ptr = final_color;
+                pf_framebuffer_store(&rn->fb, offset, final_color);
             })
         }
 #endif
@@ -0,0 +1,435 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "pixelfactory/core/pf_renderer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Internal Sprite Batch Definitions */
+
+// NOTE: The corners of the sprites are snapped to this fraction of a pixel, so that
+//       sprites sharing a side cover each of its pixels exactly once, and those whose
+//       corners go beyond PF_SPRITE_MAX_COORD pixels are skipped to avoid overflows.
+#define PF_SPRITE_SUBPIXEL_BITS 8
+#define PF_SPRITE_SUBPIXEL_SCALE (1 << PF_SPRITE_SUBPIXEL_BITS)
+#define PF_SPRITE_MAX_COORD (1 << 20)
+
+/* Internal Sprite Batch Types */
+
+// NOTE: 'inv' gives the sprite space coordinates of the center of the pixel (x, y),
+//       as lx = inv[0] * x + inv[1] * y + inv[2] and ly = inv[3] * x + inv[4] * y + inv[5].
+//       The texel space coordinates are then 'origin + sign * l'.
+//       'edges' are the functions a * px + b * py + c of the sides of the snapped quad,
+//       positive inside, with (px, py) in 1/PF_SPRITE_SUBPIXEL_SCALE pixel units.
+typedef struct {
+    const pf_texture2d_t* texture;
+    int64_t edges[4][3];
+    float inv[6];
+    float origin[2];
+    float sign[2];
+    int rect[4];
+    int bounds[4];
+    pf_color_t tint;
+    pf_texture2d_filter_e filter;
+    int layer;
+    size_t index;
+} pf_sprite2d_INTERNAL_t;
+
+/* Internal Sprite Batch Functions */
+
+static inline int64_t
+pf_sprite2d_floor_div_INTERNAL(int64_t n, int64_t d)
+{
+    // NOTE: 'd' must be positive
+    int64_t q = n / d;
+    return (n % d != 0 && n < 0) ? q - 1 : q;
+}
+
+static bool
+pf_sprite2d_prepare_INTERNAL(
+    pf_sprite2d_INTERNAL_t* out,
+    const pf_sprite2d_t* sprite,
+    const pf_mat3_t view,
+    int fb_w, int fb_h)
+{
+    const pf_texture2d_t* tex = sprite->texture;
+
+    if (tex == NULL || tex->texels == NULL) {
+        return false;
+    }
+
+    /* Source rectangle */
+
+    int x1 = sprite->src_rect[0], y1 = sprite->src_rect[1];
+    int x2 = sprite->src_rect[2], y2 = sprite->src_rect[3];
+
+    const PF_MATH_FLOAT w = abs(x2 - x1);
+    const PF_MATH_FLOAT h = abs(y2 - y1);
+
+    out->sign[0] = (x2 < x1) ? -1.0f : 1.0f;
+    out->sign[1] = (y2 < y1) ? -1.0f : 1.0f;
+    out->origin[0] = (float)x1;
+    out->origin[1] = (float)y1;
+
+    out->rect[0] = PF_CLAMP(PF_MIN(x1, x2), 0, (int)tex->w);
+    out->rect[1] = PF_CLAMP(PF_MIN(y1, y2), 0, (int)tex->h);
+    out->rect[2] = PF_CLAMP(PF_MAX(x1, x2), 0, (int)tex->w);
+    out->rect[3] = PF_CLAMP(PF_MAX(y1, y2), 0, (int)tex->h);
+
+    if (out->rect[0] >= out->rect[2] || out->rect[1] >= out->rect[3]) {
+        return false;
+    }
+
+    /* Complete transform and its inverse */
+
+    pf_mat3_t mat;
+    if (view != NULL) {
+        pf_mat3_mul_r(mat, view, sprite->transform);
+    } else {
+        pf_mat3_copy(mat, sprite->transform);
+    }
+
+    PF_MATH_FLOAT det = mat[0] * mat[4] - mat[1] * mat[3];
+    if (det == 0) {
+        return false;
+    }
+
+    PF_MATH_FLOAT inv_det = 1.0 / det;
+    PF_MATH_FLOAT inv[6] = {
+        mat[4] * inv_det, -mat[1] * inv_det, (mat[1] * mat[5] - mat[2] * mat[4]) * inv_det,
+        -mat[3] * inv_det, mat[0] * inv_det, (mat[2] * mat[3] - mat[0] * mat[5]) * inv_det
+    };
+
+    // NOTE: The offsets include the half pixel to the centers
+    inv[2] += 0.5 * (inv[0] + inv[1]);
+    inv[5] += 0.5 * (inv[3] + inv[4]);
+
+    for (int i = 0; i < 6; ++i) {
+        out->inv[i] = (float)inv[i];
+    }
+
+    /* Snapped corners and edge functions */
+
+    const PF_MATH_FLOAT corners[4][2] = {
+        { 0, 0 }, { w, 0 }, { w, h }, { 0, h }
+    };
+
+    int64_t px[4], py[4];
+
+    for (int i = 0; i < 4; ++i) {
+        PF_MATH_FLOAT x = mat[0] * corners[i][0] + mat[1] * corners[i][1] + mat[2];
+        PF_MATH_FLOAT y = mat[3] * corners[i][0] + mat[4] * corners[i][1] + mat[5];
+        if (!(fabs(x) < PF_SPRITE_MAX_COORD && fabs(y) < PF_SPRITE_MAX_COORD)) {
+            return false;
+        }
+        px[i] = llround(x * PF_SPRITE_SUBPIXEL_SCALE);
+        py[i] = llround(y * PF_SPRITE_SUBPIXEL_SCALE);
+    }
+
+    // NOTE: The corners turn the other way when the transform mirrors the sprite
+    const int64_t orientation = (det > 0) ? 1 : -1;
+
+    for (int i = 0; i < 4; ++i) {
+        int j = (i + 1) % 4;
+        int64_t dx = px[j] - px[i];
+        int64_t dy = py[j] - py[i];
+        out->edges[i][0] = -dy * orientation;
+        out->edges[i][1] = dx * orientation;
+        out->edges[i][2] = (dy * px[i] - dx * py[i]) * orientation;
+    }
+
+    /* Screen bounds */
+
+    int64_t xmin = px[0], ymin = py[0];
+    int64_t xmax = px[0], ymax = py[0];
+
+    for (int i = 1; i < 4; ++i) {
+        xmin = PF_MIN(xmin, px[i]), xmax = PF_MAX(xmax, px[i]);
+        ymin = PF_MIN(ymin, py[i]), ymax = PF_MAX(ymax, py[i]);
+    }
+
+    // NOTE: Pixels whose center is within the snapped bounds, before clipping
+    const int64_t half = PF_SPRITE_SUBPIXEL_SCALE / 2;
+    int64_t bx0 = -pf_sprite2d_floor_div_INTERNAL(half - xmin, PF_SPRITE_SUBPIXEL_SCALE);
+    int64_t by0 = -pf_sprite2d_floor_div_INTERNAL(half - ymin, PF_SPRITE_SUBPIXEL_SCALE);
+    int64_t bx1 = pf_sprite2d_floor_div_INTERNAL(xmax - half, PF_SPRITE_SUBPIXEL_SCALE);
+    int64_t by1 = pf_sprite2d_floor_div_INTERNAL(ymax - half, PF_SPRITE_SUBPIXEL_SCALE);
+
+    if (bx0 > bx1 || by0 > by1 || bx1 < 0 || by1 < 0 || bx0 >= fb_w || by0 >= fb_h) {
+        return false;
+    }
+
+    out->bounds[0] = (int)PF_MAX(bx0, 0);
+    out->bounds[1] = (int)PF_MAX(by0, 0);
+    out->bounds[2] = (int)PF_MIN(bx1, fb_w - 1);
+    out->bounds[3] = (int)PF_MIN(by1, fb_h - 1);
+
+    out->texture = tex;
+    out->tint = sprite->tint;
+    out->filter = sprite->filter;
+    out->layer = sprite->layer;
+
+    return true;
+}
+
+static int
+pf_sprite2d_compare_INTERNAL(
+    const void* a,
+    const void* b)
+{
+    const pf_sprite2d_INTERNAL_t* sa = a;
+    const pf_sprite2d_INTERNAL_t* sb = b;
+
+    if (sa->layer != sb->layer) {
+        return (sa->layer < sb->layer) ? -1 : 1;
+    }
+    if (sa->texture != sb->texture) {
+        return ((uintptr_t)sa->texture < (uintptr_t)sb->texture) ? -1 : 1;
+    }
+    return (sa->index < sb->index) ? -1 : (sa->index > sb->index);
+}
+
+static inline void
+pf_sprite2d_clip_span_INTERNAL(
+    const int64_t edge[3], int y,
+    int* x_min, int* x_max)
+{
+    /*
+        Restricts [x_min, x_max] to the pixels whose center is inside the edge. Pixels
+        exactly on it belong to the side its gradient points to, as the edges shared by
+        two sprites are opposed, each of these pixels is drawn by only one of them.
+    */
+
+    const int64_t half = PF_SPRITE_SUBPIXEL_SCALE / 2;
+    const int64_t a = edge[0] * PF_SPRITE_SUBPIXEL_SCALE;
+    const int64_t k = edge[0] * half + edge[1] * ((int64_t)y * PF_SPRITE_SUBPIXEL_SCALE + half) + edge[2];
+    const int64_t t = (edge[0] > 0 || (edge[0] == 0 && edge[1] > 0)) ? 0 : 1;
+
+    // NOTE: The pixel x is inside when a * x + k >= t
+    const int64_t n = t - k;
+
+    if (a > 0) {
+        int64_t x = -pf_sprite2d_floor_div_INTERNAL(-n, a);
+        if (x > *x_min) *x_min = (x > *x_max) ? *x_max + 1 : (int)x;
+    } else if (a < 0) {
+        int64_t x = pf_sprite2d_floor_div_INTERNAL(-n, -a);
+        if (x < *x_max) *x_max = (x < *x_min) ? *x_min - 1 : (int)x;
+    } else if (n > 0) {
+        *x_max = *x_min - 1;
+    }
+}
+
+static void
+pf_sprite2d_draw_INTERNAL(
+    pf_framebuffer_t* fb,
+    const pf_sprite2d_INTERNAL_t* sprite,
+    pf_color_blend_fn blend,
+    pf_color_blend_span_fn blend_span,
+    int x_min, int y_min,
+    int x_max, int y_max)
+{
+    pf_color_t span[PF_SPRITE_TILE_SIZE];
+
+    const bool tinted = (sprite->tint.v != PF_WHITE.v);
+
+    for (int y = y_min; y <= y_max; ++y) {
+        float lx_row = sprite->inv[1] * y + sprite->inv[2];
+        float ly_row = sprite->inv[4] * y + sprite->inv[5];
+
+        /* Clip the row to the sprite */
+
+        int xs = x_min, xe = x_max;
+        for (int i = 0; i < 4 && xs <= xe; ++i) {
+            pf_sprite2d_clip_span_INTERNAL(sprite->edges[i], y, &xs, &xe);
+        }
+
+        if (xs > xe) continue;
+
+        /* Fetch the texels of the span */
+
+        int count = xe - xs + 1;
+        float lx = lx_row + sprite->inv[0] * xs;
+        float ly = ly_row + sprite->inv[3] * xs;
+
+        pf_texture2d_fetch_span(sprite->texture, span, sprite->rect,
+            sprite->origin[0] + sprite->sign[0] * lx,
+            sprite->origin[1] + sprite->sign[1] * ly,
+            sprite->sign[0] * sprite->inv[0],
+            sprite->sign[1] * sprite->inv[3],
+            sprite->filter, count);
+
+        if (tinted) {
+            for (int i = 0; i < count; ++i) {
+                span[i] = pf_color_blend_mul(span[i], sprite->tint);
+            }
+        }
+
+        /* Write the span */
+
+        pf_framebuffer_store_span(fb, (size_t)y * fb->w + xs,
+            span, (size_t)count, blend, blend_span);
+    }
+}
+
+/* Public API */
+
+void
+pf_renderer_sprites2d(
+    pf_renderer_t* rn,
+    const pf_sprite2d_t* sprites,
+    size_t count)
+{
+    const int fb_w = (int)rn->fb.w;
+    const int fb_h = (int)rn->fb.h;
+
+    if (count == 0 || fb_w == 0 || fb_h == 0) {
+        return;
+    }
+
+    const PF_MATH_FLOAT* view = (rn->conf2d != NULL) ? rn->conf2d->mat_view : NULL;
+    pf_color_blend_fn blend = (rn->conf2d != NULL) ? rn->conf2d->color_blend : NULL;
+    pf_color_blend_span_fn blend_span = (rn->conf2d != NULL) ? rn->conf2d->color_blend_span : NULL;
+
+    /* Transform, clip and sort the sprites */
+
+    pf_sprite2d_INTERNAL_t* batch = PF_MALLOC(count * sizeof(pf_sprite2d_INTERNAL_t));
+    if (batch == NULL) return;
+
+    size_t num_visible = 0;
+    size_t total_area = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        pf_sprite2d_INTERNAL_t* sprite = &batch[num_visible];
+        if (pf_sprite2d_prepare_INTERNAL(sprite, &sprites[i], view, fb_w, fb_h)) {
+            sprite->index = i;
+            total_area += (size_t)(sprite->bounds[2] - sprite->bounds[0] + 1)
+                               * (sprite->bounds[3] - sprite->bounds[1] + 1);
+            pf_framebuffer_damage_add(&rn->damage,
+                sprite->bounds[0], sprite->bounds[1],
+                sprite->bounds[2], sprite->bounds[3]);
+            num_visible++;
+        }
+    }
+
+    if (num_visible == 0) {
+        PF_FREE(batch);
+        return;
+    }
+
+    qsort(batch, num_visible, sizeof(pf_sprite2d_INTERNAL_t), pf_sprite2d_compare_INTERNAL);
+
+    /*
+        Binning of the sprites to the tiles they overlap, in two passes: the first counts
+        the sprites of each tile to get the offset of its list, the second fills the lists
+        in the sorted order, which is thus kept within each tile.
+    */
+
+    const int tiles_x = (fb_w + PF_SPRITE_TILE_SIZE - 1) / PF_SPRITE_TILE_SIZE;
+    const int tiles_y = (fb_h + PF_SPRITE_TILE_SIZE - 1) / PF_SPRITE_TILE_SIZE;
+    const int num_tiles = tiles_x * tiles_y;
+
+    uint32_t* offsets = PF_CALLOC(num_tiles + 1, sizeof(uint32_t));
+    uint32_t* cursors = PF_MALLOC(num_tiles * sizeof(uint32_t));
+
+    if (offsets == NULL || cursors == NULL) {
+        if (offsets != NULL) PF_FREE(offsets);
+        if (cursors != NULL) PF_FREE(cursors);
+        PF_FREE(batch);
+        return;
+    }
+
+    for (size_t i = 0; i < num_visible; ++i) {
+        const int* b = batch[i].bounds;
+        for (int ty = b[1] / PF_SPRITE_TILE_SIZE; ty <= b[3] / PF_SPRITE_TILE_SIZE; ++ty) {
+            for (int tx = b[0] / PF_SPRITE_TILE_SIZE; tx <= b[2] / PF_SPRITE_TILE_SIZE; ++tx) {
+                offsets[ty * tiles_x + tx + 1]++;
+            }
+        }
+    }
+
+    for (int i = 0; i < num_tiles; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    uint32_t* entries = PF_MALLOC(offsets[num_tiles] * sizeof(uint32_t));
+
+    if (entries == NULL) {
+        PF_FREE(offsets);
+        PF_FREE(cursors);
+        PF_FREE(batch);
+        return;
+    }
+
+    memcpy(cursors, offsets, num_tiles * sizeof(uint32_t));
+
+    for (size_t i = 0; i < num_visible; ++i) {
+        const int* b = batch[i].bounds;
+        for (int ty = b[1] / PF_SPRITE_TILE_SIZE; ty <= b[3] / PF_SPRITE_TILE_SIZE; ++ty) {
+            for (int tx = b[0] / PF_SPRITE_TILE_SIZE; tx <= b[2] / PF_SPRITE_TILE_SIZE; ++tx) {
+                entries[cursors[ty * tiles_x + tx]++] = (uint32_t)i;
+            }
+        }
+    }
+
+    /* Draw the tiles */
+
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(dynamic) \
+        if (total_area >= PF_OMP_TEXTURE_RN2D_SIZE_THRESHOLD && num_tiles > 1)
+#endif //_OPENMP
+    for (int tile = 0; tile < num_tiles; ++tile) {
+        const int tx_min = (tile % tiles_x) * PF_SPRITE_TILE_SIZE;
+        const int ty_min = (tile / tiles_x) * PF_SPRITE_TILE_SIZE;
+        const int tx_max = PF_MIN(tx_min + PF_SPRITE_TILE_SIZE, fb_w) - 1;
+        const int ty_max = PF_MIN(ty_min + PF_SPRITE_TILE_SIZE, fb_h) - 1;
+
+        for (uint32_t i = offsets[tile]; i < offsets[tile + 1]; ++i) {
+            const pf_sprite2d_INTERNAL_t* sprite = &batch[entries[i]];
+            pf_sprite2d_draw_INTERNAL(&rn->fb, sprite, blend, blend_span,
+                PF_MAX(tx_min, sprite->bounds[0]), PF_MAX(ty_min, sprite->bounds[1]),
+                PF_MIN(tx_max, sprite->bounds[2]), PF_MIN(ty_max, sprite->bounds[3]));
+        }
+    }
+
+    PF_FREE(entries);
+    PF_FREE(offsets);
+    PF_FREE(cursors);
+    PF_FREE(batch);
+}
+
+void
+pf_sprite2d_set_transform(
+    pf_sprite2d_t* sprite,
+    float x, float y,
+    float sx, float sy,
+    float r, float ox, float oy)
+{
+    // NOTE: Translation to (x, y) of the rotation and the scaling around (ox, oy)
+
+    float c = cosf(r), s = sinf(r);
+
+    PF_MATH_FLOAT* mat = sprite->transform;
+
+    mat[0] = c * sx, mat[1] = -s * sy;
+    mat[3] = s * sx, mat[4] = c * sy;
+    mat[2] = x - (mat[0] * ox + mat[1] * oy);
+    mat[5] = y - (mat[3] * ox + mat[4] * oy);
+    mat[6] = 0, mat[7] = 0, mat[8] = 1;
+}
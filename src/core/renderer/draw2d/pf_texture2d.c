@@ -31,11 +31,14 @@
     int ymin = PF_CLAMP(y, 0, fb_h);                                                \
     int xmax = PF_CLAMP(x + tex_w, 0, fb_w);                                        \
     int ymax = PF_CLAMP(y + tex_h, 0, fb_h);                                        \
+    if (xmin < xmax && ymin < ymax) {                                               \
+        pf_framebuffer_damage_add(&rn->damage, xmin, ymin, xmax - 1, ymax - 1);     \
+    }                                                                               \
     for (int fb_y = ymin; fb_y < ymax; ++fb_y) {                                    \
-        size_t ty_offset = (fb_y - y) * tex_w;                                      \
+        uint32_t t_y = fb_y - y;                                                    \
         size_t fb_y_offset = fb_y * fb_w;                                           \
         for (int fb_x = xmin; fb_x < xmax; ++fb_x) {                                \
-            size_t t_offset = ty_offset + (fb_x - x);                               \
+            uint32_t t_x = fb_x - x;                                                \
             size_t fb_offset = fb_y_offset + fb_x;                                  \
             PIXEL_CODE                                                              \
         }                                                                           \
@@ -84,6 +87,7 @@
     int y2 = PF_CLAMP((int)ceilf(ymax), 0, (int)fb->h - 1);                         \
     if (x1 > x2) PF_SWAP(x1, x2);                                                   \
     if (y1 > y2) PF_SWAP(y1, y2);                                                   \
+    pf_framebuffer_damage_add(&rn->damage, x1, y1, x2, y2);                         \
     float inv00 = inv_transform[0], inv01 = inv_transform[1], inv02 = inv_transform[2];\
     float inv10 = inv_transform[3], inv11 = inv_transform[4], inv12 = inv_transform[5];\
 
@@ -114,12 +118,11 @@ pf_renderer_texture2d(
     if (rn->conf2d != NULL && rn->conf2d->color_blend) {
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_TRAVEL_TEXTURE2D({
-            pf_color_t* ptr = fb->buffer + fb_offset;
-            *ptr = blend(*ptr, tex->getter(tex->texels, t_offset));
+            pf_framebuffer_blend(fb, fb_offset, pf_texture2d_get_texel(tex, t_x, t_y), blend);
         })
     } else {
         PF_TRAVEL_TEXTURE2D({
-            fb->buffer[fb_offset] = tex->getter(tex->texels, t_offset);
+            pf_framebuffer_store(fb, fb_offset, pf_texture2d_get_texel(tex, t_x, t_y));
         })
     }
 }
@@ -133,14 +136,13 @@ pf_renderer_texture2d_tint(
     if (rn->conf2d != NULL && rn->conf2d->color_blend) {
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_TRAVEL_TEXTURE2D({
-            pf_color_t* ptr = fb->buffer + fb_offset;
-            pf_color_t texel = tex->getter(tex->texels, t_offset);
-            *ptr = blend(*ptr, pf_color_blend_mul(texel, tint));
+            pf_color_t texel = pf_texture2d_get_texel(tex, t_x, t_y);
+            pf_framebuffer_blend(fb, fb_offset, pf_color_blend_mul(texel, tint), blend);
         })
     } else {
         PF_TRAVEL_TEXTURE2D({
-            pf_color_t texel = tex->getter(tex->texels, t_offset);
-            fb->buffer[fb_offset] = pf_color_blend_mul(texel, tint);
+            pf_color_t texel = pf_texture2d_get_texel(tex, t_x, t_y);
+            pf_framebuffer_store(fb, fb_offset, pf_color_blend_mul(texel, tint));
         })
     }
 }
@@ -337,28 +339,18 @@ pf_renderer_texture2d_rec(
 
     /* Rendering */
 
-    const struct {
-        float* positions;
-        float* texcoords;
-        pf_color_t* colors;
-        const uint16_t* indices;
-        uint32_t num_vertices;
-        uint32_t num_indices;
-    } vb = {
-        .positions = (float*)positions,
-        .texcoords = (float*)texcoords,
-        .colors = NULL,
-        .indices = indices,
-        .num_vertices = 4,
-        .num_indices = 6
-    };
+    pf_vertexbuffer_t vb = pf_vertexbuffer_create_2d(4,
+        (float*)positions, (float*)texcoords, NULL);
+
+    vb.indices = (uint16_t*)indices;
+    vb.num_indices = 6;
 
     pf_proc2d_t proc = { 0 };
     proc.fragment = pf_proc2d_fragment_texture_as_uniform;
     proc.uniforms = tex;
 
     pf_renderer_vertexbuffer2d(rn,
-        (const pf_vertexbuffer_t*)(&vb),
+        &vb,
         rn->conf2d ? rn->conf2d->mat_view : NULL, &proc);
 }
 
@@ -446,28 +438,18 @@ pf_renderer_texture2d_rec_tint(
 
     /* Rendering */
 
-    const struct {
-        float* positions;
-        float* texcoords;
-        pf_color_t* colors;
-        const uint16_t* indices;
-        uint32_t num_vertices;
-        uint32_t num_indices;
-    } vb = {
-        .positions = (float*)positions,
-        .texcoords = (float*)texcoords,
-        .colors = colors,
-        .indices = indices,
-        .num_vertices = 4,
-        .num_indices = 6
-    };
+    pf_vertexbuffer_t vb = pf_vertexbuffer_create_2d(4,
+        (float*)positions, (float*)texcoords, colors);
+
+    vb.indices = (uint16_t*)indices;
+    vb.num_indices = 6;
 
     pf_proc2d_t proc = { 0 };
     proc.fragment = pf_proc2d_fragment_texture_as_uniform;
     proc.uniforms = tex;
 
     pf_renderer_vertexbuffer2d(rn,
-        (const pf_vertexbuffer_t*)(&vb),
+        &vb,
         rn->conf2d ? rn->conf2d->mat_view : NULL, &proc);
 }
 
@@ -548,28 +530,18 @@ pf_renderer_texture2d_rec_map(
 
     /* Rendering */
 
-    const struct {
-        float* positions;
-        float* texcoords;
-        pf_color_t* colors;
-        const uint16_t* indices;
-        uint32_t num_vertices;
-        uint32_t num_indices;
-    } vb = {
-        .positions = (float*)positions,
-        .texcoords = (float*)texcoords,
-        .colors = NULL,
-        .indices = indices,
-        .num_vertices = 4,
-        .num_indices = 6
-    };
+    pf_vertexbuffer_t vb = pf_vertexbuffer_create_2d(4,
+        (float*)positions, (float*)texcoords, NULL);
+
+    vb.indices = (uint16_t*)indices;
+    vb.num_indices = 6;
 
     pf_proc2d_t proc = { 0 };
     proc.fragment = frag_proc;
     proc.uniforms = tex;
 
     pf_renderer_vertexbuffer2d(rn,
-        (const pf_vertexbuffer_t*)(&vb),
+        &vb,
         rn->conf2d ? rn->conf2d->mat_view : NULL, &proc);
 }
 
@@ -585,28 +557,26 @@ pf_renderer_texture2d_mat(
     if (rn->conf2d && rn->conf2d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_TRAVEL_TEXTURE2D_MAT_OMP({
-            pf_color_t* ptr = fb->buffer + y * fb->w + x;
             pf_color_t texel = tex->sampler(tex, u, v);
-            *ptr = blend(*ptr, texel);
+            pf_framebuffer_blend(fb, y * fb->w + x, texel, blend);
         })
     } else {
         PF_TRAVEL_TEXTURE2D_MAT_OMP({
             pf_color_t texel = tex->sampler(tex, u, v);
-            fb->buffer[y * fb->w + x] = texel;
+            pf_framebuffer_store(fb, y * fb->w + x, texel);
         })
     }
 #else
     if (rn->conf2d && rn->conf2d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_TRAVEL_TEXTURE2D_MAT({
-            pf_color_t* ptr = fb->buffer + y * fb->w + x;
             pf_color_t texel = tex->sampler(tex, u, v);
-            *ptr = blend(*ptr, texel);
+            pf_framebuffer_blend(fb, y * fb->w + x, texel, blend);
         })
     } else {
         PF_TRAVEL_TEXTURE2D_MAT({
             pf_color_t texel = tex->sampler(tex, u, v);
-            fb->buffer[y * fb->w + x] = texel;
+            pf_framebuffer_store(fb, y * fb->w + x, texel);
         })
     }
 #endif
@@ -626,13 +596,12 @@ pf_renderer_texture2d_mat_tint(
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_TRAVEL_TEXTURE2D_MAT_OMP({
             pf_color_t texel = tex->sampler(tex, u, v);
-            pf_color_t* ptr = fb->buffer + y * fb->w + x;
-            *ptr = blend(*ptr, pf_color_blend_mul(texel, tint));
+            pf_framebuffer_blend(fb, y * fb->w + x, pf_color_blend_mul(texel, tint), blend);
         })
     } else {
         PF_TRAVEL_TEXTURE2D_MAT_OMP({
             pf_color_t texel = tex->sampler(tex, u, v);
-            fb->buffer[y * fb->w + x] = pf_color_blend_mul(texel, tint);
+            pf_framebuffer_store(fb, y * fb->w + x, pf_color_blend_mul(texel, tint));
         })
     }
 #else
@@ -640,13 +609,12 @@ pf_renderer_texture2d_mat_tint(
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_TRAVEL_TEXTURE2D_MAT({
             pf_color_t texel = tex->sampler(tex, u, v);
-            pf_color_t* ptr = fb->buffer + y * fb->w + x;
-            *ptr = blend(*ptr, pf_color_blend_mul(texel, tint));
+            pf_framebuffer_blend(fb, y * fb->w + x, pf_color_blend_mul(texel, tint), blend);
         })
     } else {
         PF_TRAVEL_TEXTURE2D_MAT({
             pf_color_t texel = tex->sampler(tex, u, v);
-            fb->buffer[y * fb->w + x] = pf_color_blend_mul(texel, tint);
+            pf_framebuffer_store(fb, y * fb->w + x, pf_color_blend_mul(texel, tint));
         })
     }
 #endif
@@ -666,20 +634,18 @@ pf_renderer_texture2d_mat_map(
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_TRAVEL_TEXTURE2D_MAT_OMP({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, u, v, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + y * fb->w + x;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, y * fb->w + x);
 
             frag_proc(rn, &vertex, &final_color, tex);
-            *ptr = blend(*ptr, final_color);
+            pf_framebuffer_blend(&rn->fb, y * fb->w + x, final_color, blend);
         })
     } else {
         PF_TRAVEL_TEXTURE2D_MAT_OMP({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, u, v, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + y * fb->w + x;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, y * fb->w + x);
 
             frag_proc(rn, &vertex, &final_color, tex);
-            *ptr = final_color;
+            pf_framebuffer_store(&rn->fb, y * fb->w + x, final_color);
         })
     }
 #else
@@ -687,20 +653,18 @@ pf_renderer_texture2d_mat_map(
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_TRAVEL_TEXTURE2D_MAT({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, u, v, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + y * fb->w + x;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, y * fb->w + x);
 
             frag_proc(rn, &vertex, &final_color, tex);
-            *ptr = blend(*ptr, final_color);
+            pf_framebuffer_blend(&rn->fb, y * fb->w + x, final_color, blend);
         })
     } else {
         PF_TRAVEL_TEXTURE2D_MAT({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, u, v, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + y * fb->w + x;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, y * fb->w + x);
 
             frag_proc(rn, &vertex, &final_color, tex);
-            *ptr = final_color;
+            pf_framebuffer_store(&rn->fb, y * fb->w + x, final_color);
         })
     }
 #endif
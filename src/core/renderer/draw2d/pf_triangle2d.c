@@ -152,16 +152,27 @@
             */                                                                          \
             pf_simd_i_t mask = pf_simd_or_i32(pf_simd_or_i32(w1_v, w2_v), w3_v);        \
             pf_simd_i_t mask_ge_zero = pf_simd_cmpgt_i32(mask, pf_simd_setzero_i32());  \
-            /*
-                Load current framebuffer pixels
-            */                                                                          \
-            pf_simd_i_t framebuffer_colors = pf_simd_load_i32(                          \
-                (pf_simd_i_t*)(rn->fb.buffer + y_offset + x));                          \
-            /*
-                Apply mask to update framebuffer pixels
-            */                                                                          \
-            pf_simd_i_t masked_colors = pf_simd_blendv_i8(framebuffer_colors, pf_simd_set1_i32(color.v), mask_ge_zero);\
-            pf_simd_store_i32((pf_simd_i_t*)(rn->fb.buffer + y_offset + x), masked_colors);\
+            pf_color_t* fb_ptr = (pf_color_t*)rn->fb.buffer + y_offset + x;              \
+            if (x + PF_SIMD_SIZE - 1 <= xmax) {                                         \
+                /*
+                    Load current framebuffer pixels
+                */                                                                      \
+                pf_simd_i_t framebuffer_colors = pf_simd_load_i32((pf_simd_i_t*)fb_ptr);\
+                /*
+                    Apply mask to update framebuffer pixels
+                */                                                                      \
+                pf_simd_i_t masked_colors = pf_simd_blendv_i8(framebuffer_colors, pf_simd_set1_i32(color.v), mask_ge_zero);\
+                pf_simd_store_i32((pf_simd_i_t*)fb_ptr, masked_colors);                 \
+            } else {                                                                    \
+                /*
+                    The last pixels of the row are written one by one,
+                    the pixels past 'xmax' belonging to other rows
+                */                                                                      \
+                int mask_int = pf_simd_movemask_ps((pf_simd_t)mask_ge_zero);            \
+                for (int i = 0; x + i <= xmax; ++i) {                                   \
+                    if (mask_int & (1 << i)) fb_ptr[i] = color;                         \
+                }                                                                       \
+            }                                                                           \
             /*
                 Increment the barycentric coordinates for the next pixels
             */                                                                          \
@@ -281,6 +292,10 @@ pf_renderer_triangle2d(
     int xmax = PF_MIN(PF_MAX(x1, PF_MAX(x2, x3)), (int)rn->fb.w - 1);
     int ymax = PF_MIN(PF_MAX(y1, PF_MAX(y2, y3)), (int)rn->fb.h - 1);
 
+    if (xmin <= xmax && ymin <= ymax) {
+        pf_framebuffer_damage_add(&rn->damage, xmin, ymin, xmax, ymax);
+    }
+
     // Check the order of the vertices to determine if it's a front or back face
     // NOTE: if signed_area is equal to 0, the face is degenerate
     float signed_area = (x2 - x1) * (y3 - y1) - (x3 - x1) * (y2 - y1);
@@ -317,13 +332,23 @@ pf_renderer_triangle2d(
         pf_color_blend_fn blend = rn->conf2d->color_blend;
 #if defined(_OPENMP)
         PF_TRIANGLE_TRAVEL_OMP({
-            pf_color_t* ptr = rn->fb.buffer + offset;
-            *ptr = blend(*ptr, color);
+            pf_framebuffer_blend(&rn->fb, offset, color, blend);
+        })
+#else
+        PF_TRIANGLE_TRAVEL({
+            pf_framebuffer_blend(&rn->fb, offset, color, blend);
+        })
+#endif
+    } else if (rn->fb.format != PF_PIXELFORMAT_RGBA8888
+            && rn->fb.format != PF_PIXELFORMAT_UNKNOWN) {
+        // NOTE: The vectorized filling writes packed RGBA8888 pixels
+#if defined(_OPENMP)
+        PF_TRIANGLE_TRAVEL_OMP({
+            pf_framebuffer_store(&rn->fb, offset, color);
         })
 #else
         PF_TRIANGLE_TRAVEL({
-            pf_color_t* ptr = rn->fb.buffer + offset;
-            *ptr = rn->blend(*ptr, color);
+            pf_framebuffer_store(&rn->fb, offset, color);
         })
 #endif
     } else {
@@ -355,6 +380,10 @@ pf_renderer_triangle2d_gradient(
     int xmax = PF_MIN(PF_MAX(x1, PF_MAX(x2, x3)), (int)rn->fb.w - 1);
     int ymax = PF_MIN(PF_MAX(y1, PF_MAX(y2, y3)), (int)rn->fb.h - 1);
 
+    if (xmin <= xmax && ymin <= ymax) {
+        pf_framebuffer_damage_add(&rn->damage, xmin, ymin, xmax, ymax);
+    }
+
     // Check the order of the vertices to determine if it's a front or back face
     // NOTE: if signed_area is equal to 0, the face is degenerate
     float signed_area = (x2 - x1) * (y3 - y1) - (x3 - x1) * (y2 - y1);
@@ -403,24 +432,22 @@ pf_renderer_triangle2d_gradient(
     if (rn->conf2d && rn->conf2d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_TRIANGLE_GRADIENT_TRAVEL_OMP({
-            pf_color_t* ptr = rn->fb.buffer + offset;
-            *ptr = blend(*ptr, color);
+            pf_framebuffer_blend(&rn->fb, offset, color, blend);
         })
     } else {
         PF_TRIANGLE_GRADIENT_TRAVEL_OMP({
-            rn->fb.buffer[offset] = color; 
+            pf_framebuffer_store(&rn->fb, offset, color);
         })
     }
 #else
     if (rn->conf2d && rn->conf2d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_TRIANGLE_GRADIENT_TRAVEL({
-            pf_color_t* ptr = rn->fb.buffer + offset;
-            *ptr = blend(*ptr, color);
+            pf_framebuffer_blend(&rn->fb, offset, color, blend);
         })
     } else {
         PF_TRIANGLE_GRADIENT_TRAVEL({
-            rn->fb.buffer[offset] = color; 
+            pf_framebuffer_store(&rn->fb, offset, color);
         })
     }
 #endif
@@ -456,6 +483,10 @@ pf_renderer_triangle2d_map(
     int xmax = PF_MIN(PF_MAX(x1, PF_MAX(x2, x3)), (int)rn->fb.w - 1);
     int ymax = PF_MIN(PF_MAX(y1, PF_MAX(y2, y3)), (int)rn->fb.h - 1);
 
+    if (xmin <= xmax && ymin <= ymax) {
+        pf_framebuffer_damage_add(&rn->damage, xmin, ymin, xmax, ymax);
+    }
+
     // Check the order of the vertices to determine if it's a front or back face
     // NOTE: if signed_area is equal to 0, the face is degenerate
     float signed_area = (x2 - x1) * (y3 - y1) - (x3 - x1) * (y2 - y1);
@@ -491,20 +522,18 @@ pf_renderer_triangle2d_map(
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_TRIANGLE_TRAVEL_OMP({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + offset;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
             fragment(rn, &vertex, &final_color, uniforms);
-            *ptr = blend(*ptr, final_color);
+            pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
         })
     } else {
         PF_TRIANGLE_TRAVEL_OMP({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + offset;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
             fragment(rn, &vertex, &final_color, uniforms);
-            *ptr = final_color;
+            pf_framebuffer_store(&rn->fb, offset, final_color);
         })
     }
 #else
@@ -512,20 +541,18 @@ pf_renderer_triangle2d_map(
         pf_color_blend_fn blend = rn->conf2d->color_blend;
         PF_TRIANGLE_TRAVEL({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + offset;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
             fragment(rn, &vertex, &final_color, uniforms);
-            *ptr = blend(*ptr, final_color);
+            pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
         })
     } else {
         PF_TRIANGLE_TRAVEL({
             pf_vertex_t vertex = pf_vertex_create_2d(x, y, 0, 0, PF_WHITE);
-            pf_color_t *ptr = rn->fb.buffer + offset;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
 
             fragment(rn, &vertex, &final_color, uniforms);
-            *ptr = final_color;
+            pf_framebuffer_store(&rn->fb, offset, final_color);
         })
     }
 #endif
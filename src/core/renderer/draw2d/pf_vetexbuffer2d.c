@@ -81,7 +81,169 @@ pf_renderer_triangle_interpolation_INTERNAL(
     pf_vertex_t* v2,
     pf_vertex_t* v3,
     pf_vec3_t bary,
-    float z_depth);
+    const float* inv_w);
+
+bool
+pf_vertexbuffer_assemble_slot_INTERNAL(
+    const pf_vertexbuffer_t* vb, uint32_t* count,
+    uint32_t index, uint32_t* slot);
+
+bool
+pf_vertexbuffer_assemble_push_INTERNAL(
+    const pf_vertexbuffer_t* vb, uint32_t* count,
+    uint32_t slot, uint32_t tri[3]);
+
+/* Internal Helper Functions */
+
+static void
+pf_vertexbuffer2d_fetch_INTERNAL(
+    const pf_vertexbuffer_t* vb,
+    pf_vertex_t* vertex,
+    uint32_t index)
+{
+    for (uint32_t j = 0; j < PF_MAX_ATTRIBUTES; ++j) {
+        const pf_attribute_t* attr = &vb->attributes[j];
+        if (attr->used != 0) {
+            vertex->elements[j] = (j == PF_ATTRIB_COLOR)
+                ? pf_attribute_get_color_elem(attr, index)
+                : pf_attribute_get_elem(attr, index);
+        } else {
+            vertex->elements[j].used = false;
+        }
+    }
+}
+
+static void
+pf_renderer_triangle2d_transformed_INTERNAL(
+    pf_renderer_t* rn,
+    pf_vertex_t* v1,
+    pf_vertex_t* v2,
+    pf_vertex_t* v3,
+    const pf_proc2d_t* proc)
+{
+    /*
+        Calculate the 2D bounding box of the triangle
+        Determine the minimum and maximum x and y coordinates of the triangle vertices
+    */
+
+    pf_vec3_t p1, p2, p3;
+    pf_vertex_get_vec(v1, PF_ATTRIB_POSITION, p1);
+    pf_vertex_get_vec(v2, PF_ATTRIB_POSITION, p2);
+    pf_vertex_get_vec(v3, PF_ATTRIB_POSITION, p3);
+
+    int xmin = (int)PF_MAX(PF_MIN(p1[0], PF_MIN(p2[0], p3[0])), 0);
+    int ymin = (int)PF_MAX(PF_MIN(p1[1], PF_MIN(p2[1], p3[1])), 0);
+    int xmax = (int)PF_MIN(PF_MAX(p1[0], PF_MAX(p2[0], p3[0])), (int)rn->fb.w - 1);
+    int ymax = (int)PF_MIN(PF_MAX(p1[1], PF_MAX(p2[1], p3[1])), (int)rn->fb.h - 1);
+
+    if (xmin <= xmax && ymin <= ymax) {
+        pf_framebuffer_damage_add(&rn->damage, xmin, ymin, xmax, ymax);
+    }
+
+    /*
+        Check the order of the vertices to determine if it's a front or back face
+        NOTE: if signed_area is equal to 0, the face is degenerate
+    */
+
+    float signed_area = (p2[0] - p1[0]) *
+                        (p3[1] - p1[1]) -
+                        (p3[0] - p1[0]) *
+                        (p2[1] - p1[1]);
+
+    int_fast8_t is_back_face = (signed_area > 0);
+
+    /*
+        Barycentric interpolation setup
+        Calculate the step increments for the barycentric coordinates
+    */
+
+    int w1_x_step = p3[1] - p2[1];
+    int w1_y_step = p2[0] - p3[0];
+    int w2_x_step = p1[1] - p3[1];
+    int w2_y_step = p3[0] - p1[0];
+    int w3_x_step = p2[1] - p1[1];
+    int w3_y_step = p1[0] - p2[0];
+
+    /*
+        If the triangle is a back face, invert the steps
+    */
+
+    if (is_back_face) {
+        w1_x_step = -w1_x_step, w1_y_step = -w1_y_step;
+        w2_x_step = -w2_x_step, w2_y_step = -w2_y_step;
+        w3_x_step = -w3_x_step, w3_y_step = -w3_y_step;
+    }
+
+    /*
+        Calculate the initial barycentric coordinates
+        for the top-left point of the bounding box
+    */
+
+    int w1_row = (xmin - p2[0]) * w1_x_step + w1_y_step * (ymin - p2[1]);
+    int w2_row = (xmin - p3[0]) * w2_x_step + w2_y_step * (ymin - p3[1]);
+    int w3_row = (xmin - p1[0]) * w3_x_step + w3_y_step * (ymin - p1[1]);
+
+    /*
+        Calculate the inverse of the sum of the barycentric coordinates for normalization
+        NOTE: This sum remains constant throughout the triangle
+    */
+
+    float inv_w_sum = 1.0f / (float)(w1_row + w2_row + w3_row);
+
+    /* Rendering of the triangle */
+
+#if defined(_OPENMP)
+    if (rn->conf2d && rn->conf2d->color_blend != NULL) {
+        pf_color_blend_fn blend = rn->conf2d->color_blend;
+        PF_MESH_TRIANGLE_TRAVEL_OMP({
+            pf_vertex_t vertex;
+            pf_renderer_triangle_interpolation_INTERNAL(
+                &vertex, v1, v2, v3, bary, NULL);
+
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
+
+            proc->fragment(rn, &vertex, &final_color, proc->uniforms);
+            pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
+        })
+    } else {
+        PF_MESH_TRIANGLE_TRAVEL_OMP({
+            pf_vertex_t vertex;
+            pf_renderer_triangle_interpolation_INTERNAL(
+                &vertex, v1, v2, v3, bary, NULL);
+
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
+
+            proc->fragment(rn, &vertex, &final_color, proc->uniforms);
+            pf_framebuffer_store(&rn->fb, offset, final_color);
+        })
+    }
+#else
+    if (rn->conf2d && rn->conf2d->color_blend != NULL) {
+        pf_color_blend_fn blend = rn->conf2d->color_blend;
+        PF_MESH_TRIANGLE_TRAVEL({
+            pf_vertex_t vertex;
+            pf_renderer_triangle_interpolation_INTERNAL(
+                &vertex, v1, v2, v3, bary, NULL);
+
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
+
+            proc->fragment(rn, &vertex, &final_color, proc->uniforms);
+            pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
+        })
+    } else {
+        PF_MESH_TRIANGLE_TRAVEL({
+            pf_vertex_t vertex;
+            pf_renderer_triangle_interpolation_INTERNAL(
+                &vertex, v1, v2, v3, bary, NULL);
+
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
+
+            proc->fragment(rn, &vertex, &final_color, proc->uniforms);
+            pf_framebuffer_store(&rn->fb, offset, final_color);
+        })
+    }
+#endif
+}
 
 /* Public API Functions */
 
@@ -119,166 +281,39 @@ pf_renderer_vertexbuffer2d(
 
     /* Iterates through all vertices in the vertex buffer */
 
-    const uint16_t* indices = indices;
-    bool has_indices = (vb->indices != NULL);
+    const uint16_t* indices = vb->indices;
+    bool has_indices = (indices != NULL);
     uint32_t num = (has_indices) ? vb->num_indices : vb->num_vertices;
 
-    for (uint32_t i = 0; i < num; i += 3) {
-
-        /* Calculating vertex and array indexes */
-
-        uint32_t index_1 = i + 0;
-        uint32_t index_2 = i + 1;
-        uint32_t index_3 = i + 2;
-
-        if (has_indices) {
-            index_1 = indices[index_1];
-            index_2 = indices[index_2];
-            index_3 = indices[index_3];
-        }
-
-        /* Retrieving vertices and calling the vertex code */
-
-        pf_vertex_t v1 = { 0 };
-        pf_vertex_t v2 = { 0 };
-        pf_vertex_t v3 = { 0 };
-
-        for (uint32_t j = 0; j < PF_MAX_ATTRIBUTES; ++j) {
-            const pf_attribute_t* attr = &vb->attributes[j];
-            if (attr->used != 0) {
-                v1.elements[j] = pf_attribute_get_elem(attr, index_1);
-                v2.elements[j] = pf_attribute_get_elem(attr, index_2);
-                v3.elements[j] = pf_attribute_get_elem(attr, index_3);
-            }
-        }
-
-        /* Transform Vertices */
-
-        processor.vertex(&v1, mat, processor.uniforms);
-        processor.vertex(&v2, mat, processor.uniforms);
-        processor.vertex(&v3, mat, processor.uniforms);
-
-        /*
-            Calculate the 2D bounding box of the triangle
-            Determine the minimum and maximum x and y coordinates of the triangle vertices
-        */
-
-        pf_vec3_t p1, p2, p3;
-        pf_vertex_get_vec(&v1, PF_ATTRIB_POSITION, p1);
-        pf_vertex_get_vec(&v2, PF_ATTRIB_POSITION, p2);
-        pf_vertex_get_vec(&v3, PF_ATTRIB_POSITION, p3);
-
-        int xmin = (int)PF_MAX(PF_MIN(p1[0], PF_MIN(p2[0], p3[0])), 0);
-        int ymin = (int)PF_MAX(PF_MIN(p1[1], PF_MIN(p2[1], p3[1])), 0);
-        int xmax = (int)PF_MIN(PF_MAX(p1[0], PF_MAX(p2[0], p3[0])), (int)rn->fb.w - 1);
-        int ymax = (int)PF_MIN(PF_MAX(p1[1], PF_MAX(p2[1], p3[1])), (int)rn->fb.h - 1);
-
-        /*
-            Check the order of the vertices to determine if it's a front or back face
-            NOTE: if signed_area is equal to 0, the face is degenerate
-        */
-
-        float signed_area = (p2[0] - p1[0]) *
-                            (p3[1] - p1[1]) -
-                            (p3[0] - p1[0]) *
-                            (p2[1] - p1[1]);
-
-        int_fast8_t is_back_face = (signed_area > 0);
-
-        /*
-            Barycentric interpolation setup
-            Calculate the step increments for the barycentric coordinates
-        */
-
-        int w1_x_step = p3[1] - p2[1];
-        int w1_y_step = p2[0] - p3[0];
-        int w2_x_step = p1[1] - p3[1];
-        int w2_y_step = p3[0] - p1[0];
-        int w3_x_step = p2[1] - p1[1];
-        int w3_y_step = p1[0] - p2[0];
-
-        /*
-            If the triangle is a back face, invert the steps
-        */
-
-        if (is_back_face) {
-            w1_x_step = -w1_x_step, w1_y_step = -w1_y_step;
-            w2_x_step = -w2_x_step, w2_y_step = -w2_y_step;
-            w3_x_step = -w3_x_step, w3_y_step = -w3_y_step;
-        }
-
-        /*
-            Calculate the initial barycentric coordinates
-            for the top-left point of the bounding box
-        */
-
-        int w1_row = (xmin - p2[0]) * w1_x_step + w1_y_step * (ymin - p2[1]);
-        int w2_row = (xmin - p3[0]) * w2_x_step + w2_y_step * (ymin - p3[1]);
-        int w3_row = (xmin - p1[0]) * w3_x_step + w3_y_step * (ymin - p1[1]);
-
-        /*
-            Calculate the inverse of the sum of the barycentric coordinates for normalization
-            NOTE: This sum remains constant throughout the triangle
-        */
-
-        float inv_w_sum = 1.0f / (float)(w1_row + w2_row + w3_row);
+    /*
+        Each vertex is fetched and processed only once, then kept in a small cache.
+        Strips and fans reuse the last two processed vertices for each new triangle.
+    */
 
-        /* Rendering of the triangle */
+    pf_vertex_t cache[3];
+    uint32_t count = 0;
 
-#if defined(_OPENMP)
-    if (rn->conf2d && rn->conf2d->color_blend != NULL) {
-        pf_color_blend_fn blend = rn->conf2d->color_blend;
-            PF_MESH_TRIANGLE_TRAVEL_OMP({
-                pf_vertex_t vertex;
-                pf_renderer_triangle_interpolation_INTERNAL(
-                    &vertex, &v1, &v2, &v3, bary, 1);
+    for (uint32_t i = 0; i < num; ++i) {
+        uint32_t index = (has_indices) ? indices[i] : i;
 
-                pf_color_t* ptr = rn->fb.buffer + offset;
-                pf_color_t final_color = *ptr;
+        /* Select the cache slot that will receive the new vertex */
 
-                processor.fragment(rn, &vertex, &final_color, processor.uniforms);
-                *ptr = blend(*ptr, final_color);
-            })
-        } else {
-            PF_MESH_TRIANGLE_TRAVEL_OMP({
-                pf_vertex_t vertex;
-                pf_renderer_triangle_interpolation_INTERNAL(
-                    &vertex, &v1, &v2, &v3, bary, 1);
-
-                pf_color_t* ptr = rn->fb.buffer + offset;
-                pf_color_t final_color = *ptr;
-
-                processor.fragment(rn, &vertex, &final_color, processor.uniforms);
-                *ptr = final_color;
-            })
+        uint32_t slot;
+        if (!pf_vertexbuffer_assemble_slot_INTERNAL(vb, &count, index, &slot)) {
+            continue;
         }
-#else
-    if (rn->conf2d && rn->conf2d->color_blend != NULL) {
-        pf_color_blend_fn blend = rn->conf2d->color_blend;
-            PF_MESH_TRIANGLE_TRAVEL({
-                pf_vertex_t vertex;
-                pf_renderer_triangle_interpolation_INTERNAL(
-                    &vertex, &v1, &v2, &v3, bary, 1);
 
-                pf_color_t* ptr = rn->fb.buffer + offset;
-                pf_color_t final_color = *ptr;
+        /* Retrieving the vertex and calling the vertex code */
 
-                processor.fragment(rn, &vertex, &final_color, processor.uniforms);
-                *ptr = blend(*ptr, final_color);
-            })
-        } else {
-            PF_MESH_TRIANGLE_TRAVEL({
-                pf_vertex_t vertex;
-                pf_renderer_triangle_interpolation_INTERNAL(
-                    &vertex, &v1, &v2, &v3, bary, 1);
+        pf_vertexbuffer2d_fetch_INTERNAL(vb, &cache[slot], index);
+        processor.vertex(&cache[slot], mat, processor.uniforms);
 
-                pf_color_t* ptr = rn->fb.buffer + offset;
-                pf_color_t final_color = *ptr;
+        /* Assemble the triangle according to the topology and render it */
 
-                processor.fragment(rn, &vertex, &final_color, processor.uniforms);
-                *ptr = final_color;
-            })
+        uint32_t tri[3];
+        if (pf_vertexbuffer_assemble_push_INTERNAL(vb, &count, slot, tri)) {
+            pf_renderer_triangle2d_transformed_INTERNAL(
+                rn, &cache[tri[0]], &cache[tri[1]], &cache[tri[2]], &processor);
         }
-#endif
     }
 }
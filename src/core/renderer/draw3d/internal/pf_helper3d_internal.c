@@ -23,7 +23,6 @@ void
 pf_renderer_screen_projection_INTERNAL(
     const pf_renderer_t* rn,
     pf_vec4_t homogeneous[],
-    pf_vertex_t vertices[],
     size_t vertices_count,
     int screen_pos[][2])
 {
@@ -33,22 +32,11 @@ pf_renderer_screen_projection_INTERNAL(
         // Calculation of the reciprocal of HZ (to get correct depth)
         (*h)[2] = 1.0f / (*h)[2];
 
-        // Perspective correct is needed
-        // Division by the HZ axis (perspective correct)
-        if (fabsf(*h[3] - 1.0f) > PF_EPSILON) {
-            pf_vertex_t* v = &vertices[i];
-            if (v->elements[PF_ATTRIB_TEXCOORD].used != 0) {
-                pf_vertex_scale_vec(v, PF_ATTRIB_TEXCOORD, (*h)[2]);
-            }
-            //if (v->elements[PF_ATTRIB_COLOR].used != 0) {
-            //    pf_vertex_scale_vec(v, PF_ATTRIB_COLOR, (*h)[2]);
-            //}
-        }
-
         // Division of XY coordinates by weight
-        float inv_hw = 1.0f / (*h)[3];
-        (*h)[0] *= inv_hw;
-        (*h)[1] *= inv_hw;
+        // NOTE: The reciprocal of W is kept, it's used for perspective correct interpolation
+        (*h)[3] = 1.0f / (*h)[3];
+        (*h)[0] *= (*h)[3];
+        (*h)[1] *= (*h)[3];
 
         // Convert homogeneous coordinates to screen coordinates
         screen_pos[i][0] = (rn->conf3d->viewport_pos[0] + ((*h)[0] + 1.0f) * 0.5f * rn->conf3d->viewport_dim[0]) + 0.5f;
@@ -63,17 +51,25 @@ pf_renderer_triangle_interpolation_INTERNAL(
     pf_vertex_t* v2,
     pf_vertex_t* v3,
     pf_vec3_t bary,
-    float z_depth)
+    const float* inv_w)
 {
-    pf_vertex_bary(out_vertex, v1, v2, v3, bary);
-
-    // TODO: Find a method to determine if we need to rescale
+    // NOTE: 'inv_w' contains the reciprocal of the W of each vertex, or NULL for affine interpolation.
+    //       Instead of dividing each attribute by W, the barycentric coordinates are weighted once,
+    //       which requires a single reciprocal per pixel for all attributes.
 
-    if (out_vertex->elements[PF_ATTRIB_TEXCOORD].used != 0) {
-        pf_vertex_scale_vec(out_vertex, PF_ATTRIB_TEXCOORD, z_depth);
+    if (inv_w == NULL) {
+        pf_vertex_bary(out_vertex, v1, v2, v3, bary);
+        return;
     }
 
-    //if (out_vertex->elements[PF_ATTRIB_COLOR].used != 0) {
-    //    pf_vertex_scale_vec(out_vertex, PF_ATTRIB_COLOR, z_depth);
-    //}
+    pf_vec3_t persp_bary = {
+        bary[0] * inv_w[0],
+        bary[1] * inv_w[1],
+        bary[2] * inv_w[2]
+    };
+
+    float inv_sum = 1.0f / (persp_bary[0] + persp_bary[1] + persp_bary[2]);
+    pf_vec3_scale(persp_bary, persp_bary, inv_sum);
+
+    pf_vertex_bary(out_vertex, v1, v2, v3, persp_bary);
 }
@@ -206,18 +206,16 @@
 #define PF_PIXEL_CODE_NOBLEND()                                         \
     pf_vertex_t vertex;                                                 \
     pf_vertex_lerp(&vertex, &vertices[0], &vertices[1], t);             \
-    pf_color_t *ptr = rn->fb.buffer + offset;                           \
-    pf_color_t final_color = *ptr;                                      \
+    pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);      \
     proc->fragment(rn, &vertex, &final_color, proc->uniforms);          \
-    *ptr = final_color;
+    pf_framebuffer_store(&rn->fb, offset, final_color);
 
 #define PF_PIXEL_CODE_BLEND()                                           \
     pf_vertex_t vertex;                                                 \
     pf_vertex_lerp(&vertex, &vertices[0], &vertices[1], t);             \
-    pf_color_t *ptr = rn->fb.buffer + offset;                           \
-    pf_color_t final_color = *ptr;                                      \
+    pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);      \
     proc->fragment(rn, &vertex, &final_color, proc->uniforms);          \
-    *ptr = blend(*ptr, final_color);
+    pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
 
 /* Helper Function Declarations */
 
@@ -225,7 +223,6 @@ void
 pf_renderer_screen_projection_INTERNAL(
     const pf_renderer_t* rn,
     pf_vec4_t* homogeneous,
-    pf_vertex_t* vertices,
     size_t vertices_count,
     int screen_pos[][2]);
 
@@ -314,7 +311,7 @@ pf_renderer_line3d_INTERNAL(
     if (num != 2) return;
 
     pf_renderer_screen_projection_INTERNAL(
-        rn, homogens, vertices, num, screen_pos);
+        rn, homogens, num, screen_pos);
 
     int x1 = screen_pos[0][0];
     int y1 = screen_pos[0][1];
@@ -323,6 +320,12 @@ pf_renderer_line3d_INTERNAL(
     float z1 = homogens[0][2];
     float z2 = homogens[1][2];
 
+    // NOTE: The thick lines are drawn as parallel lines around the main one
+    int margin = (fabsf(thick) > 1) ? (int)ceilf(fabsf(thick)) : 0;
+    pf_framebuffer_damage_add(&rn->damage,
+        PF_MIN(x1, x2) - margin, PF_MIN(y1, y2) - margin,
+        PF_MAX(x1, x2) + margin, PF_MAX(y1, y2) + margin);
+
     pf_color_blend_fn blend = rn->conf3d->color_blend;
     pf_depth_test_fn test = rn->conf3d->depth_test;
 
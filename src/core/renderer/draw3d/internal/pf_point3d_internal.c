@@ -58,16 +58,14 @@
 /* Internal Pixel Code Macros */
 
 #define PF_PIXEL_CODE_NOBLEND()                                         \
-    pf_color_t* ptr = rn->fb.buffer + offset;                           \
-    pf_color_t final_color = *ptr;                                      \
+    pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);      \
     proc->fragment(rn, &vertex, &final_color, proc->uniforms);          \
-    *ptr = final_color;
+    pf_framebuffer_store(&rn->fb, offset, final_color);
 
 #define PF_PIXEL_CODE_BLEND()                                           \
-    pf_color_t* ptr = rn->fb.buffer + offset;                           \
-    pf_color_t final_color = *ptr;                                      \
+    pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);      \
     proc->fragment(rn, &vertex, &final_color, proc->uniforms);          \
-    *ptr = blend(*ptr, final_color);
+    pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
 
 /* Helper Function Declarations */
 
@@ -75,7 +73,6 @@ void
 pf_renderer_screen_projection_INTERNAL(
     const pf_renderer_t* rn,
     pf_vec4_t* homogeneous,
-    pf_vertex_t* vertices,
     size_t vertices_count,
     int screen_pos[][2]);
 
@@ -119,7 +116,12 @@ pf_renderer_point3d_INTERNAL(
     if (num != 1) return;
 
     pf_renderer_screen_projection_INTERNAL(
-        rn, &homogen, &vertex, num, &screen_pos);
+        rn, &homogen, num, &screen_pos);
+
+    int margin = (int)ceilf(fabsf(radius));
+    pf_framebuffer_damage_add(&rn->damage,
+        screen_pos[0] - margin, screen_pos[1] - margin,
+        screen_pos[0] + margin, screen_pos[1] + margin);
 
     pf_color_blend_fn blend = rn->conf3d->color_blend;
     pf_depth_test_fn test = rn->conf3d->depth_test;
@@ -127,15 +129,13 @@ pf_renderer_point3d_INTERNAL(
     if (radius == 0) {
         size_t offset = screen_pos[1] * rn->fb.w + screen_pos[0];
         if (test != NULL && test(rn->zb.buffer[offset], homogen[2])) {
-            pf_color_t* ptr = rn->fb.buffer + offset;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
             proc->fragment(rn, &vertex, &final_color, proc->uniforms);
-            *ptr = (blend != NULL) ? blend(*ptr, final_color) : final_color;
+            if (blend != NULL) pf_framebuffer_blend(&rn->fb, offset, final_color, blend); else pf_framebuffer_store(&rn->fb, offset, final_color);
         } else {
-            pf_color_t* ptr = rn->fb.buffer + offset;
-            pf_color_t final_color = *ptr;
+            pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);
             proc->fragment(rn, &vertex, &final_color, proc->uniforms);
-            *ptr = (blend != NULL) ? blend(*ptr, final_color) : final_color;
+            if (blend != NULL) pf_framebuffer_blend(&rn->fb, offset, final_color, blend); else pf_framebuffer_store(&rn->fb, offset, final_color);
         }
     } else {
         if (test != NULL) {
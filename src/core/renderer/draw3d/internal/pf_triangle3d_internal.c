@@ -19,6 +19,97 @@
 
 #include "pixelfactory/core/pf_renderer.h"
 
+/* Internal Texture Coordinates Gradient */
+
+/*
+    The texture coordinates divided by 'w' and '1/w' are linear in screen space, their
+    gradients are thus constant over a triangle and computed once. The derivatives of
+    the texture coordinates at a pixel are only obtained on request of the fragment
+    processor, with the quotient rule, from these gradients and the barycentric
+    coordinates of the pixel being shaded, which are published per thread.
+*/
+
+typedef struct {
+    pf_vec3_t inv_w;        // '1/w' of each vertex, or 1 for affine interpolation
+    pf_vec2_t uv[3];        // Texture coordinates of each vertex
+    pf_vec3_t d_dx;         // Screen space X derivatives of 'u/w', 'v/w' and '1/w'
+    pf_vec3_t d_dy;         // Screen space Y derivatives of 'u/w', 'v/w' and '1/w'
+    bool valid;
+} pf_texcoord_gradient_INTERNAL_t;
+
+static PF_THREAD_LOCAL const pf_texcoord_gradient_INTERNAL_t* pf_fragment_gradient_INTERNAL;
+static PF_THREAD_LOCAL const float* pf_fragment_bary_INTERNAL;
+
+static void
+pf_texcoord_gradient_setup_INTERNAL(
+    pf_texcoord_gradient_INTERNAL_t* gradient,
+    const pf_vertex_t* v1,
+    const pf_vertex_t* v2,
+    const pf_vertex_t* v3,
+    const float* inv_w,
+    const pf_vec3_t bary_dx,
+    const pf_vec3_t bary_dy)
+{
+    const pf_vertex_t* vertices[3] = { v1, v2, v3 };
+
+    gradient->valid = false;
+
+    for (int_fast8_t i = 0; i < 3; ++i) {
+        const pf_attrib_elem_t* e = &vertices[i]->elements[PF_ATTRIB_TEXCOORD];
+        if (!e->used || e->type != PF_ATTRIB_FLOAT || e->comp < 2) return;
+        gradient->uv[i][0] = e->value[0].v_float;
+        gradient->uv[i][1] = e->value[1].v_float;
+        gradient->inv_w[i] = (inv_w != NULL) ? inv_w[i] : 1.0f;
+    }
+
+    for (int_fast8_t k = 0; k < 3; ++k) {
+        gradient->d_dx[k] = gradient->d_dy[k] = 0.0f;
+        for (int_fast8_t i = 0; i < 3; ++i) {
+            float value = gradient->inv_w[i] * ((k < 2) ? gradient->uv[i][k] : 1.0f);
+            gradient->d_dx[k] += bary_dx[i] * value;
+            gradient->d_dy[k] += bary_dy[i] * value;
+        }
+    }
+
+    gradient->valid = true;
+}
+
+bool
+pf_renderer_fragment_texcoord_gradient_INTERNAL(
+    pf_vec2_t duv_dx,
+    pf_vec2_t duv_dy)
+{
+    const pf_texcoord_gradient_INTERNAL_t* gradient = pf_fragment_gradient_INTERNAL;
+
+    if (gradient == NULL || !gradient->valid) {
+        duv_dx[0] = duv_dx[1] = 0.0f;
+        duv_dy[0] = duv_dy[1] = 0.0f;
+        return false;
+    }
+
+    const float* bary = pf_fragment_bary_INTERNAL;
+
+    float b = 0.0f;
+    pf_vec2_t a = { 0.0f, 0.0f };
+
+    for (int_fast8_t i = 0; i < 3; ++i) {
+        float weight = bary[i] * gradient->inv_w[i];
+        a[0] += weight * gradient->uv[i][0];
+        a[1] += weight * gradient->uv[i][1];
+        b += weight;
+    }
+
+    float inv_b = 1.0f / b;
+
+    for (int_fast8_t k = 0; k < 2; ++k) {
+        float uv = a[k] * inv_b;
+        duv_dx[k] = (gradient->d_dx[k] - uv * gradient->d_dx[2]) * inv_b;
+        duv_dy[k] = (gradient->d_dy[k] - uv * gradient->d_dy[2]) * inv_b;
+    }
+
+    return true;
+}
+
 /* Internal Rasterization Macros */
 
 // NOTE: This SIMD version is slightly less efficient than the "SISD" version
@@ -273,28 +364,232 @@
         w3_row += w3_y_step;                                                                    \
     }
 
+/*
+    The parallel versions split the bounding box into tiles of PF_RASTER_TILE_SIZE pixels
+    aligned on the screen, each tile being rasterized entirely by one thread. Tiles lying
+    completely outside one of the edges are skipped, as the edge functions are linear
+    their maximum over a tile is reached at one of its corners.
+*/
+
+#define PF_TILE_EDGE_MAX(W, X_STEP, Y_STEP)                                                     \
+    ((W) + PF_MAX(0, tw * (X_STEP)) + PF_MAX(0, th * (Y_STEP)))
+
 #define PF_TRIANGLE_TRAVEL_NODEPTH_OMP(PIXEL_CODE)                                              \
+    const uint32_t tiles_xmin = xmin - xmin % PF_RASTER_TILE_SIZE;                              \
+    const uint32_t tiles_ymin = ymin - ymin % PF_RASTER_TILE_SIZE;                              \
+    const int tiles_x = (xmax - tiles_xmin) / PF_RASTER_TILE_SIZE + 1;                          \
+    const int tiles_y = (ymax - tiles_ymin) / PF_RASTER_TILE_SIZE + 1;                          \
     _Pragma("omp parallel for schedule(dynamic)                                                 \
         if (((xmax - xmin) * (ymax - ymin)) >= PF_OMP_TRIANGLE_AABB_THRESHOLD)")                \
-    for (uint32_t y = ymin; y <= ymax; ++y) {                                                   \
-        int w1 = w1_row + (y - ymin) * w1_y_step;                                               \
-        int w2 = w2_row + (y - ymin) * w2_y_step;                                               \
-        int w3 = w3_row + (y - ymin) * w3_y_step;                                               \
-        for (uint32_t x = xmin; x <= xmax; ++x) {                                               \
-            if ((w1 | w2 | w3) >= 0) {                                                          \
-                uint32_t offset = y * rn->fb.w + x;                                             \
+    for (int tile = 0; tile < tiles_x * tiles_y; ++tile) {                                      \
+        uint32_t tx_min = PF_MAX(tiles_xmin + (tile % tiles_x) * PF_RASTER_TILE_SIZE, xmin);    \
+        uint32_t ty_min = PF_MAX(tiles_ymin + (tile / tiles_x) * PF_RASTER_TILE_SIZE, ymin);    \
+        uint32_t tx_max = PF_MIN(tiles_xmin + (tile % tiles_x + 1) * PF_RASTER_TILE_SIZE - 1, xmax);\
+        uint32_t ty_max = PF_MIN(tiles_ymin + (tile / tiles_x + 1) * PF_RASTER_TILE_SIZE - 1, ymax);\
+        int tw = tx_max - tx_min, th = ty_max - ty_min;                                         \
+        int w1_tile = w1_row + (tx_min - xmin) * w1_x_step + (ty_min - ymin) * w1_y_step;       \
+        int w2_tile = w2_row + (tx_min - xmin) * w2_x_step + (ty_min - ymin) * w2_y_step;       \
+        int w3_tile = w3_row + (tx_min - xmin) * w3_x_step + (ty_min - ymin) * w3_y_step;       \
+        if (PF_TILE_EDGE_MAX(w1_tile, w1_x_step, w1_y_step) < 0                                 \
+         || PF_TILE_EDGE_MAX(w2_tile, w2_x_step, w2_y_step) < 0                                 \
+         || PF_TILE_EDGE_MAX(w3_tile, w3_x_step, w3_y_step) < 0) {                              \
+            continue;                                                                           \
+        }                                                                                       \
+        for (uint32_t y = ty_min; y <= ty_max; ++y) {                                           \
+            int w1 = w1_tile + (y - ty_min) * w1_y_step;                                        \
+            int w2 = w2_tile + (y - ty_min) * w2_y_step;                                        \
+            int w3 = w3_tile + (y - ty_min) * w3_y_step;                                        \
+            for (uint32_t x = tx_min; x <= tx_max; ++x) {                                       \
+                if ((w1 | w2 | w3) >= 0) {                                                      \
+                    uint32_t offset = y * rn->fb.w + x;                                         \
+                    pf_vec3_t bary = { w1 * inv_w_sum, w2 * inv_w_sum, w3 * inv_w_sum };        \
+                    float z = 1.0f / (bary[0] * z1 + bary[1] * z2 + bary[2] * z3);              \
+                    rn->zb.buffer[offset] = z;                                                  \
+                    PIXEL_CODE                                                                  \
+                }                                                                               \
+                w1 += w1_x_step;                                                                \
+                w2 += w2_x_step;                                                                \
+                w3 += w3_x_step;                                                                \
+            }                                                                                   \
+        }                                                                                       \
+    }
+
+#define PF_TRIANGLE_TRAVEL_DEPTH_OMP(PIXEL_CODE)                                                \
+    const uint32_t tiles_xmin = xmin - xmin % PF_RASTER_TILE_SIZE;                              \
+    const uint32_t tiles_ymin = ymin - ymin % PF_RASTER_TILE_SIZE;                              \
+    const int tiles_x = (xmax - tiles_xmin) / PF_RASTER_TILE_SIZE + 1;                          \
+    const int tiles_y = (ymax - tiles_ymin) / PF_RASTER_TILE_SIZE + 1;                          \
+    _Pragma("omp parallel for schedule(dynamic)                                                 \
+        if (((xmax - xmin) * (ymax - ymin)) >= PF_OMP_TRIANGLE_AABB_THRESHOLD)")                \
+    for (int tile = 0; tile < tiles_x * tiles_y; ++tile) {                                      \
+        uint32_t tx_min = PF_MAX(tiles_xmin + (tile % tiles_x) * PF_RASTER_TILE_SIZE, xmin);    \
+        uint32_t ty_min = PF_MAX(tiles_ymin + (tile / tiles_x) * PF_RASTER_TILE_SIZE, ymin);    \
+        uint32_t tx_max = PF_MIN(tiles_xmin + (tile % tiles_x + 1) * PF_RASTER_TILE_SIZE - 1, xmax);\
+        uint32_t ty_max = PF_MIN(tiles_ymin + (tile / tiles_x + 1) * PF_RASTER_TILE_SIZE - 1, ymax);\
+        int tw = tx_max - tx_min, th = ty_max - ty_min;                                         \
+        int w1_tile = w1_row + (tx_min - xmin) * w1_x_step + (ty_min - ymin) * w1_y_step;       \
+        int w2_tile = w2_row + (tx_min - xmin) * w2_x_step + (ty_min - ymin) * w2_y_step;       \
+        int w3_tile = w3_row + (tx_min - xmin) * w3_x_step + (ty_min - ymin) * w3_y_step;       \
+        if (PF_TILE_EDGE_MAX(w1_tile, w1_x_step, w1_y_step) < 0                                 \
+         || PF_TILE_EDGE_MAX(w2_tile, w2_x_step, w2_y_step) < 0                                 \
+         || PF_TILE_EDGE_MAX(w3_tile, w3_x_step, w3_y_step) < 0) {                              \
+            continue;                                                                           \
+        }                                                                                       \
+        for (uint32_t y = ty_min; y <= ty_max; ++y) {                                           \
+            int w1 = w1_tile + (y - ty_min) * w1_y_step;                                        \
+            int w2 = w2_tile + (y - ty_min) * w2_y_step;                                        \
+            int w3 = w3_tile + (y - ty_min) * w3_y_step;                                        \
+            for (uint32_t x = tx_min; x <= tx_max; ++x) {                                       \
+                if ((w1 | w2 | w3) >= 0) {                                                      \
+                    uint32_t offset = y * rn->fb.w + x;                                         \
+                    pf_vec3_t bary = { w1 * inv_w_sum, w2 * inv_w_sum, w3 * inv_w_sum };        \
+                    float z = 1.0f / (bary[0] * z1 + bary[1] * z2 + bary[2] * z3);              \
+                    if (test(rn->zb.buffer[offset], z)) {                                       \
+                        rn->zb.buffer[offset] = z;                                              \
+                        PIXEL_CODE                                                              \
+                    }                                                                           \
+                }                                                                               \
+                w1 += w1_x_step;                                                                \
+                w2 += w2_x_step;                                                                \
+                w3 += w3_x_step;                                                                \
+            }                                                                                   \
+        }                                                                                       \
+    }
+
+/* Internal Small Triangle Macros */
+
+/*
+    Triangles whose bounding box fits in a block of PF_SIMD_SIZE x PF_SIMD_SIZE pixels
+    are rasterized without any OpenMP dispatch, the coverage of each row of the block
+    is obtained with a single SIMD evaluation of the three edge functions.
+*/
+
+#define PF_TRIANGLE_TRAVEL_SMALL(PIXEL_CODE)                                                    \
+    const pf_simd_i_t lanes = pf_simd_setr_i32(0, 1, 2, 3, 4, 5, 6, 7);                         \
+    const pf_simd_i_t w1_x_step_v = pf_simd_mullo_i32(pf_simd_set1_i32(w1_x_step), lanes);      \
+    const pf_simd_i_t w2_x_step_v = pf_simd_mullo_i32(pf_simd_set1_i32(w2_x_step), lanes);      \
+    const pf_simd_i_t w3_x_step_v = pf_simd_mullo_i32(pf_simd_set1_i32(w3_x_step), lanes);      \
+    const int lanes_mask = (1 << (xmax - xmin + 1)) - 1;                                        \
+    for (uint32_t y = ymin, y_offset = ymin*rn->fb.w; y <= ymax; ++y, y_offset += rn->fb.w) {   \
+        pf_simd_i_t w1_v = pf_simd_add_i32(pf_simd_set1_i32(w1_row), w1_x_step_v);              \
+        pf_simd_i_t w2_v = pf_simd_add_i32(pf_simd_set1_i32(w2_row), w2_x_step_v);              \
+        pf_simd_i_t w3_v = pf_simd_add_i32(pf_simd_set1_i32(w3_row), w3_x_step_v);              \
+        int outside = pf_simd_movemask_i8(pf_simd_or_i32(pf_simd_or_i32(w1_v, w2_v), w3_v));    \
+        for (int i = 0; i <= (int)(xmax - xmin); ++i) {                                         \
+            if ((lanes_mask >> i) & 1 && !((outside >> (4 * i + 3)) & 1)) {                     \
+                int w1 = w1_row + i * w1_x_step;                                                \
+                int w2 = w2_row + i * w2_x_step;                                                \
+                int w3 = w3_row + i * w3_x_step;                                                \
+                uint32_t offset = y_offset + xmin + i;                                          \
                 pf_vec3_t bary = { w1 * inv_w_sum, w2 * inv_w_sum, w3 * inv_w_sum };            \
-                float z = 1.0f / (bary[0] * z1 + bary[1] * z2 + bary[2] * z3);                  \
-                rn->zb.buffer[offset] = z;                                                      \
-                PIXEL_CODE                                                                      \
+                float z = 1.0f/(bary[0]*z1 + bary[1]*z2 + bary[2]*z3);                          \
+                if (test == NULL || test(rn->zb.buffer[offset], z)) {                           \
+                    rn->zb.buffer[offset] = z;                                                  \
+                    PIXEL_CODE                                                                  \
+                }                                                                               \
+            }                                                                                   \
+        }                                                                                       \
+        w1_row += w1_y_step;                                                                    \
+        w2_row += w2_y_step;                                                                    \
+        w3_row += w3_y_step;                                                                    \
+    }
+
+/* Internal Multisampling Macros */
+
+/*
+    Rotated grid pattern of the four samples, in sixteenths of a pixel relative
+    to the pixel center. Each sample is tested against the three edge functions
+    and the depth buffer of its own plane, while the fragment is only shaded once
+    per pixel, at the pixel center or at the first covered sample if the center
+    lies outside the triangle, then written to every covered sample.
+*/
+
+static const int pf_msaa_pattern_INTERNAL[PF_MSAA_SAMPLES][2] = {
+    { -2, -6 }, { 6, -2 }, { -6, 2 }, { 2, 6 }
+};
+
+#define PF_MSAA_SETUP()                                                                         \
+    const size_t plane = (size_t)rn->fb.w * rn->fb.h;                                           \
+    const float inv_ws_sum = inv_w_sum * (1.0f / 16);                                           \
+    int w1_s[PF_MSAA_SAMPLES], w2_s[PF_MSAA_SAMPLES], w3_s[PF_MSAA_SAMPLES];                    \
+    float z_s[PF_MSAA_SAMPLES];                                                                 \
+    for (int s = 0; s < PF_MSAA_SAMPLES; ++s) {                                                 \
+        int ox = pf_msaa_pattern_INTERNAL[s][0], oy = pf_msaa_pattern_INTERNAL[s][1];           \
+        w1_s[s] = ox * w1_x_step + oy * w1_y_step;                                              \
+        w2_s[s] = ox * w2_x_step + oy * w2_y_step;                                              \
+        w3_s[s] = ox * w3_x_step + oy * w3_y_step;                                              \
+        z_s[s] = (w1_s[s] * z1 + w2_s[s] * z2 + w3_s[s] * z3) * inv_ws_sum;                     \
+    }                                                                                           \
+    int w1_s_min = PF_MIN(PF_MIN(w1_s[0], w1_s[1]), PF_MIN(w1_s[2], w1_s[3]));                  \
+    int w2_s_min = PF_MIN(PF_MIN(w2_s[0], w2_s[1]), PF_MIN(w2_s[2], w2_s[3]));                  \
+    int w3_s_min = PF_MIN(PF_MIN(w3_s[0], w3_s[1]), PF_MIN(w3_s[2], w3_s[3]));                  \
+    int w1_s_max = PF_MAX(PF_MAX(w1_s[0], w1_s[1]), PF_MAX(w1_s[2], w1_s[3]));                  \
+    int w2_s_max = PF_MAX(PF_MAX(w2_s[0], w2_s[1]), PF_MAX(w2_s[2], w2_s[3]));                  \
+    int w3_s_max = PF_MAX(PF_MAX(w3_s[0], w3_s[1]), PF_MAX(w3_s[2], w3_s[3]));
+
+#define PF_MSAA_PIXEL(SAMPLE_CODE)                                                              \
+    int e1 = 16 * w1, e2 = 16 * w2, e3 = 16 * w3;                                               \
+    if (((e1 + w1_s_max) | (e2 + w2_s_max) | (e3 + w3_s_max)) >= 0) {                           \
+        uint32_t offset = y * rn->fb.w + x;                                                     \
+        int coverage = (1 << PF_MSAA_SAMPLES) - 1;                                              \
+        if (((e1 + w1_s_min) | (e2 + w2_s_min) | (e3 + w3_s_min)) < 0) {                        \
+            coverage = 0;                                                                       \
+            for (int s = 0; s < PF_MSAA_SAMPLES; ++s) {                                         \
+                coverage |= (((e1 + w1_s[s]) | (e2 + w2_s[s]) | (e3 + w3_s[s])) >= 0) << s;     \
+            }                                                                                   \
+        }                                                                                       \
+        float z_center = (w1 * z1 + w2 * z2 + w3 * z3) * inv_w_sum;                             \
+        int mask = 0;                                                                           \
+        for (int s = 0; s < PF_MSAA_SAMPLES; ++s) {                                             \
+            if (coverage & (1 << s)) {                                                          \
+                float* zs = rn->msaa_depth + s * plane + offset;                                \
+                float z = 1.0f / (z_center + z_s[s]);                                           \
+                if (test == NULL || test(*zs, z)) {                                             \
+                    *zs = z;                                                                    \
+                    mask |= 1 << s;                                                             \
+                }                                                                               \
             }                                                                                   \
+        }                                                                                       \
+        if (mask != 0) {                                                                        \
+            rn->msaa_coverage[offset] = 1;                                                      \
+            int first = 0;                                                                      \
+            while (!(mask & (1 << first))) ++first;                                             \
+            pf_vec3_t bary = { w1 * inv_w_sum, w2 * inv_w_sum, w3 * inv_w_sum };                \
+            if ((w1 | w2 | w3) < 0) {                                                           \
+                bary[0] = (e1 + w1_s[first]) * inv_ws_sum;                                      \
+                bary[1] = (e2 + w2_s[first]) * inv_ws_sum;                                      \
+                bary[2] = (e3 + w3_s[first]) * inv_ws_sum;                                      \
+            }                                                                                   \
+            pf_color_t final_color = rn->msaa_color[first * plane + offset];                    \
+            pf_vertex_t vertex;                                                                 \
+            pf_renderer_triangle_interpolation_INTERNAL(&vertex, v1, v2, v3, bary, persp);      \
+            PF_FRAGMENT_CALL()                                                                  \
+            for (int s = first; s < PF_MSAA_SAMPLES; ++s) {                                     \
+                if (mask & (1 << s)) {                                                          \
+                    pf_color_t* ptr = rn->msaa_color + s * plane + offset;                      \
+                    SAMPLE_CODE                                                                 \
+                }                                                                               \
+            }                                                                                   \
+        }                                                                                       \
+    }
+
+#define PF_TRIANGLE_TRAVEL_MSAA(PIXEL_CODE)                                                     \
+    for (uint32_t y = ymin; y <= ymax; ++y) {                                                   \
+        int w1 = w1_row;                                                                        \
+        int w2 = w2_row;                                                                        \
+        int w3 = w3_row;                                                                        \
+        for (uint32_t x = xmin; x <= xmax; ++x) {                                               \
+            PIXEL_CODE                                                                          \
             w1 += w1_x_step;                                                                    \
             w2 += w2_x_step;                                                                    \
             w3 += w3_x_step;                                                                    \
         }                                                                                       \
+        w1_row += w1_y_step;                                                                    \
+        w2_row += w2_y_step;                                                                    \
+        w3_row += w3_y_step;                                                                    \
     }
 
-#define PF_TRIANGLE_TRAVEL_DEPTH_OMP(PIXEL_CODE)                                                \
+#define PF_TRIANGLE_TRAVEL_MSAA_OMP(PIXEL_CODE)                                                 \
     _Pragma("omp parallel for schedule(dynamic)                                                 \
         if (((xmax - xmin) * (ymax - ymin)) >= PF_OMP_TRIANGLE_AABB_THRESHOLD)")                \
     for (uint32_t y = ymin; y <= ymax; ++y) {                                                   \
@@ -302,46 +597,47 @@
         int w2 = w2_row + (y - ymin) * w2_y_step;                                               \
         int w3 = w3_row + (y - ymin) * w3_y_step;                                               \
         for (uint32_t x = xmin; x <= xmax; ++x) {                                               \
-            if ((w1 | w2 | w3) >= 0) {                                                          \
-                uint32_t offset = y * rn->fb.w + x;                                             \
-                pf_vec3_t bary = { w1 * inv_w_sum, w2 * inv_w_sum, w3 * inv_w_sum };            \
-                float z = 1.0f / (bary[0] * z1 + bary[1] * z2 + bary[2] * z3);                  \
-                if (test(rn->zb.buffer[offset], z)) {                                           \
-                    rn->zb.buffer[offset] = z;                                                  \
-                    PIXEL_CODE                                                                  \
-                }                                                                               \
-            }                                                                                   \
+            PIXEL_CODE                                                                          \
             w1 += w1_x_step;                                                                    \
             w2 += w2_x_step;                                                                    \
             w3 += w3_x_step;                                                                    \
         }                                                                                       \
     }
 
-/* Internal Pixel Code Macros */
-
-#define PF_PIXEL_CODE_NOBLEND()                                                 \
-    pf_color_t* ptr = rn->fb.buffer + offset;                                   \
-    pf_color_t final_color = *ptr;                                              \
-    pf_vertex_t vertex;                                                         \
-    pf_renderer_triangle_interpolation_INTERNAL(&vertex, v1, v2, v3, bary, z);  \
-    fragment(rn, &vertex, &final_color, uniforms);                              \
+#define PF_SAMPLE_CODE_NOBLEND()                                                                \
     *ptr = final_color;
 
-#define PF_PIXEL_CODE_BLEND()                                                   \
-    pf_color_t* ptr = rn->fb.buffer + offset;                                   \
-    pf_color_t final_color = *ptr;                                              \
-    pf_vertex_t vertex;                                                         \
-    pf_renderer_triangle_interpolation_INTERNAL(&vertex, v1, v2, v3, bary, z);  \
-    fragment(rn, &vertex, &final_color, uniforms);                              \
+#define PF_SAMPLE_CODE_BLEND()                                                                  \
     *ptr = blend(*ptr, final_color);
 
+/* Internal Pixel Code Macros */
+
+#define PF_FRAGMENT_CALL()                                                          \
+    pf_fragment_gradient_INTERNAL = &gradient;                                      \
+    pf_fragment_bary_INTERNAL = bary;                                               \
+    fragment(rn, &vertex, &final_color, uniforms);                                  \
+    pf_fragment_gradient_INTERNAL = NULL;
+
+#define PF_PIXEL_CODE_NOBLEND()                                                     \
+    pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);                  \
+    pf_vertex_t vertex;                                                             \
+    pf_renderer_triangle_interpolation_INTERNAL(&vertex, v1, v2, v3, bary, persp);  \
+    PF_FRAGMENT_CALL()                                                              \
+    pf_framebuffer_store(&rn->fb, offset, final_color);
+
+#define PF_PIXEL_CODE_BLEND()                                                       \
+    pf_color_t final_color = pf_framebuffer_load(&rn->fb, offset);                  \
+    pf_vertex_t vertex;                                                             \
+    pf_renderer_triangle_interpolation_INTERNAL(&vertex, v1, v2, v3, bary, persp);  \
+    PF_FRAGMENT_CALL()                                                              \
+    pf_framebuffer_blend(&rn->fb, offset, final_color, blend);
+
 /* Helper Function Declarations */
 
 void
 pf_renderer_screen_projection_INTERNAL(
     const pf_renderer_t* rn,
     pf_vec4_t* homogeneous,
-    pf_vertex_t* vertices,
     size_t vertices_count,
     int screen_pos[][2]);
 
@@ -352,10 +648,61 @@ pf_renderer_triangle_interpolation_INTERNAL(
     pf_vertex_t* v2,
     pf_vertex_t* v3,
     pf_vec3_t bary,
-    float z_depth);
+    const float* inv_w);
 
 /* Internal Clipping Function */
 
+// NOTE: Clipping against the 'w' plane then the six planes of the frustum
+//       adds at most two vertices per plane to the initial triangle
+#define PF_CLIP_PLANES_COUNT 7
+#define PF_CLIP_POOL_SIZE (3 + 2 * PF_CLIP_PLANES_COUNT)
+
+static inline float
+pf_clip3d_plane_distance_INTERNAL(
+    const pf_vec4_t h,
+    int_fast8_t plane)
+{
+    // NOTE: Plane 0 is 'w > epsilon', then for each axis '+x <= w' and '-x <= w'
+    if (plane == 0) return h[3] - PF_EPSILON;
+    int_fast8_t axis = (plane - 1) >> 1;
+    return ((plane - 1) & 1) ? h[3] + h[axis] : h[3] - h[axis];
+}
+
+static void
+pf_clip3d_vertex_bary_INTERNAL(
+    pf_vertex_t* restrict result,
+    const pf_vertex_t triangle[3],
+    const pf_vec3_t weights)
+{
+    // NOTE: Unlike 'pf_vertex_bary', components are accumulated as floats and
+    //       rounded once, so that byte attributes don't lose precision
+    for (uint32_t i = 0; i < PF_MAX_ATTRIBUTES; ++i) {
+        const pf_attrib_elem_t* e1 = &triangle[0].elements[i];
+        const pf_attrib_elem_t* e2 = &triangle[1].elements[i];
+        const pf_attrib_elem_t* e3 = &triangle[2].elements[i];
+        pf_attrib_elem_t* er = &result->elements[i];
+
+        er->used = e1->used & e2->used & e3->used;
+        if (!er->used) continue;
+
+        er->type = e1->type;
+        er->comp = PF_MIN(e1->comp, PF_MIN(e2->comp, e3->comp));
+
+        for (int_fast8_t j = 0; j < er->comp; ++j) {
+            if (er->type == PF_ATTRIB_FLOAT) {
+                er->value[j].v_float = weights[0] * e1->value[j].v_float
+                                     + weights[1] * e2->value[j].v_float
+                                     + weights[2] * e3->value[j].v_float;
+            } else {
+                float value = weights[0] * e1->value[j].v_uint8_t
+                            + weights[1] * e2->value[j].v_uint8_t
+                            + weights[2] * e3->value[j].v_uint8_t;
+                er->value[j].v_uint8_t = (uint8_t)PF_CLAMP(value + 0.5f, 0.0f, 255.0f);
+            }
+        }
+    }
+}
+
 // TODO: Fix the warping issue that occurs during near clipping
 // NOTE: To avoid this problem of deformation, it is currently advisable
 //       to apply the smallest "near" value possible in your projection matrix.
@@ -368,121 +715,109 @@ pf_clip3d_triangle3d_INTERNAL(
 {
     (void)rn;
 
-    pf_vec4_t input_homogen[PF_MAX_CLIPPED_POLYGON_VERTICES];
-    pf_vertex_t input_vt[PF_MAX_CLIPPED_POLYGON_VERTICES];
-    int_fast8_t input_count;
-
-    // CLIP W
-    memcpy(input_homogen, out_homogeneous, (*out_vertices_count) * sizeof(pf_vec4_t));
-    memcpy(input_vt, out_vertices, (*out_vertices_count) * sizeof(pf_vertex_t));
-    input_count = *out_vertices_count;
-    *out_vertices_count = 0;
+    /*
+        The clipping is done on indices into a small pool of vertices of which only the homogeneous
+        positions are computed. Each vertex created on an edge (a, b, t) records its barycentric
+        weights relative to the original triangle, so that the attributes are only computed
+        once, at the end, for the vertices that survive all the planes.
+    */
 
-    pf_vec4_t* prev_homogen = &input_homogen[input_count - 1];
-    pf_vertex_t* prev_vt = &input_vt[input_count - 1];
+    /* Trivial accept and reject */
 
-    int_fast8_t prevDot = ((*prev_homogen)[3] < PF_EPSILON) ? -1 : 1;
+    uint8_t outcodes[3] = { 0 };
 
-    for (int_fast8_t i = 0; i < input_count; ++i) {
-        int_fast8_t currDot = (input_homogen[i][3] < PF_EPSILON) ? -1 : 1;
-
-        if (prevDot * currDot < 0) {
-            float t = (PF_EPSILON - (*prev_homogen)[3]) / (input_homogen[i][3] - (*prev_homogen)[3]);
-            pf_vec4_lerp_r(out_homogeneous[*out_vertices_count], *prev_homogen, input_homogen[i], t);
-            pf_vertex_lerp(&out_vertices[*out_vertices_count], prev_vt, &input_vt[i], t);
-            (*out_vertices_count)++;
-        }
-
-        if (currDot > 0) {
-            pf_vec4_copy(out_homogeneous[*out_vertices_count], input_homogen[i]);
-            out_vertices[*out_vertices_count] = input_vt[i];
-            (*out_vertices_count)++;
+    for (int_fast8_t i = 0; i < 3; ++i) {
+        for (int_fast8_t plane = 0; plane < PF_CLIP_PLANES_COUNT; ++plane) {
+            if (pf_clip3d_plane_distance_INTERNAL(out_homogeneous[i], plane) < 0) {
+                outcodes[i] |= 1 << plane;
+            }
         }
+    }
 
-        prev_homogen = &input_homogen[i];
-        prev_vt = &input_vt[i];
-        prevDot = currDot;
+    if ((outcodes[0] | outcodes[1] | outcodes[2]) == 0) {
+        *out_vertices_count = 3;
+        return;
     }
 
-    if (*out_vertices_count == 0) {
+    if ((outcodes[0] & outcodes[1] & outcodes[2]) != 0) {
+        *out_vertices_count = 0;
         return;
     }
 
-    // CLIP XYZ
-    for (int_fast8_t iAxis = 0; iAxis < 3; iAxis++) {
-        pf_vec4_t input_homogen[PF_MAX_CLIPPED_POLYGON_VERTICES];
-        pf_vertex_t input_vt[PF_MAX_CLIPPED_POLYGON_VERTICES];
-        int_fast8_t input_count;
+    /* Initialize the pool with the triangle */
 
-        memcpy(input_homogen, out_homogeneous, (*out_vertices_count) * sizeof(pf_vec4_t));
-        memcpy(input_vt, out_vertices, (*out_vertices_count) * sizeof(pf_vertex_t));
-        input_count = *out_vertices_count;
-        *out_vertices_count = 0;
+    pf_vec4_t pool_homogen[PF_CLIP_POOL_SIZE];
+    pf_vec3_t pool_weights[PF_CLIP_POOL_SIZE];
+    int_fast8_t pool_count = 3;
+
+    for (int_fast8_t i = 0; i < 3; ++i) {
+        pf_vec4_copy(pool_homogen[i], out_homogeneous[i]);
+        pool_weights[i][0] = (i == 0);
+        pool_weights[i][1] = (i == 1);
+        pool_weights[i][2] = (i == 2);
+    }
+
+    uint8_t polygons[2][PF_MAX_CLIPPED_POLYGON_VERTICES] = { { 0, 1, 2 } };
+    uint8_t* input = polygons[0];
+    uint8_t* output = polygons[1];
+    int_fast8_t input_count = 3;
+
+    /* Clip the polygon against each plane crossed by the triangle */
+
+    const uint8_t crossed = outcodes[0] | outcodes[1] | outcodes[2];
 
-        pf_vec4_t* prev_homogen = &input_homogen[input_count - 1];
-        pf_vertex_t* prev_vt = &input_vt[input_count - 1];
+    for (int_fast8_t plane = 0; plane < PF_CLIP_PLANES_COUNT; ++plane) {
+        if (!(crossed & (1 << plane))) continue;
 
-        int_fast8_t prevDot = ((*prev_homogen)[iAxis] <= (*prev_homogen)[3]) ? 1 : -1;
+        int_fast8_t output_count = 0;
+
+        uint8_t prev = input[input_count - 1];
+        float prev_dist = pf_clip3d_plane_distance_INTERNAL(pool_homogen[prev], plane);
 
         for (int_fast8_t i = 0; i < input_count; ++i) {
-            int_fast8_t currDot = (input_homogen[i][iAxis] <= input_homogen[i][3]) ? 1 : -1;
-
-            if (prevDot * currDot <= 0) {
-                float t = (*prev_homogen)[3] - (*prev_homogen)[iAxis];
-                t /= t - (input_homogen[i][3] - input_homogen[i][iAxis]);
-                pf_vec4_lerp_r(out_homogeneous[*out_vertices_count], *prev_homogen, input_homogen[i], t);
-                pf_vertex_lerp(&out_vertices[*out_vertices_count], prev_vt, &input_vt[i], t);
-                (*out_vertices_count)++;
+            uint8_t curr = input[i];
+            float curr_dist = pf_clip3d_plane_distance_INTERNAL(pool_homogen[curr], plane);
+
+            if ((prev_dist < 0) != (curr_dist < 0)) {
+                float t = prev_dist / (prev_dist - curr_dist);
+                pf_vec4_lerp_r(pool_homogen[pool_count], pool_homogen[prev], pool_homogen[curr], t);
+                pf_vec3_lerp_r(pool_weights[pool_count], pool_weights[prev], pool_weights[curr], t);
+                output[output_count++] = pool_count++;
             }
 
-            if (currDot > 0) {
-                pf_vec4_copy(out_homogeneous[*out_vertices_count], input_homogen[i]);
-                out_vertices[*out_vertices_count] = input_vt[i];
-                (*out_vertices_count)++;
+            if (curr_dist >= 0) {
+                output[output_count++] = curr;
             }
 
-            prev_homogen = &input_homogen[i];
-            prev_vt = &input_vt[i];
-            prevDot = currDot;
+            prev = curr;
+            prev_dist = curr_dist;
         }
 
-        if (*out_vertices_count == 0) {
+        if (output_count == 0) {
+            *out_vertices_count = 0;
             return;
         }
 
-        memcpy(input_homogen, out_homogeneous, (*out_vertices_count) * sizeof(pf_vec4_t));
-        memcpy(input_vt, out_vertices, (*out_vertices_count) * sizeof(pf_vertex_t));
-        input_count = *out_vertices_count;
-        *out_vertices_count = 0;
-
-        prev_homogen = &input_homogen[input_count - 1];
-        prev_vt = &input_vt[input_count - 1];
-        prevDot = (-(*prev_homogen)[iAxis] <= (*prev_homogen)[3]) ? 1 : -1;
+        PF_SWAP(input, output);
+        input_count = output_count;
+    }
 
-        for (int_fast8_t i = 0; i < input_count; ++i) {
-            int_fast8_t currDot = (-input_homogen[i][iAxis] <= input_homogen[i][3]) ? 1 : -1;
-
-            if (prevDot * currDot <= 0) {
-                float t = (*prev_homogen)[3] + (*prev_homogen)[iAxis];
-                t /= t - (input_homogen[i][3] + input_homogen[i][iAxis]);
-                pf_vec4_lerp_r(out_homogeneous[*out_vertices_count], *prev_homogen, input_homogen[i], t);
-                pf_vertex_lerp(&out_vertices[*out_vertices_count], prev_vt, &input_vt[i], t);
-                (*out_vertices_count)++;
-            }
+    /* Compute the attributes of the surviving vertices */
 
-            if (currDot > 0) {
-                pf_vec4_copy(out_homogeneous[*out_vertices_count], input_homogen[i]);
-                out_vertices[*out_vertices_count] = input_vt[i];
-                (*out_vertices_count)++;
-            }
+    *out_vertices_count = input_count;
+    if (input_count < 3) return;
 
-            prev_homogen = &input_homogen[i];
-            prev_vt = &input_vt[i];
-            prevDot = currDot;
-        }
+    pf_vertex_t triangle[3] = {
+        out_vertices[0], out_vertices[1], out_vertices[2]
+    };
 
-        if (*out_vertices_count == 0) {
-            return;
+    for (int_fast8_t i = 0; i < input_count; ++i) {
+        uint8_t index = input[i];
+        pf_vec4_copy(out_homogeneous[i], pool_homogen[index]);
+        if (index < 3) {
+            out_vertices[i] = triangle[index];
+        } else {
+            pf_clip3d_vertex_bary_INTERNAL(&out_vertices[i], triangle, pool_weights[index]);
         }
     }
 }
@@ -490,27 +825,21 @@ pf_clip3d_triangle3d_INTERNAL(
 /* Internal Rendering Functions */
 
 void
-pf_renderer_triangle3d_INTERNAL(
+pf_renderer_triangle3d_transformed_INTERNAL(
     pf_renderer_t* rn, pf_vertex_t vertices[PF_MAX_CLIPPED_POLYGON_VERTICES],
-    const pf_mat4_t mat_model, const pf_mat4_t mat_normal,
-    const pf_mat4_t mat_mvp, const pf_proc3d_t* proc,
-    bool parallelize)
+    pf_vec4_t homogens[PF_MAX_CLIPPED_POLYGON_VERTICES],
+    const pf_proc3d_t* proc, bool parallelize)
 {
 #ifndef _OPENMP
     (void)parallelize;
 #endif
 
-    /* Copy vertices, the clipping step may result in more vertex than expected */
+    // NOTE: The first three vertices must have already been processed by the vertex
+    //       stage, the arrays must be large enough because clipping can produce more
+    //       vertices than expected
 
-    pf_vec4_t homogens[PF_MAX_CLIPPED_POLYGON_VERTICES] = { 0 };
     size_t vertices_count = 3;
 
-    /* Transform vertices */
-
-    proc->vertex(&vertices[0], homogens[0], mat_model, mat_normal, mat_mvp, proc->uniforms);
-    proc->vertex(&vertices[1], homogens[1], mat_model, mat_normal, mat_mvp, proc->uniforms);
-    proc->vertex(&vertices[2], homogens[2], mat_model, mat_normal, mat_mvp, proc->uniforms);
-
     /* Clip triangle */
 
     pf_clip3d_triangle3d_INTERNAL(rn, vertices, homogens, &vertices_count);
@@ -519,7 +848,7 @@ pf_renderer_triangle3d_INTERNAL(
     /* Projection to screen */
 
     int screen_pos[PF_MAX_CLIPPED_POLYGON_VERTICES][2] = { 0 };
-    pf_renderer_screen_projection_INTERNAL(rn, homogens, vertices, vertices_count, screen_pos);
+    pf_renderer_screen_projection_INTERNAL(rn, homogens, vertices_count, screen_pos);
 
     /* Get often used data */
 
@@ -540,6 +869,14 @@ pf_renderer_triangle3d_INTERNAL(
         float z2 = homogens[i + 1][2];
         float z3 = homogens[i + 2][2];
 
+        /*
+            Perspective correction data, the interpolation is skipped entirely when the
+            three '1/w' are equal, as always with an orthographic projection
+        */
+
+        pf_vec3_t inv_w = { homogens[0][3], homogens[i + 1][3], homogens[i + 2][3] };
+        const float* persp = (inv_w[0] == inv_w[1] && inv_w[1] == inv_w[2]) ? NULL : inv_w;
+
         int w1_x_step, w2_x_step, w3_x_step;
         int w1_y_step, w2_y_step, w3_y_step;
         int w1_row, w2_row, w3_row;
@@ -570,6 +907,9 @@ pf_renderer_triangle3d_INTERNAL(
             xmax = (uint32_t)PF_MAX(x1, PF_MAX(x2, x3));
             ymax = (uint32_t)PF_MAX(y1, PF_MAX(y2, y3));
 
+            pf_framebuffer_damage_add(&rn->damage,
+                (int)xmin, (int)ymin, (int)xmax, (int)ymax);
+
             /* Barycentric interpolation */
 
             w1_x_step = y3 - y2, w1_y_step = x2 - x3;
@@ -596,6 +936,63 @@ pf_renderer_triangle3d_INTERNAL(
 
         inv_w_sum = 1.0f/(w1_row + w2_row + w3_row);
 
+        /* Texture coordinates gradient, for the fragment processors which request it */
+
+        pf_texcoord_gradient_INTERNAL_t gradient;
+        {
+            pf_vec3_t bary_dx = { w1_x_step * inv_w_sum, w2_x_step * inv_w_sum, w3_x_step * inv_w_sum };
+            pf_vec3_t bary_dy = { w1_y_step * inv_w_sum, w2_y_step * inv_w_sum, w3_y_step * inv_w_sum };
+            pf_texcoord_gradient_setup_INTERNAL(&gradient, v1, v2, v3, persp, bary_dx, bary_dy);
+        }
+
+        /* Multisampled rasterization */
+
+        if (rn->msaa_color != NULL) {
+            PF_MSAA_SETUP()
+#if defined(_OPENMP)
+            if (parallelize) {
+                if (blend != NULL) {
+                    PF_TRIANGLE_TRAVEL_MSAA_OMP({
+                        PF_MSAA_PIXEL(PF_SAMPLE_CODE_BLEND())
+                    })
+                } else {
+                    PF_TRIANGLE_TRAVEL_MSAA_OMP({
+                        PF_MSAA_PIXEL(PF_SAMPLE_CODE_NOBLEND())
+                    })
+                }
+            } else
+#endif
+            {
+                if (blend != NULL) {
+                    PF_TRIANGLE_TRAVEL_MSAA({
+                        PF_MSAA_PIXEL(PF_SAMPLE_CODE_BLEND())
+                    })
+                } else {
+                    PF_TRIANGLE_TRAVEL_MSAA({
+                        PF_MSAA_PIXEL(PF_SAMPLE_CODE_NOBLEND())
+                    })
+                }
+            }
+            continue;
+        }
+
+        /* Small triangle rasterization */
+
+#if PF_SIMD_SIZE > 1
+        if (xmax - xmin < PF_SIMD_SIZE && ymax - ymin < PF_SIMD_SIZE) {
+            if (blend != NULL) {
+                PF_TRIANGLE_TRAVEL_SMALL({
+                    PF_PIXEL_CODE_BLEND()
+                })
+            } else {
+                PF_TRIANGLE_TRAVEL_SMALL({
+                    PF_PIXEL_CODE_NOBLEND()
+                })
+            }
+            continue;
+        }
+#endif
+
         /* Loop rasterization */
 
 #if defined(_OPENMP)
@@ -648,3 +1045,24 @@ pf_renderer_triangle3d_INTERNAL(
         }
     }
 }
+
+void
+pf_renderer_triangle3d_INTERNAL(
+    pf_renderer_t* rn, pf_vertex_t vertices[PF_MAX_CLIPPED_POLYGON_VERTICES],
+    const pf_mat4_t mat_model, const pf_mat4_t mat_normal,
+    const pf_mat4_t mat_mvp, const pf_proc3d_t* proc,
+    bool parallelize)
+{
+    pf_vec4_t homogens[PF_MAX_CLIPPED_POLYGON_VERTICES] = { 0 };
+
+    /* Transform vertices */
+
+    proc->vertex(&vertices[0], homogens[0], mat_model, mat_normal, mat_mvp, proc->uniforms);
+    proc->vertex(&vertices[1], homogens[1], mat_model, mat_normal, mat_mvp, proc->uniforms);
+    proc->vertex(&vertices[2], homogens[2], mat_model, mat_normal, mat_mvp, proc->uniforms);
+
+    /* Clip and rasterize */
+
+    pf_renderer_triangle3d_transformed_INTERNAL(
+        rn, vertices, homogens, proc, parallelize);
+}
@@ -28,6 +28,11 @@ pf_renderer_triangle3d_INTERNAL(
     const pf_mat4_t mat_mvp, const pf_proc3d_t* proc,
     bool parallelize);
 
+bool
+pf_renderer_fragment_texcoord_gradient_INTERNAL(
+    pf_vec2_t duv_dx,
+    pf_vec2_t duv_dy);
+
 /* Triangle rasterization functions */
 
 void
@@ -87,3 +92,16 @@ pf_renderer_triangle(
     pf_renderer_triangle3d_INTERNAL(
         rn, vertices, mat_identity, mat_identity, mat_mvp, &processor, true);
 }
+
+/* Fragment functions */
+
+bool
+pf_renderer_get_texcoord_gradient(
+    const pf_renderer_t* rn,
+    pf_vec2_t duv_dx,
+    pf_vec2_t duv_dy)
+{
+    (void)rn;
+
+    return pf_renderer_fragment_texcoord_gradient_INTERNAL(duv_dx, duv_dy);
+}
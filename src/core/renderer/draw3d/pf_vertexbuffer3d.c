@@ -40,6 +40,62 @@ pf_renderer_line3d_INTERNAL(
     const pf_mat4_t mat_model, const pf_mat4_t mat_normal,
     const pf_mat4_t mat_mvp, const pf_proc3d_t* proc);
 
+void
+pf_renderer_triangle3d_transformed_INTERNAL(
+    pf_renderer_t* rn, pf_vertex_t vertices[PF_MAX_CLIPPED_POLYGON_VERTICES],
+    pf_vec4_t homogens[PF_MAX_CLIPPED_POLYGON_VERTICES],
+    const pf_proc3d_t* proc, bool parallelize);
+
+bool
+pf_vertexbuffer_assemble_slot_INTERNAL(
+    const pf_vertexbuffer_t* vb, uint32_t* count,
+    uint32_t index, uint32_t* slot);
+
+bool
+pf_vertexbuffer_assemble_push_INTERNAL(
+    const pf_vertexbuffer_t* vb, uint32_t* count,
+    uint32_t slot, uint32_t tri[3]);
+
+/* Internal Helper Functions */
+
+static void
+pf_vertexbuffer3d_fetch_INTERNAL(
+    const pf_vertexbuffer_t* vb,
+    pf_vertex_t* vertex,
+    uint32_t index)
+{
+    for (uint32_t i_attr = 0; i_attr < PF_MAX_ATTRIBUTES; ++i_attr) {
+        const pf_attribute_t* attr = &vb->attributes[i_attr];
+        pf_attrib_elem_t* elem = &vertex->elements[i_attr];
+        elem->used = attr->used;
+        if (attr->used) {
+#          define PF_GET_ATTRIB_ELEM(TYPE, CTYPE)                                          \
+                case TYPE: {                                                               \
+                    const size_t stride = (attr->stride > 0)                               \
+                        ? attr->stride : attr->comp * sizeof(CTYPE);                       \
+                    const CTYPE* ptr = (const CTYPE*)((const char*)attr->buffer            \
+                        + attr->offset + index * stride);                                  \
+                    for (int_fast8_t i_vec = 0; i_vec < attr->comp; ++i_vec) {             \
+                        elem->value[i_vec].v_##CTYPE = ptr[i_vec];                         \
+                    }                                                                      \
+                    elem->type = attr->type;                                               \
+                    elem->comp = attr->comp;                                               \
+                } break;
+            switch (attr->type) {
+                PF_GET_ATTRIB_ELEM(PF_ATTRIB_FLOAT, float)
+                PF_GET_ATTRIB_ELEM(PF_ATTRIB_UBYTE, uint8_t)
+                default:
+                    // NOTE: Compact types are decoded to floats, or to bytes for colors
+                    *elem = (i_attr == PF_ATTRIB_COLOR)
+                        ? pf_attribute_get_color_elem(attr, index)
+                        : pf_attribute_get_elem(attr, index);
+                    break;
+            }
+#          undef PF_GET_ATTRIB_ELEM
+        }
+    }
+}
+
 
 /* Public API Functions */
 
@@ -95,49 +151,168 @@ pf_renderer_vertexbuffer3d_ex(
     bool has_indices = (indices != NULL);
     uint32_t num = (has_indices) ? vb->num_indices : vb->num_vertices;
 
+    uint32_t count = 0;
+
+    /*
+        Each vertex is fetched and processed only once, then kept in a small cache.
+        Strips and fans reuse the last two processed vertices for each new triangle.
+    */
+
+    pf_vertex_t cache_vertices[3];
+    pf_vec4_t cache_homogens[3];
+
+    /*
+        Indexed triangle lists also keep a FIFO of the last processed vertices,
+        so that vertices shared between nearby triangles are only processed once.
+        See 'pfext_vertexbuffer_optimize' to reorder meshes for this cache.
+    */
+
+    const bool use_post_cache = (has_indices && vb->topology == PF_TRIANGLES);
+
+    uint32_t post_indices[PF_VERTEX_CACHE_SIZE];
+    pf_vertex_t post_vertices[PF_VERTEX_CACHE_SIZE];
+    pf_vec4_t post_homogens[PF_VERTEX_CACHE_SIZE];
+    uint32_t post_next = 0;
+
+    for (int j = 0; j < PF_VERTEX_CACHE_SIZE; ++j) {
+        post_indices[j] = UINT32_MAX;
+    }
+
 // FIXME: Flickering during parallelization here and strangely 'omp critical' doesn't change the problem...
 //#   pragma omp parallel for schedule(dynamic)
-    for (uint32_t i = 0; i < num; i += 3) {
+    for (uint32_t i = 0; i < num; ++i) {
+        uint32_t index = (has_indices) ? indices[i] : i;
 
-        pf_vertex_t vertices[PF_MAX_CLIPPED_POLYGON_VERTICES];
-        {
-            uint32_t index[3];
-            for (int_fast8_t j = 0; j < 3; ++j) {
-                if (has_indices) index[j] = indices[i + j];
-                else index[j] = i + j;
+        /* Select the cache slot that will receive the new vertex */
+
+        uint32_t slot;
+        if (!pf_vertexbuffer_assemble_slot_INTERNAL(vb, &count, index, &slot)) {
+            continue;
+        }
+
+        /* Fetch and transform the new vertex, or reuse it from the post-transform cache */
+
+        int hit = -1;
+        if (use_post_cache) {
+            for (int j = 0; j < PF_VERTEX_CACHE_SIZE; ++j) {
+                if (post_indices[j] == index) { hit = j; break; }
             }
+        }
+
+        if (hit >= 0) {
+            cache_vertices[slot] = post_vertices[hit];
+            pf_vec4_copy(cache_homogens[slot], post_homogens[hit]);
+        } else {
+            pf_vertexbuffer3d_fetch_INTERNAL(vb, &cache_vertices[slot], index);
 
-            for (uint32_t i_attr = 0; i_attr < PF_MAX_ATTRIBUTES; ++i_attr) {
-                const pf_attribute_t* attr = &vb->attributes[i_attr];
-                if (attr->used) {
-#                  define PF_GET_ATTRIB_ELEM(TYPE, CTYPE)                                           \
-                        case TYPE:                                                                  \
-                            for (int_fast8_t i_vec = 0; i_vec < attr->comp; ++i_vec) {              \
-                                for (int_fast8_t i_vert = 0; i_vert < 3; i_vert++) {                \
-                                    vertices[i_vert].elements[i_attr].value[i_vec].v_##CTYPE =      \
-                                        ((CTYPE*)attr->buffer)[index[i_vert] * attr->comp + i_vec]; \
-                                    vertices[i_vert].elements[i_attr].type = attr->type;            \
-                                    vertices[i_vert].elements[i_attr].comp = attr->comp;            \
-                                    vertices[i_vert].elements[i_attr].used = true;                  \
-                                }                                                                   \
-                        } break;
-                    switch (attr->type) {
-                        PF_GET_ATTRIB_ELEM(PF_ATTRIB_FLOAT, float)
-                        PF_GET_ATTRIB_ELEM(PF_ATTRIB_UBYTE, uint8_t)
-                        default:
-                            break;
-                    }
-#                  undef PF_GET_ATTRIB_ELEM
-                }
+            processor.vertex(&cache_vertices[slot], cache_homogens[slot],
+                mat_model, mat_normal, mat_mvp, processor.uniforms);
+
+            if (use_post_cache) {
+                post_indices[post_next] = index;
+                post_vertices[post_next] = cache_vertices[slot];
+                pf_vec4_copy(post_homogens[post_next], cache_homogens[slot]);
+                post_next = (post_next + 1) % PF_VERTEX_CACHE_SIZE;
             }
         }
 
-        pf_renderer_triangle3d_INTERNAL(
-            rn, vertices, mat_model, mat_normal,
-            mat_mvp, &processor, true);
+        /* Assemble the triangle according to the topology */
+
+        uint32_t tri[3];
+        if (!pf_vertexbuffer_assemble_push_INTERNAL(vb, &count, slot, tri)) {
+            continue;
+        }
+
+        /* Copy the vertices, the clipping step may result in more vertex than expected */
+
+        pf_vertex_t vertices[PF_MAX_CLIPPED_POLYGON_VERTICES];
+        pf_vec4_t homogens[PF_MAX_CLIPPED_POLYGON_VERTICES];
+
+        for (int_fast8_t j = 0; j < 3; ++j) {
+            vertices[j] = cache_vertices[tri[j]];
+            pf_vec4_copy(homogens[j], cache_homogens[tri[j]]);
+        }
+
+        pf_renderer_triangle3d_transformed_INTERNAL(
+            rn, vertices, homogens, &processor, true);
     }
 }
 
+void
+pf_renderer_vertexbuffer3d_lod(
+    pf_renderer_t* rn, const pf_vertexbuffer_t* vb,
+    const pf_vertexbuffer_lod_t* lod,
+    const pf_mat4_t transform, const pf_proc3d_t* proc)
+{
+    if (rn->conf3d == NULL) {
+        return;
+    }
+
+    if (lod == NULL || lod->num_levels == 0) {
+        pf_renderer_vertexbuffer3d_ex(rn, vb, transform, proc);
+        return;
+    }
+
+    /* Project the bounding sphere with the current matrices */
+
+    pf_mat4_t mat_model;
+    if (transform == NULL) {
+        pf_mat4_identity(mat_model);
+    } else {
+        pf_mat4_copy(mat_model, transform);
+    }
+
+    pf_mat4_t mat_mvp;
+    pf_mat4_mul_r(mat_mvp, mat_model, rn->conf3d->mat_view);
+    pf_mat4_mul(mat_mvp, mat_mvp, rn->conf3d->mat_proj);
+
+    pf_vec4_t center = { lod->center[0], lod->center[1], lod->center[2], 1.0f };
+    pf_vec4_transform(center, center, mat_mvp);
+
+    // NOTE: The radius is scaled by the largest scale factor of the model matrix
+    float scale = 0.0f;
+    for (int_fast8_t i = 0; i < 3; ++i) {
+        scale = PF_MAX(scale, pf_vec3_len(mat_model + 4 * i));
+    }
+
+    const float radius = lod->radius * scale;
+    const float* proj = rn->conf3d->mat_proj;
+
+    /*
+        Select the finest level having at most one triangle per 'PF_LOD_PIXELS_PER_TRIANGLE'
+        pixels covered by the projected sphere, the full mesh is used when the camera
+        is inside or very close to the bounding sphere.
+        NOTE: With an orthographic projection 'w' is always 1 and the size doesn't depend on the distance.
+    */
+
+    uint32_t level = 0;
+    bool is_ortho = (proj[11] == 0.0f);
+
+    if (is_ortho || center[3] > radius) {
+        float screen_radius = radius / center[3] * 0.5f * PF_MAX(
+            fabsf(proj[0]) * rn->conf3d->viewport_dim[0],
+            fabsf(proj[5]) * rn->conf3d->viewport_dim[1]);
+
+        float max_triangles = (float)M_PI * screen_radius * screen_radius / PF_LOD_PIXELS_PER_TRIANGLE;
+
+        level = lod->num_levels - 1;
+        for (uint32_t i = 0; i < lod->num_levels; ++i) {
+            if (lod->num_indices[i] / 3 <= max_triangles) {
+                level = i;
+                break;
+            }
+        }
+    }
+
+    /* Render the selected level */
+
+    pf_vertexbuffer_t level_vb = *vb;
+    level_vb.indices = lod->indices[level];
+    level_vb.num_indices = lod->num_indices[level];
+
+    pf_renderer_vertexbuffer3d_ex(rn, &level_vb, transform, proc);
+}
+
 void
 pf_renderer_vertexbuffer3d_points(
     pf_renderer_t* rn, const pf_vertexbuffer_t* vb,
@@ -190,18 +365,20 @@ pf_renderer_vertexbuffer3d_points_thick(
     bool has_indices = (indices != NULL);
     uint32_t num = (has_indices) ? vb->num_indices : vb->num_vertices;
 
+    uint32_t count = 0;
+
     for (uint32_t i = 0; i < num; i++) {
         uint32_t index = (has_indices) ? indices[i] : i;
 
-        pf_vertex_t vertex = { 0 };
-
-        for (uint32_t j = 0; j < PF_MAX_ATTRIBUTES; ++j) {
-            const pf_attribute_t* attr = &vb->attributes[j];
-            if (attr->used != 0) {
-                vertex.elements[j] = pf_attribute_get_elem(attr, index);
-            }
+        // NOTE: Every vertex is a point whatever the topology, only the restart index is skipped
+        uint32_t slot;
+        if (!pf_vertexbuffer_assemble_slot_INTERNAL(vb, &count, index, &slot)) {
+            continue;
         }
 
+        pf_vertex_t vertex = { 0 };
+        pf_vertexbuffer3d_fetch_INTERNAL(vb, &vertex, index);
+
         pf_renderer_point3d_INTERNAL(
             rn, &vertex, radius, mat_model, mat_normal, mat_mvp, &processor);
     }
@@ -259,36 +436,28 @@ pf_renderer_vertexbuffer3d_lines_thick(
     bool has_indices = (indices != NULL);
     uint32_t num = (has_indices) ? vb->num_indices : vb->num_vertices;
 
-    for (uint32_t i = 0; i < num; i += 3) {
-        uint32_t tri_indices[3];
+    uint32_t count = 0;
+    pf_vertex_t cache_vertices[3];
 
-        if (has_indices) {
-            tri_indices[0] = indices[i + 0];
-            tri_indices[1] = indices[i + 1];
-            tri_indices[2] = indices[i + 2];
-        } else {
-            tri_indices[0] = i + 0;
-            tri_indices[1] = i + 1;
-            tri_indices[2] = i + 2;
+    for (uint32_t i = 0; i < num; ++i) {
+        uint32_t index = (has_indices) ? indices[i] : i;
+
+        uint32_t slot;
+        if (!pf_vertexbuffer_assemble_slot_INTERNAL(vb, &count, index, &slot)) {
+            continue;
         }
 
-        for (uint32_t j = 0; j < 3; ++j) {
-            uint32_t index_1 = tri_indices[j];
-            uint32_t index_2 = tri_indices[(j + 1) % 3];
-
-            pf_vertex_t v1 = { 0 };
-            pf_vertex_t v2 = { 0 };
-
-            for (uint32_t j = 0; j < PF_MAX_ATTRIBUTES; ++j) {
-                const pf_attribute_t* attr = &vb->attributes[j];
-                if (attr->used != 0) {
-                    v1.elements[j] = pf_attribute_get_elem(attr, index_1);
-                    v2.elements[j] = pf_attribute_get_elem(attr, index_2);
-                }
-            }
+        pf_vertexbuffer3d_fetch_INTERNAL(vb, &cache_vertices[slot], index);
 
-            pf_renderer_line3d_INTERNAL(
-                rn, &v1, &v2, thick, mat_model, mat_normal, mat_mvp, &processor);
+        uint32_t tri[3];
+        if (!pf_vertexbuffer_assemble_push_INTERNAL(vb, &count, slot, tri)) {
+            continue;
+        }
+
+        for (uint32_t j = 0; j < 3; ++j) {
+            pf_renderer_line3d_INTERNAL(rn,
+                &cache_vertices[tri[j]], &cache_vertices[tri[(j + 1) % 3]],
+                thick, mat_model, mat_normal, mat_mvp, &processor);
         }
     }
 }
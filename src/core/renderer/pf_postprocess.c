@@ -0,0 +1,251 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "pixelfactory/core/pf_renderer.h"
+#include <string.h>
+#include <stdlib.h>
+
+/* Internal FXAA Functions */
+
+static inline int
+pf_fxaa_luma_INTERNAL(pf_color_t color)
+{
+    return (color.c.r * 77 + color.c.g * 150 + color.c.b * 29) >> 8;
+}
+
+static void
+pf_fxaa_luma_row_INTERNAL(
+    int* restrict luma,
+    const pf_color_t* restrict src,
+    int count)
+{
+    int i = 0;
+
+#if PF_SIMD_SIZE > 1
+    const pf_simd_i_t mask = pf_simd_set1_i32(0xFF);
+    const pf_simd_i_t r_factor = pf_simd_set1_i32(77);
+    const pf_simd_i_t g_factor = pf_simd_set1_i32(150);
+    const pf_simd_i_t b_factor = pf_simd_set1_i32(29);
+
+    for (; i + PF_SIMD_SIZE - 1 < count; i += PF_SIMD_SIZE) {
+        pf_simd_i_t colors = pf_simd_load_i32(src + i);
+        pf_simd_i_t r = pf_simd_and_i32(colors, mask);
+        pf_simd_i_t g = pf_simd_and_i32(pf_simd_srli_i32(colors, 8), mask);
+        pf_simd_i_t b = pf_simd_and_i32(pf_simd_srli_i32(colors, 16), mask);
+        pf_simd_i_t l = pf_simd_add_i32(pf_simd_mullo_i32(r, r_factor), pf_simd_mullo_i32(g, g_factor));
+        l = pf_simd_add_i32(l, pf_simd_mullo_i32(b, b_factor));
+        pf_simd_store_i32(luma + i, pf_simd_srli_i32(l, 8));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        luma[i] = pf_fxaa_luma_INTERNAL(src[i]);
+    }
+}
+
+static pf_color_t
+pf_fxaa_pixel_INTERNAL(
+    const pf_color_t* src,
+    const int* luma,
+    int w, int h,
+    int x, int y)
+{
+    // NOTE: The pixel must not be on the border of the buffer
+
+    const int offset = y * w + x;
+    const int* l = luma + offset;
+
+    /* Local contrast check */
+
+    int l_m = l[0], l_n = l[-w], l_s = l[w], l_w = l[-1], l_e = l[1];
+
+    int l_max = PF_MAX(PF_MAX(PF_MAX(l_n, l_s), PF_MAX(l_w, l_e)), l_m);
+    int l_min = PF_MIN(PF_MIN(PF_MIN(l_n, l_s), PF_MIN(l_w, l_e)), l_m);
+    int range = l_max - l_min;
+
+    if (range < PF_MAX(PF_FXAA_EDGE_THRESHOLD_MIN, l_max >> PF_FXAA_EDGE_THRESHOLD_SHIFT)) {
+        return src[offset];
+    }
+
+    int l_nw = l[-w - 1], l_ne = l[-w + 1], l_sw = l[w - 1], l_se = l[w + 1];
+
+    /* Edge orientation */
+
+    int edge_h = 2 * abs(l_n + l_s - 2 * l_m) + abs(l_nw + l_sw - 2 * l_w) + abs(l_ne + l_se - 2 * l_e);
+    int edge_v = 2 * abs(l_w + l_e - 2 * l_m) + abs(l_nw + l_ne - 2 * l_n) + abs(l_sw + l_se - 2 * l_s);
+    bool horizontal = (edge_h >= edge_v);
+
+    // NOTE: 'step_side' goes toward the pixel across the edge, 'step_edge' goes along it
+
+    int step_side = horizontal ? w : 1;
+    int step_edge = horizontal ? 1 : w;
+    int pos = horizontal ? x : y;
+    int len = horizontal ? w : h;
+
+    int grad_neg = abs((horizontal ? l_n : l_w) - l_m);
+    int grad_pos = abs((horizontal ? l_s : l_e) - l_m);
+
+    int l_side = horizontal ? l_s : l_e;
+    if (grad_neg >= grad_pos) {
+        l_side = horizontal ? l_n : l_w;
+        step_side = -step_side;
+    }
+
+    float grad_scaled = 0.25f * PF_MAX(grad_neg, grad_pos);
+    float l_local = 0.5f * (l_side + l_m);
+
+    /* Search both ends of the edge */
+
+    int dist_neg = 1, dist_pos = 1;
+    float end_neg = 0.0f, end_pos = 0.0f;
+
+    for (; dist_neg < PF_FXAA_SEARCH_STEPS && pos - dist_neg > 0; ++dist_neg) {
+        const int* q = l - dist_neg * step_edge;
+        end_neg = 0.5f * (q[0] + q[step_side]) - l_local;
+        if (fabsf(end_neg) >= grad_scaled) break;
+    }
+
+    for (; dist_pos < PF_FXAA_SEARCH_STEPS && pos + dist_pos < len - 1; ++dist_pos) {
+        const int* q = l + dist_pos * step_edge;
+        end_pos = 0.5f * (q[0] + q[step_side]) - l_local;
+        if (fabsf(end_pos) >= grad_scaled) break;
+    }
+
+    /*
+        Only the pixels of the half of the edge nearest to an end are blended, as far as
+        the luma variation at that end goes in the opposite direction to the center's
+    */
+
+    float blend_edge = 0.0f;
+    float end = (dist_neg < dist_pos) ? end_neg : end_pos;
+
+    if ((end < 0.0f) != (l_m < l_local)) {
+        blend_edge = 0.5f - (float)PF_MIN(dist_neg, dist_pos) / (dist_neg + dist_pos);
+    }
+
+    /* Sub-pixel aliasing */
+
+    float l_avg = (2 * (l_n + l_s + l_w + l_e) + l_nw + l_ne + l_sw + l_se) * (1.0f / 12);
+    float blend_sub = PF_CLAMP(fabsf(l_avg - l_m) / range, 0.0f, 1.0f);
+    blend_sub = (-2.0f * blend_sub + 3.0f) * blend_sub * blend_sub;
+    blend_sub = blend_sub * blend_sub * 0.75f;
+
+    return pf_color_lerpf(src[offset], src[offset + step_side], PF_MAX(blend_edge, blend_sub));
+}
+
+/* Public API */
+
+void
+pf_renderer_fxaa(
+    pf_renderer_t* rn)
+{
+    const int w = (int)rn->fb.w;
+    const int h = (int)rn->fb.h;
+
+    if (w < 3 || h < 3) {
+        return;
+    }
+
+    size_t size = (size_t)w * h;
+
+    pf_color_t* src = PF_MALLOC(size * sizeof(pf_color_t));
+    int* luma = PF_MALLOC(size * sizeof(int));
+
+    if (src == NULL || luma == NULL) {
+        if (src != NULL) PF_FREE(src);
+        if (luma != NULL) PF_FREE(luma);
+        return;
+    }
+
+    if (rn->fb.format == PF_PIXELFORMAT_RGBA8888) {
+        memcpy(src, rn->fb.buffer, size * sizeof(pf_color_t));
+    } else {
+        for (size_t i = 0; i < size; ++i) {
+            src[i] = pf_framebuffer_load(&rn->fb, i);
+        }
+    }
+
+    /* Compute the luma of each pixel */
+
+#ifdef _OPENMP
+#   pragma omp parallel for \
+        if (size >= PF_OMP_BUFFER_MAP_SIZE_THRESHOLD)
+#endif //_OPENMP
+    for (int y = 0; y < h; ++y) {
+        pf_fxaa_luma_row_INTERNAL(luma + y * w, src + y * w, w);
+    }
+
+    /*
+        Edge detection of several pixels at once, the pixels passing the local
+        contrast test are then processed individually. Each thread processes
+        a band of contiguous rows, border pixels are left untouched.
+    */
+
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(static) \
+        if (size >= PF_OMP_BUFFER_MAP_SIZE_THRESHOLD)
+#endif //_OPENMP
+    for (int y = 1; y < h - 1; ++y) {
+        size_t row = (size_t)y * w;
+        int x = 1;
+
+#if PF_SIMD_SIZE > 1
+        const int* l = luma + y * w;
+        const pf_simd_i_t threshold_min = pf_simd_set1_i32(PF_FXAA_EDGE_THRESHOLD_MIN - 1);
+        const pf_simd_i_t one = pf_simd_set1_i32(1);
+
+        for (; x + PF_SIMD_SIZE < w; x += PF_SIMD_SIZE) {
+            pf_simd_i_t l_m = pf_simd_load_i32(l + x);
+            pf_simd_i_t l_n = pf_simd_load_i32(l + x - w);
+            pf_simd_i_t l_s = pf_simd_load_i32(l + x + w);
+            pf_simd_i_t l_w = pf_simd_load_i32(l + x - 1);
+            pf_simd_i_t l_e = pf_simd_load_i32(l + x + 1);
+
+            pf_simd_i_t l_max = pf_simd_max_i32(pf_simd_max_i32(l_n, l_s), pf_simd_max_i32(l_w, l_e));
+            pf_simd_i_t l_min = pf_simd_min_i32(pf_simd_min_i32(l_n, l_s), pf_simd_min_i32(l_w, l_e));
+            l_max = pf_simd_max_i32(l_max, l_m);
+            l_min = pf_simd_min_i32(l_min, l_m);
+
+            pf_simd_i_t threshold = pf_simd_sub_i32(pf_simd_srli_i32(l_max, PF_FXAA_EDGE_THRESHOLD_SHIFT), one);
+            threshold = pf_simd_max_i32(threshold, threshold_min);
+
+            int mask = pf_simd_movemask_i8(pf_simd_cmpgt_i32(pf_simd_sub_i32(l_max, l_min), threshold));
+            if (mask == 0) continue;
+
+            for (int i = 0; i < PF_SIMD_SIZE; ++i) {
+                if (mask & (1 << (4 * i))) {
+                    pf_framebuffer_store(&rn->fb, row + x + i,
+                        pf_fxaa_pixel_INTERNAL(src, luma, w, h, x + i, y));
+                }
+            }
+        }
+#endif
+
+        for (; x < w - 1; ++x) {
+            pf_framebuffer_store(&rn->fb, row + x, pf_fxaa_pixel_INTERNAL(src, luma, w, h, x, y));
+        }
+    }
+
+    PF_FREE(src);
+    PF_FREE(luma);
+
+    // NOTE: The filtered edges may extend past the drawn tiles and would not be
+    //       restored by a damaged clear, the whole framebuffer is thus damaged
+    pf_framebuffer_damage_add(&rn->damage, 0, 0, w - 1, h - 1);
+}
@@ -19,6 +19,7 @@
 
 #include "pixelfactory/core/pf_renderer.h"
 #include <float.h>
+#include <string.h>
 
 /* Internal Macros */
 
@@ -26,8 +27,8 @@
     for (int y = 0; y < (int)rn->fb.h; ++y) {                           \
         size_t y_offset = y * rn->fb.w;                                 \
         for (int x = 0; x < (int)rn->fb.w; ++x) {                       \
-            pf_color_t* fb_ptr = rn->fb.buffer + y_offset + x;          \
-            pf_color_t color = *fb_ptr;                                 \
+            size_t offset = y_offset + x;                               \
+            pf_color_t color = pf_framebuffer_load(&rn->fb, offset);    \
             PIXEL_CODE                                                  \
             u += tx;                                                    \
         }                                                               \
@@ -39,9 +40,8 @@
         size_t y_offset = y * rn->fb.w;                                 \
         for (int x = 0; x < (int)rn->fb.w; ++x) {                       \
             size_t offset = y_offset + x;                               \
-            pf_color_t* fb_ptr = rn->fb.buffer + offset;                \
             float* zb_ptr = rn->zb.buffer + offset;                     \
-            pf_color_t color = *fb_ptr;                                 \
+            pf_color_t color = pf_framebuffer_load(&rn->fb, offset);    \
             float depth = *zb_ptr;                                      \
             PIXEL_CODE                                                  \
             u += tx;                                                    \
@@ -59,16 +59,104 @@
         if (rn->fb.w * rn->fb.h >= PF_OMP_BUFFER_MAP_SIZE_THRESHOLD)")  \
     PF_RENDERER_MAP3D(PIXEL_CODE)
 
+/* Internal Functions */
+
+// NOTE: Rounded average of the four channels of four colors, each sum of a channel
+//       fitting in the 16 bits of its half of the even or odd channels
+static inline uint32_t
+pf_renderer_avg4_u8_INTERNAL(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+    uint32_t even = (a & 0x00FF00FF) + (b & 0x00FF00FF) + (c & 0x00FF00FF) + (d & 0x00FF00FF);
+    uint32_t odd = ((a >> 8) & 0x00FF00FF) + ((b >> 8) & 0x00FF00FF) + ((c >> 8) & 0x00FF00FF) + ((d >> 8) & 0x00FF00FF);
+    even = ((even + 0x00020002) >> 2) & 0x00FF00FF;
+    odd = ((odd + 0x00020002) >> 2) & 0x00FF00FF;
+    return even | (odd << 8);
+}
+
+// NOTE: Returns the sample depth that passes 'test' against the others, the
+//       nearest one if there is no depth test
+static inline float
+pf_renderer_resolve_depth_INTERNAL(
+    pf_depth_test_fn test, const float* z, size_t size)
+{
+    float depth = z[0];
+    for (int k = 1; k < PF_MSAA_SAMPLES; ++k) {
+        float sample = z[k * size];
+        if ((test != NULL) ? test(depth, sample) : (sample < depth)) {
+            depth = sample;
+        }
+    }
+    return depth;
+}
+
+// NOTE: Resolves the pixel 'i' of the multisample buffers, which have planes of 'size' values
+static inline void
+pf_renderer_resolve_pixel_INTERNAL(
+    pf_renderer_t* rn, pf_depth_test_fn test, size_t i, size_t size)
+{
+    const pf_color_t* c = rn->msaa_color + i;
+
+    pf_color_t color;
+    color.v = pf_renderer_avg4_u8_INTERNAL(c[0].v, c[size].v, c[2 * size].v, c[3 * size].v);
+
+    pf_framebuffer_store(&rn->fb, i, color);
+    rn->zb.buffer[i] = pf_renderer_resolve_depth_INTERNAL(test, rn->msaa_depth + i, size);
+}
+
+// NOTE: Clears 'size' depths and, if 'colors' is not NULL, 'size' colors
+static void
+pf_renderer_clear_planes_INTERNAL(
+    pf_color_t* colors, float* depths, size_t size,
+    pf_color_t clear_color, float clear_depth)
+{
+#if PF_SIMD_SIZE > 1
+    pf_simd_i_t clear_color_vec = pf_simd_set1_i32(clear_color.v);
+    pf_simd_t clear_depth_vec = pf_simd_set1_ps(clear_depth);
+    long num_vec = (long)(size / PF_SIMD_SIZE);
+#ifdef _OPENMP
+#   pragma omp parallel for \
+        if (size >= PF_OMP_CLEAR_BUFFER_SIZE_THRESHOLD)
+#endif //_OPENMP
+    for (long v = 0; v < num_vec; ++v) {
+        size_t i = (size_t)v * PF_SIMD_SIZE;
+        if (colors != NULL) pf_simd_store_i32((pf_simd_i_t*)(colors + i), clear_color_vec);
+        pf_simd_store_ps(depths + i, clear_depth_vec);
+    }
+    for (size_t i = (size_t)num_vec * PF_SIMD_SIZE; i < size; ++i) {
+        if (colors != NULL) colors[i] = clear_color;
+        depths[i] = clear_depth;
+    }
+#else
+#ifdef _OPENMP
+#   pragma omp parallel for \
+        if (size >= PF_OMP_CLEAR_BUFFER_SIZE_THRESHOLD)
+#endif //_OPENMP
+    for (size_t i = 0; i < size; ++i) {
+        if (colors != NULL) colors[i] = clear_color;
+        depths[i] = clear_depth;
+    }
+#endif
+}
+
 /* Public API */
 
 pf_renderer_t
 pf_renderer_load(
     uint32_t w, uint32_t h,
     pf_renderer_flag_e flags)
+{
+    return pf_renderer_load_ex(w, h, flags, PF_PIXELFORMAT_RGBA8888);
+}
+
+pf_renderer_t
+pf_renderer_load_ex(
+    uint32_t w, uint32_t h,
+    pf_renderer_flag_e flags,
+    pf_pixelformat_e format)
 {
     pf_renderer_t rn = { 0 };
 
-    rn.fb = pf_framebuffer_create(w, h, PF_BLANK);
+    rn.fb = pf_framebuffer_create_ex(w, h, PF_BLANK, format);
 
     if (flags & PF_RENDERER_2D) {
         rn.conf2d = PF_CALLOC(1, sizeof(pf_renderer_config_2d_t));
@@ -90,6 +178,22 @@ pf_renderer_load(
         rn.conf3d->viewport_dim[1] = h - 1;
 
         rn.conf3d->cull_mode = PF_CULL_NONE;
+
+        if (flags & PF_RENDERER_MSAA4X) {
+            size_t size = (size_t)w * h * PF_MSAA_SAMPLES;
+            rn.msaa_color = PF_CALLOC(size, sizeof(pf_color_t));
+            rn.msaa_depth = PF_MALLOC(size * sizeof(float));
+            rn.msaa_coverage = PF_CALLOC((size_t)w * h, sizeof(uint8_t));
+            if (rn.msaa_depth != NULL) {
+                for (size_t i = 0; i < size; ++i) {
+                    rn.msaa_depth[i] = FLT_MAX;
+                }
+            }
+        }
+    }
+
+    if (flags & PF_RENDERER_DAMAGE) {
+        rn.damage = pf_framebuffer_damage_create(w, h);
     }
 
     return rn;
@@ -105,6 +209,12 @@ pf_renderer_delete(
     if (rn->conf2d != NULL) PF_FREE(rn->conf2d);
     if (rn->conf3d != NULL) PF_FREE(rn->conf3d);
 
+    if (rn->msaa_color != NULL) PF_FREE(rn->msaa_color);
+    if (rn->msaa_depth != NULL) PF_FREE(rn->msaa_depth);
+    if (rn->msaa_coverage != NULL) PF_FREE(rn->msaa_coverage);
+
+    pf_framebuffer_damage_delete(&rn->damage);
+
     *rn = (pf_renderer_t) { 0 };
 }
 
@@ -121,6 +231,14 @@ pf_renderer_is_valid(
         valid = (rn->conf3d != NULL)
             && pf_depthbuffer_is_valid(&rn->zb);
     }
+    if (valid && (flags & PF_RENDERER_MSAA4X)) {
+        valid = (rn->msaa_color != NULL)
+            && (rn->msaa_depth != NULL)
+            && (rn->msaa_coverage != NULL);
+    }
+    if (valid && (flags & PF_RENDERER_DAMAGE)) {
+        valid = (rn->damage.drawn != NULL);
+    }
     return valid;
 }
 
@@ -133,27 +251,25 @@ pf_renderer_clear2d(
         return;
     }
 
-    size_t size = rn->fb.w * rn->fb.h;
-    pf_color_t* fb = rn->fb.buffer;
+    pf_framebuffer_fill(&rn->fb, NULL, clear_color);
+    pf_framebuffer_damage_invalidate(&rn->damage);
+}
 
-#   if PF_SIMD_SIZE > 1
-    pf_simd_i_t clear_color_vec = pf_simd_set1_i32(clear_color.v);
-    size_t i = 0;
-    for (; i + PF_SIMD_SIZE - 1 < size; i += PF_SIMD_SIZE) {
-        pf_simd_store_i32((pf_simd_i_t*)(fb + i), clear_color_vec);
-    }
-    for (; i < size; ++i) {
-        fb[i] = clear_color;
+void
+pf_renderer_clear2d_damaged(
+    pf_renderer_t* rn,
+    pf_color_t clear_color)
+{
+    if (rn->conf2d == NULL) {
+        return;
     }
-#else
-#ifdef _OPENMP
-#   pragma omp parallel for \
-        if (size >= PF_OMP_CLEAR_BUFFER_SIZE_THRESHOLD)
-#endif //_OPENMP
-    for (size_t i = 0; i < size; ++i) {
-        fb[i] = clear_color;
+
+    if (rn->damage.drawn == NULL) {
+        pf_renderer_clear2d(rn, clear_color);
+        return;
     }
-#endif
+
+    pf_framebuffer_fill_damaged(&rn->fb, &rn->damage, clear_color);
 }
 
 void
@@ -167,31 +283,159 @@ pf_renderer_clear3d(
     }
 
     size_t size = rn->fb.w * rn->fb.h;
-    pf_color_t* fb = rn->fb.buffer;
-    float* zb = rn->zb.buffer;
 
-#if PF_SIMD_SIZE > 1
-    pf_simd_i_t clear_color_vec = pf_simd_set1_i32(clear_color.v);
-    pf_simd_t clear_depth_vec = pf_simd_set1_ps(clear_depth);
-    size_t i = 0;
-    for (; i + PF_SIMD_SIZE - 1 < size; i += PF_SIMD_SIZE) {
-        pf_simd_store_i32((pf_simd_i_t*)(fb + i), clear_color_vec);
-        pf_simd_store_ps(zb + i, clear_depth_vec);
+    // NOTE: 'fb' and 'zb' are always cleared, the draws which are not multisampled
+    //       writing to them directly, and the sample buffers as well as the coverage
+    //       when multisampling is enabled
+
+    pf_framebuffer_fill(&rn->fb, NULL, clear_color);
+    pf_renderer_clear_planes_INTERNAL(NULL, rn->zb.buffer, size, clear_color, clear_depth);
+
+    if (rn->msaa_color != NULL) {
+        pf_renderer_clear_planes_INTERNAL(rn->msaa_color, rn->msaa_depth,
+            size * PF_MSAA_SAMPLES, clear_color, clear_depth);
+        memset(rn->msaa_coverage, 0, size);
     }
-    for (; i < size; ++i) {
-        fb[i] = clear_color;
-        zb[i] = clear_depth;
+
+    pf_framebuffer_damage_invalidate(&rn->damage);
+}
+
+void
+pf_renderer_clear3d_damaged(
+    pf_renderer_t* rn,
+    pf_color_t clear_color,
+    float clear_depth)
+{
+    if (rn->conf3d == NULL) {
+        return;
     }
-#else
+
+    if (rn->damage.drawn == NULL) {
+        pf_renderer_clear3d(rn, clear_color, clear_depth);
+        return;
+    }
+
+    size_t size = rn->fb.w * rn->fb.h;
+
+    uint32_t cursor = 0, rect[4];
+    while (pf_framebuffer_damage_next(&rn->damage, false, &cursor, rect)) {
+        size_t count = rect[2] - rect[0] + 1;
+        pf_framebuffer_fill(&rn->fb, rect, clear_color);
+        for (uint32_t y = rect[1]; y <= rect[3]; ++y) {
+            size_t offset = (size_t)y * rn->fb.w + rect[0];
+            pf_renderer_clear_planes_INTERNAL(NULL, rn->zb.buffer + offset, count, clear_color, clear_depth);
+            if (rn->msaa_color == NULL) continue;
+            for (int s = 0; s < PF_MSAA_SAMPLES; ++s) {
+                size_t plane = offset + s * size;
+                pf_renderer_clear_planes_INTERNAL(rn->msaa_color + plane,
+                    rn->msaa_depth + plane, count, clear_color, clear_depth);
+            }
+            memset(rn->msaa_coverage + offset, 0, count);
+        }
+    }
+
+    pf_framebuffer_damage_advance(&rn->damage);
+}
+
+void
+pf_renderer_msaa_resolve(
+    pf_renderer_t* rn)
+{
+    if (rn->msaa_color == NULL) {
+        return;
+    }
+
+    // NOTE: The color of each pixel is the rounded average of its four samples, and
+    //       its depth is the sample depth that passes the depth test against the others,
+    //       so that later non-multisampled draws are tested against the geometry.
+    //       Only the pixels covered by a triangle since the last clear are written,
+    //       the others keeping what the non-multisampled draws wrote to 'fb'.
+
+    const int w = (int)rn->fb.w;
+    const int h = (int)rn->fb.h;
+    const size_t size = (size_t)w * h;
+    const uint8_t* coverage = rn->msaa_coverage;
+
+    const pf_depth_test_fn test = (rn->conf3d != NULL) ? rn->conf3d->depth_test : NULL;
+
+#if PF_SIMD_SIZE > 1
+    // NOTE: The vectorized path keeps the minimum or the maximum depth, depending on
+    //       which one the depth test prefers, any other test is resolved per pixel
+
+    const bool keep_min = (test == NULL) || (test(1.0f, 0.0f) && !test(0.0f, 1.0f));
+    const bool keep_max = !keep_min && test(0.0f, 1.0f) && !test(1.0f, 0.0f);
+#endif
+
 #ifdef _OPENMP
 #   pragma omp parallel for \
         if (size >= PF_OMP_CLEAR_BUFFER_SIZE_THRESHOLD)
 #endif //_OPENMP
-    for (size_t i = 0; i < size; ++i) {
-        fb[i] = clear_color;
-        zb[i] = clear_depth;
-    }
+    for (int y = 0; y < h; ++y) {
+        size_t i = (size_t)y * w;
+        const size_t end = i + w;
+
+#if PF_SIMD_SIZE > 1
+        // NOTE: The framebuffers in other formats are written through the conversions
+        if (rn->fb.format == PF_PIXELFORMAT_RGBA8888 && (keep_min || keep_max)) {
+            const pf_color_t* c0 = rn->msaa_color;
+            const pf_color_t* c1 = c0 + size;
+            const pf_color_t* c2 = c1 + size;
+            const pf_color_t* c3 = c2 + size;
+
+            const float* z0 = rn->msaa_depth;
+            const float* z1 = z0 + size;
+            const float* z2 = z1 + size;
+            const float* z3 = z2 + size;
+
+            pf_color_t* fb = rn->fb.buffer;
+            float* zb = rn->zb.buffer;
+
+            const pf_simd_i_t mask_u8 = pf_simd_set1_i32(0x00FF00FF);
+            const pf_simd_i_t round_u8 = pf_simd_set1_i32(0x00020002);
+
+            for (; i + PF_SIMD_SIZE <= end; i += PF_SIMD_SIZE) {
+                int covered = 0;
+                for (int k = 0; k < PF_SIMD_SIZE; ++k) {
+                    covered += coverage[i + k];
+                }
+
+                if (covered < PF_SIMD_SIZE) {
+                    for (int k = 0; k < PF_SIMD_SIZE && covered > 0; ++k) {
+                        if (coverage[i + k]) pf_renderer_resolve_pixel_INTERNAL(rn, test, i + k, size);
+                    }
+                    continue;
+                }
+
+                pf_simd_i_t s0 = pf_simd_load_i32(c0 + i), s1 = pf_simd_load_i32(c1 + i);
+                pf_simd_i_t s2 = pf_simd_load_i32(c2 + i), s3 = pf_simd_load_i32(c3 + i);
+
+                pf_simd_i_t even = pf_simd_add_i32(
+                    pf_simd_add_i32(pf_simd_and_i32(s0, mask_u8), pf_simd_and_i32(s1, mask_u8)),
+                    pf_simd_add_i32(pf_simd_and_i32(s2, mask_u8), pf_simd_and_i32(s3, mask_u8)));
+                pf_simd_i_t odd = pf_simd_add_i32(
+                    pf_simd_add_i32(pf_simd_and_i32(pf_simd_srli_i32(s0, 8), mask_u8), pf_simd_and_i32(pf_simd_srli_i32(s1, 8), mask_u8)),
+                    pf_simd_add_i32(pf_simd_and_i32(pf_simd_srli_i32(s2, 8), mask_u8), pf_simd_and_i32(pf_simd_srli_i32(s3, 8), mask_u8)));
+
+                even = pf_simd_and_i32(pf_simd_srli_i32(pf_simd_add_i32(even, round_u8), 2), mask_u8);
+                odd = pf_simd_and_i32(pf_simd_srli_i32(pf_simd_add_i32(odd, round_u8), 2), mask_u8);
+                pf_simd_store_i32((pf_simd_i_t*)(fb + i), pf_simd_or_i32(even, pf_simd_slli_i32(odd, 8)));
+
+                pf_simd_t d0 = pf_simd_load_ps(z0 + i), d1 = pf_simd_load_ps(z1 + i);
+                pf_simd_t d2 = pf_simd_load_ps(z2 + i), d3 = pf_simd_load_ps(z3 + i);
+
+                if (keep_min) {
+                    pf_simd_store_ps(zb + i, pf_simd_min_ps(pf_simd_min_ps(d0, d1), pf_simd_min_ps(d2, d3)));
+                } else {
+                    pf_simd_store_ps(zb + i, pf_simd_max_ps(pf_simd_max_ps(d0, d1), pf_simd_max_ps(d2, d3)));
+                }
+            }
+        }
 #endif
+
+        for (; i < end; ++i) {
+            if (coverage[i]) pf_renderer_resolve_pixel_INTERNAL(rn, test, i, size);
+        }
+    }
 }
 
 void
@@ -207,33 +451,35 @@ pf_renderer_map3d(
     float ty = 1.0f / rn->fb.h;
     float u = 0, v = 0;
 
+    pf_framebuffer_damage_add(&rn->damage, 0, 0, (int)rn->fb.w - 1, (int)rn->fb.h - 1);
+
 #if defined(_OPENMP)
     if (rn->conf3d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf3d->color_blend;
         PF_RENDERER_MAP3D_OMP({
             func(rn, &color, &depth, x, y, u, v);
-            *fb_ptr = blend(*fb_ptr, color);
+            pf_framebuffer_blend(&rn->fb, offset, color, blend);
             *zb_ptr = depth;
         })
     } else {
         PF_RENDERER_MAP3D_OMP({
             func(rn, &color, &depth, x, y, u, v);
-            *fb_ptr = color;
+            pf_framebuffer_store(&rn->fb, offset, color);
             *zb_ptr = depth;
         })
     }
 #else
-    if (rn->blend != NULL) {
+    if (rn->conf3d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf3d->color_blend;
         PF_RENDERER_MAP3D({
             func(rn, &color, &depth, x, y, u, v);
-            *fb_ptr = blend(*fb_ptr, color);
+            pf_framebuffer_blend(&rn->fb, offset, color, blend);
             *zb_ptr = depth;
         })
     } else {
         PF_RENDERER_MAP3D({
             func(rn, &color, &depth, x, y, u, v);
-            *fb_ptr = color;
+            pf_framebuffer_store(&rn->fb, offset, color);
             *zb_ptr = depth;
         })
     }
@@ -253,33 +499,35 @@ pf_renderer_map2d(
     float ty = 1.0f / rn->fb.h;
     float u = 0, v = 0;
 
+    pf_framebuffer_damage_add(&rn->damage, 0, 0, (int)rn->fb.w - 1, (int)rn->fb.h - 1);
+
 #if defined(_OPENMP)
     if (rn->conf3d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf3d->color_blend;
         PF_RENDERER_MAP3D_OMP({
             func(rn, &color, x, y, u, v);
-            *fb_ptr = blend(*fb_ptr, color);
+            pf_framebuffer_blend(&rn->fb, offset, color, blend);
             *zb_ptr = depth;
         })
     } else {
         PF_RENDERER_MAP3D_OMP({
             func(rn, &color, x, y, u, v);
-            *fb_ptr = color;
+            pf_framebuffer_store(&rn->fb, offset, color);
             *zb_ptr = depth;
         })
     }
 #else
-    if (rn->blend != NULL) {
+    if (rn->conf3d->color_blend != NULL) {
         pf_color_blend_fn blend = rn->conf3d->color_blend;
         PF_RENDERER_MAP3D({
             func(rn, &color, x, y, u, v);
-            *fb_ptr = blend(*fb_ptr, color);
+            pf_framebuffer_blend(&rn->fb, offset, color, blend);
             *zb_ptr = depth;
         })
     } else {
         PF_RENDERER_MAP3D({
             func(rn, &color, x, y, u, v);
-            *fb_ptr = color;
+            pf_framebuffer_store(&rn->fb, offset, color);
             *zb_ptr = depth;
         })
     }
@@ -0,0 +1,107 @@
+#include "pixelfactory/pf.h"
+#include <float.h>
+#include <stdio.h>
+
+/*
+    Draws a triangle covering the center of the framebuffer whose color attribute
+    is stored with each compact type, and checks that the default processors give
+    the same color as with the 'PF_ATTRIB_UBYTE' type.
+*/
+
+#define W 64
+#define H 64
+
+static pf_color_t colors_ubyte[3] = {
+    { .a = { 255, 128, 0, 255 } },
+    { .a = { 0, 255, 64, 255 } },
+    { .a = { 32, 0, 255, 128 } }
+};
+
+static pf_attribute_t
+make_color_attribute(pf_attrib_type_e type)
+{
+    static float values[3 * 4];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            values[4 * i + j] = colors_ubyte[i].a[j] / 255.0f;
+        }
+    }
+
+    pf_attribute_t floats = { 0 };
+    floats.buffer = values;
+    floats.size = 3;
+    floats.type = PF_ATTRIB_FLOAT;
+    floats.comp = 4;
+    floats.used = true;
+
+    return pf_attribute_convert(&floats, type);
+}
+
+static pf_color_t
+draw(pf_renderer_t* rn, bool is_3d, const pf_attribute_t* colors)
+{
+    static float positions_3d[] = { -1.0f, -1.0f, 0.0f, 3.0f, -1.0f, 0.0f, -1.0f, 3.0f, 0.0f };
+    static float positions_2d[] = { 0.0f, 0.0f, 2.0f * W, 0.0f, 0.0f, 2.0f * H };
+
+    if (is_3d) {
+        pf_vertexbuffer_t vb = pf_vertexbuffer_create_3d(3, positions_3d, NULL, NULL, NULL);
+        vb.attributes[PF_ATTRIB_COLOR] = *colors;
+        pf_renderer_clear3d(rn, PF_BLACK, FLT_MAX);
+        pf_renderer_vertexbuffer3d(rn, &vb, NULL, NULL);
+    } else {
+        pf_vertexbuffer_t vb = pf_vertexbuffer_create_2d(3, positions_2d, NULL, NULL);
+        vb.attributes[PF_ATTRIB_COLOR] = *colors;
+        pf_renderer_clear2d(rn, PF_BLACK);
+        pf_renderer_vertexbuffer2d(rn, &vb, NULL, NULL);
+    }
+
+    return pf_framebuffer_get(&rn->fb, W / 2, H / 2);
+}
+
+int main(void)
+{
+    static const pf_attrib_type_e types[] = {
+        PF_ATTRIB_HALF, PF_ATTRIB_UNORM8, PF_ATTRIB_UNORM16, PF_ATTRIB_UNORM_10_10_10_2
+    };
+
+    pf_renderer_t rn = pf_renderer_load(W, H, PF_RENDERER_2D | PF_RENDERER_3D);
+    pf_mat4_look_at(rn.conf3d->mat_view, (float[3]) { 0, 0, 2 }, (float[3]) { 0 }, (float[3]) { 0, 1, 0 });
+
+    pf_vertexbuffer_t reference = pf_vertexbuffer_create_2d(3, NULL, NULL, colors_ubyte);
+    const pf_attribute_t* reference_colors = &reference.attributes[PF_ATTRIB_COLOR];
+
+    int failures = 0;
+
+    for (int is_3d = 0; is_3d < 2; ++is_3d) {
+        const pf_color_t expected = draw(&rn, is_3d, reference_colors);
+
+        for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i) {
+            pf_attribute_t colors = make_color_attribute(types[i]);
+            if (colors.buffer == NULL) {
+                fprintf(stderr, "FAIL: Unable to convert the colors to type %d\n", types[i]);
+                ++failures;
+                continue;
+            }
+
+            // NOTE: The 10:10:10:2 type only keeps two bits of alpha
+            const pf_color_t color = draw(&rn, is_3d, &colors);
+            const int num_checked = (types[i] == PF_ATTRIB_UNORM_10_10_10_2) ? 3 : 4;
+
+            for (int j = 0; j < num_checked; ++j) {
+                if (color.a[j] != expected.a[j]) {
+                    fprintf(stderr, "FAIL: %s draw with type %d gives (%d, %d, %d, %d) instead of (%d, %d, %d, %d)\n",
+                        is_3d ? "3D" : "2D", types[i], color.a[0], color.a[1], color.a[2], color.a[3],
+                        expected.a[0], expected.a[1], expected.a[2], expected.a[3]);
+                    ++failures;
+                    break;
+                }
+            }
+
+            PF_FREE(colors.buffer);
+        }
+    }
+
+    pf_renderer_delete(&rn);
+
+    return (failures == 0) ? 0 : 1;
+}